@@ -49,6 +49,9 @@ ACRController::ACRController(const char *portName, const char *ACRPortName, int
 
   binaryInReg_  = 4096;
   binaryOutReg_ = 4097;
+  pollStatus_   = asynError;
+  driveAxis_    = 0;
+  if (numAxes > ACR_MAX_AXES) numAxes_ = numAxes = ACR_MAX_AXES;
   
   // Create controller-specific parameters
   createParam(ACRJerkString,         asynParamFloat64,       &ACRJerk_);
@@ -159,7 +162,8 @@ asynStatus ACRController::writeInt32(asynUser *pasynUser, epicsInt32 value)
   
   if (function == ACRReadBinaryIO_)
   {
-    readBinaryIO();
+    // The binary I/O registers are read with the axis registers on each poll
+    wakeupPoller();
   }
   else 
   {
@@ -241,8 +245,8 @@ asynStatus ACRController::writeUInt32Digital(asynUser *pasynUser, epicsUInt32 va
   }
   sprintf(outString_, "BIT %d=%d", 32+bit, value);
   status = writeController();
-  // Read the I/O back
-  readBinaryIO();
+  // The next poll reads the I/O back
+  wakeupPoller();
 
   return(status);
 }
@@ -274,6 +278,92 @@ asynStatus ACRController::readBinaryIO()
   return status;
 }
 
+/** Reads a list of parameter registers with as few commands as possible.
+  * Up to ACR_MAX_QUERY_REGS registers are read with one "?Pn,Pm,..." command, and the
+  * values are parsed from the response in order.
+  * \param[in] regs Register numbers.
+  * \param[in] numRegs Number of registers.
+  * \param[out] values Values of the registers. */
+asynStatus ACRController::readRegisters(const int *regs, int numRegs, double *values)
+{
+  char query[ACR_QUERY_SIZE];
+  char response[ACR_QUERY_SIZE];
+  size_t nread;
+  char *p, *end;
+  int first, count, i, len;
+  asynStatus status;
+  static const char *functionName = "readRegisters";
+
+  for (first=0; first<numRegs; first+=ACR_MAX_QUERY_REGS) {
+    count = numRegs - first;
+    if (count > ACR_MAX_QUERY_REGS) count = ACR_MAX_QUERY_REGS;
+    len = sprintf(query, "?");
+    for (i=0; i<count; i++) {
+      len += sprintf(query+len, "%sP%d", i ? "," : "", regs[first+i]);
+    }
+    status = writeReadController(query, response, sizeof(response)-1, &nread, DEFAULT_CONTROLLER_TIMEOUT);
+    if (status) return status;
+    response[nread] = '\0';
+    p = response;
+    for (i=0; i<count; i++) {
+      while (*p && (strchr("+-.0123456789", *p) == NULL)) p++;
+      values[first+i] = strtod(p, &end);
+      if (end == p) {
+        asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+          "%s:%s: expected %d values, got %d, response=%s\n",
+          driverName, functionName, count, i, response);
+        return asynError;
+      }
+      p = end;
+    }
+  }
+  return asynSuccess;
+}
+
+/** Polls the controller.
+  * Reads the position, flag and limit registers of all axes and the binary I/O registers
+  * with combined queries.  ACRAxis::poll() takes its values from the cached copies, and
+  * the binary I/O parameters are updated here, so the ACRAux records share the same read.
+  */
+asynStatus ACRController::poll()
+{
+  int regs[ACR_MAX_POLL_REGS];
+  double values[ACR_MAX_POLL_REGS];
+  int axis, n = 0;
+  ACRAxis *pAxis;
+
+  for (axis=0; axis<numAxes_; axis++) {
+    pAxis = getAxis(axis);
+    regs[n++] = pAxis->encoderPositionReg_;
+    regs[n++] = pAxis->theoryPositionReg_;
+    regs[n++] = pAxis->flagsReg_;
+    regs[n++] = pAxis->limitsReg_;
+  }
+  regs[n++] = binaryInReg_;
+  regs[n++] = binaryOutReg_;
+
+  pollStatus_ = readRegisters(regs, n, values);
+  if (pollStatus_) return pollStatus_;
+
+  n = 0;
+  for (axis=0; axis<numAxes_; axis++) {
+    pAxis = getAxis(axis);
+    pAxis->encoderPosition_ = values[n++];
+    pAxis->theoryPosition_  = values[n++];
+    pAxis->currentFlags_    = (int)values[n++];
+    pAxis->currentLimits_   = (int)values[n++];
+  }
+  binaryIn_     = (int)values[n++];
+  binaryOutRBV_ = (int)values[n++];
+  setUIntDigitalParam(0, ACRBinaryIn_, binaryIn_, 0xFFFFFFFF);
+  setUIntDigitalParam(0, ACRBinaryOutRBV_, binaryOutRBV_, 0xFFFFFFFF);
+  callParamCallbacks(0);
+
+  // The drive status has no register here, so one axis is read on each poll
+  if (numAxes_ > 0) driveAxis_ = (driveAxis_ + 1) % numAxes_;
+  return asynSuccess;
+}
+
 // These are the ACRAxis methods
 
 /** Creates a new ACRAxis object.
@@ -289,6 +379,12 @@ ACRAxis::ACRAxis(ACRController *pC, int axisNo)
   asynStatus status;
   
   sprintf(axisName_, "AXIS%d", axisNo);
+  encoderPosition_ = 0.;
+  theoryPosition_ = 0.;
+  currentFlags_ = 0;
+  currentLimits_ = 0;
+  driveOn_ = 0;
+  driveCheck_ = true;
   encoderPositionReg_ = 12290 + 256*axisNo;
   theoryPositionReg_  = 12294 + 256*axisNo;
   limitsReg_          = 4600  + axisNo;
@@ -414,51 +510,34 @@ asynStatus ACRAxis::setClosedLoop(bool closedLoop)
 
   sprintf(pC_->outString_, "DRIVE %s %s", closedLoop ? "ON":"OFF", axisName_);
   status = pC_->writeController();
+  driveCheck_ = true;
   return status;
 }
 
 /** Polls the axis.
-  * This function reads the controller position, encoder position, the limit status, the moving status, 
-  * and the drive power-on status.  It does not current detect following error, etc. but this could be
-  * added.
+  * This function sets the controller position, encoder position, the limit status and the moving status
+  * from the registers that ACRController::poll() read for all axes, and reads the drive power-on status
+  * when it is this axis's turn or after setClosedLoop().  It does not current detect following error,
+  * etc. but this could be added.
   * It calls setIntegerParam() and setDoubleParam() for each item that it polls,
   * and then calls callParamCallbacks() at the end.
   * \param[out] moving A flag that is set indicating that the axis is moving (1) or done (0). */
 asynStatus ACRAxis::poll(bool *moving)
 { 
   int done;
-  int driveOn;
   int limit;
   asynStatus comStatus;
 
-  // Read the current encoder position
-  sprintf(pC_->outString_, "?P%d", encoderPositionReg_);
-  comStatus = pC_->writeReadController();
+  comStatus = pC_->pollStatus_;
   if (comStatus) goto skip;
-  encoderPosition_ = atof(pC_->inString_);
-  setDoubleParam(pC_->motorEncoderPosition_,encoderPosition_);
 
-  // Read the current theoretical position
-  sprintf(pC_->outString_, "?P%d", theoryPositionReg_);
-  comStatus = pC_->writeReadController();
-  if (comStatus) goto skip;
-  theoryPosition_ = atof(pC_->inString_);
+  setDoubleParam(pC_->motorEncoderPosition_,encoderPosition_);
   setDoubleParam(pC_->motorPosition_, theoryPosition_);
 
-  // Read the current flags
-  sprintf(pC_->outString_, "?P%d", flagsReg_);
-  comStatus = pC_->writeReadController();
-  if (comStatus) goto skip;
-  currentFlags_ = atoi(pC_->inString_);
   done = (currentFlags_ & 0x1000000)?0:1;
   setIntegerParam(pC_->motorStatusDone_, done);
   *moving = done ? false:true;
 
-  // Read the current limit status
-  sprintf(pC_->outString_, "?P%d", limitsReg_);
-  comStatus = pC_->writeReadController();
-  if (comStatus) goto skip;
-  currentLimits_ = atoi(pC_->inString_);
   limit = (currentLimits_ & 0x1)?1:0;
   setIntegerParam(pC_->motorStatusHighLimit_, limit);
   limit = (currentLimits_ & 0x2)?1:0;
@@ -467,12 +546,14 @@ asynStatus ACRAxis::poll(bool *moving)
   setIntegerParam(pC_->motorStatusAtHome_, limit);
 
   // Read the drive power on status
-  sprintf(pC_->outString_, "DRIVE %s", axisName_);
-  comStatus = pC_->writeReadController();
-  if (comStatus) goto skip;
-  driveOn = strstr(pC_->inString_, "ON") ? 1:0;
-  setIntegerParam(pC_->motorStatusPowerOn_, driveOn);
-  setIntegerParam(pC_->motorStatusProblem_, 0);
+  if (driveCheck_ || (pC_->driveAxis_ == axisNo_)) {
+    sprintf(pC_->outString_, "DRIVE %s", axisName_);
+    comStatus = pC_->writeReadController();
+    if (comStatus) goto skip;
+    driveOn_ = strstr(pC_->inString_, "ON") ? 1:0;
+    driveCheck_ = false;
+  }
+  setIntegerParam(pC_->motorStatusPowerOn_, driveOn_);
 
   skip:
   setIntegerParam(pC_->motorStatusProblem_, comStatus ? 1:0);
@@ -17,6 +17,13 @@ March 28, 2011
 #define ACRBinaryOutString      "ACR_BINARY_OUT"
 #define ACRBinaryOutRBVString   "ACR_BINARY_OUT_RBV"
 
+/** Registers read by each poll: 4 per axis and the 2 binary I/O registers */
+#define ACR_MAX_AXES        16
+#define ACR_MAX_POLL_REGS   (4*ACR_MAX_AXES + 2)
+/** Registers read by one combined "?P..." query, so that the response fits in the buffer */
+#define ACR_MAX_QUERY_REGS  16
+#define ACR_QUERY_SIZE      1024
+
 class epicsShareClass ACRAxis : public asynMotorAxis
 {
 public:
@@ -44,6 +51,8 @@ private:
   double theoryPosition_;  /**< Cached copy of the theoretical position */ 
   int currentFlags_;       /**< Cached copy of the current flags */ 
   int currentLimits_;      /**< Cached copy of the current limits */ 
+  int driveOn_;            /**< Cached copy of the drive power on status */ 
+  bool driveCheck_;        /**< Read the drive status on the next poll */ 
   
 friend class ACRController;
 };
@@ -63,8 +72,11 @@ public:
   ACRAxis* getAxis(int axisNo);
 
   
+  asynStatus poll();
+
   /* These are the methods that are new to this class */
   asynStatus readBinaryIO();
+  asynStatus readRegisters(const int *regs, int numRegs, double *values);
   
 protected:
   int ACRJerk_;          /**< Jerk time parameter index */        
@@ -82,6 +94,8 @@ private:
   int binaryOutRBV_;
   int binaryInReg_;
   int binaryOutReg_;
+  asynStatus pollStatus_;  /**< Status of the combined register read of the last poll */
+  int driveAxis_;          /**< Axis whose drive status is read on this poll */
   
 friend class ACRAxis;
 };
@@ -20,6 +20,7 @@ Based on the ACS MCB-4B Model 3 device driver written by Mark Rivers
 #include <epicsString.h>
 
 #include <asynInt32SyncIO.h>
+#include <asynInt32ArraySyncIO.h>
 
 #include "ANG1Driver.h"
 #include <epicsExport.h>
@@ -91,6 +92,21 @@ ANG1Controller::ANG1Controller(const char *portName, const char *ANG1InPortName,
       "%s: cannot connect to ANG1 controller\n",
       functionName);
   }
+  /* The whole input block is read with one array read after one forced Modbus read */
+  pollStatus_ = asynError;
+  memset(inputRegs_, 0, sizeof(inputRegs_));
+  status = pasynInt32SyncIO->connect(ANG1InPortName, 0, &pasynUserForceRead_, "MODBUS_READ");
+  if (status) {
+    asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR, 
+      "%s: cannot connect to MODBUS_READ on %s\n",
+      functionName, ANG1InPortName);
+  }
+  status = pasynInt32ArraySyncIO->connect(ANG1InPortName, 0, &pasynUserInBlock_, NULL);
+  if (status) {
+    asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR, 
+      "%s: cannot connect to the input block of %s\n",
+      functionName, ANG1InPortName);
+  }
   for (axis=0; axis<numAxes; axis++) {
     pAxis = new ANG1Axis(this, axis);
   }
@@ -277,6 +293,40 @@ asynStatus ANG1Controller::readReg32(int reg, epicsInt32 *combo, double timeout)
 }
 
 
+/** Polls the module.
+  * Forces one Modbus read of the input registers and then reads the whole block with one
+  * asynInt32Array call.  ANG1Axis::poll() decodes its fields from the cached block. */
+asynStatus ANG1Controller::poll()
+{
+  size_t nRead = 0;
+  static const char *functionName = "ANG1Controller::poll";
+
+  pollStatus_ = pasynInt32SyncIO->write(pasynUserForceRead_, 1, DEFAULT_CONTROLLER_TIMEOUT);
+  if (pollStatus_ == asynSuccess)
+    pollStatus_ = pasynInt32ArraySyncIO->read(pasynUserInBlock_, inputRegs_, MAX_INPUT_REGS,
+                                              &nRead, DEFAULT_CONTROLLER_TIMEOUT);
+  if ((pollStatus_ == asynSuccess) && (nRead < MAX_INPUT_REGS)) pollStatus_ = asynError;
+  if (pollStatus_) {
+    asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: error reading input registers, status=%d, nRead=%d\n",
+      driverName, functionName, pollStatus_, (int)nRead);
+  }
+  return pollStatus_;
+}
+
+/** Returns a 16-bit input register from the last poll */
+epicsInt32 ANG1Controller::inputReg16(int reg)
+{
+  return (epicsInt16)inputRegs_[reg];
+}
+
+/** Returns a 32-bit value, stored as upper*1000 + lower, from the last poll */
+epicsInt32 ANG1Controller::inputReg32(int reg)
+{
+  return inputReg16(reg) * 1000 + inputReg16(reg+1);
+}
+
+
 // ANG1Axis methods Here
 // These are the ANG1Axis methods
 
@@ -290,16 +340,6 @@ ANG1Axis::ANG1Axis(ANG1Controller *pC, int axisNo)
   : asynMotorAxis(pC, axisNo),
     pC_(pC)	
 { 
-  int status;
-  
-  //status = pasynInt32SyncIO->connect(myModbusInputDriver, 0, &pasynUserForceRead_, "MODBUS_READ");
-  status = pasynInt32SyncIO->connect(pC_->inputDriver_, 0, &pasynUserForceRead_, "MODBUS_READ");
-  if (status) {
-    //printf("%s:%s: Error, unable to connect pasynUserForceRead_ to Modbus input driver %s\n", pC_->inputDriver_, pC_->functionName, myModbusInputDriver);
-    printf("%s: Error, unable to connect pasynUserForceRead_ to Modbus input driver\n", pC_->inputDriver_);	
-  }
-  printf("ANG1Axis::ANG1Axis : pasynUserForceRead_->reason=%d\n", pasynUserForceRead_->reason);
-  
   // set position to 0
   setPosition(0);
 }
@@ -527,7 +567,8 @@ asynStatus ANG1Axis::setClosedLoop(bool closedLoop)
 
 // POLL
 /** Polls the axis.
-  * This function reads motor position, limit status, home status, and moving status
+  * This function decodes motor position, limit status, home status, and moving status
+  * from the input registers that ANG1Controller::poll() read.
   * It calls setIntegerParam() and setDoubleParam() for each item that it polls,
   * and then calls callParamCallbacks() at the end.
   * \param[out] moving A flag that is set indicating that the axis is moving (true) or done (false). */
@@ -537,55 +578,44 @@ asynStatus ANG1Axis::poll(bool *moving)
   int limit;
   int enabled;
   double position;
-  asynStatus status;
-  epicsInt32 read_val;  // don't use a pointer here.  The _address_ of read_val should be passed to the read function.
+  epicsInt32 status1, status2;
   
-  // Force a read operation
-  //printf(" . . . . . Calling pasynInt32SyncIO->write\n");
-  //printf("Calling pasynInt32SyncIO->write(pasynUserForceRead_, 1, TIMEOUT), pasynUserForceRead_->reason=%d\n", pasynUserForceRead_->reason);
-  status = pasynInt32SyncIO->write(pasynUserForceRead_, 1, DEFAULT_CONTROLLER_TIMEOUT);
-  //printf(" . . . . . status = %d\n", status);
-  // if status goto end
-
-  // Read the current motor position
-  // 
-  //readReg32(int reg, epicsInt32 *combo, double timeout)
-  status = pC_->readReg32(POS_RD_UPR, &read_val, DEFAULT_CONTROLLER_TIMEOUT);
-  printf("ANG1Axis::poll:  Motor position raw: %d\n", read_val);
-  position = (double) read_val;
+  if (pC_->pollStatus_) {
+    setIntegerParam(pC_->motorStatusCommsError_, 1);
+    callParamCallbacks();
+    return pC_->pollStatus_;
+  }
+  setIntegerParam(pC_->motorStatusCommsError_, 0);
+
+  // The current motor position
+  position = (double) pC_->inputReg32(POS_RD_UPR);
   setDoubleParam(pC_->motorPosition_, position);
-  printf("ANG1Axis::poll:  Motor position: %f\n", position);
+  asynPrint(pasynUser_, ASYN_TRACEIO_DRIVER, "ANG1Axis::poll:  Motor position: %f\n", position);
 
-  // Read the moving status of this motor
-  //
-  status = pC_->readReg16(STATUS_1, &read_val, DEFAULT_CONTROLLER_TIMEOUT);
-  //printf("status 1 is 0x%X\n", read_val);
+  // The moving status of this motor
+  status1 = pC_->inputReg16(STATUS_1);
   
   // Done logic
-  done = ((read_val & 0x8) >> 3);  // status word 1 bit 3 set to 1 when the motor is not in motion.
+  done = ((status1 & 0x8) >> 3);  // status word 1 bit 3 set to 1 when the motor is not in motion.
   setIntegerParam(pC_->motorStatusDone_, done);
   *moving = done ? false:true;
-  printf("done is %d\n", done);
   
-  // Read the limit status
-  //
-  status = pC_->readReg16(STATUS_2, &read_val, DEFAULT_CONTROLLER_TIMEOUT);
-  printf("status 2 is 0x%X\n", read_val);  
+  // The limit status
+  status2 = pC_->inputReg16(STATUS_2);
+  asynPrint(pasynUser_, ASYN_TRACEIO_DRIVER, "ANG1Axis::poll:  status 1 is 0x%X, status 2 is 0x%X\n",
+    status1, status2);
   
-  limit  = (read_val & 0x1);    // a cw limit has been reached
+  limit  = (status2 & 0x1);    // a cw limit has been reached
   setIntegerParam(pC_->motorStatusHighLimit_, limit);
-  //printf("+limit %d\n", limit);
     if (limit) {   // reset error and set position so we can move off of the limit
     // Reset error
 	setClosedLoop(1);
 	// Reset position
-	//printf(" Reset Position\n");
 	setPosition(position);
   }
 
-  limit  = (read_val & 0x2);    // a ccw limit has been reached
+  limit  = (status2 & 0x2);    // a ccw limit has been reached
   setIntegerParam(pC_->motorStatusLowLimit_, limit);
-  //printf("-limit %d\n", limit);
   if (limit) {   // reset error and set position so we can move off of the limit
     // Reset error
 	setClosedLoop(1);
@@ -599,7 +629,7 @@ asynStatus ANG1Axis::poll(bool *moving)
   setIntegerParam(pC_->motorStatusGainSupport_, 1);
 
   // Check for the torque status and set accordingly.
-  enabled = (read_val & 0x8000);
+  enabled = (status2 & 0x8000);
   if (enabled)
     setIntegerParam(pC_->motorStatusPowerOn_, 1);
   else
@@ -608,7 +638,7 @@ asynStatus ANG1Axis::poll(bool *moving)
   // Notify asynMotorController polling routine that we're ready
   callParamCallbacks();
 
-  return status;
+  return asynSuccess;
 }
 
 /** Code for iocsh registration */
@@ -46,7 +46,6 @@ private:
   ANG1Controller *pC_;          /**< Pointer to the asynMotorController to which this axis belongs.
                                    *   Abbreviated because it is used very frequently */
   asynStatus sendAccelAndVelocity(double accel, double velocity);
-  asynUser *pasynUserForceRead_;
 
 friend class ANG1Controller;
 };
@@ -58,9 +57,11 @@ public:
   void report(FILE *fp, int level);
   ANG1Axis* getAxis(asynUser *pasynUser);
   ANG1Axis* getAxis(int axisNo); 
+  asynStatus poll();
   asynUser *pasynUserInReg_[MAX_INPUT_REGS];
   asynUser *pasynUserOutReg_[MAX_OUTPUT_REGS]; 
-//  asynUser *pasynUserForceRead_;
+  asynUser *pasynUserForceRead_;
+  asynUser *pasynUserInBlock_;    /**< Reads all input registers with one asynInt32Array call */
 
 
   /* These are the methods that we override from asynMotorDriver */
@@ -82,7 +83,11 @@ private:
   asynStatus writeReg32(int, int, double);
   asynStatus readReg16(int, epicsInt32*, double);
   asynStatus readReg32(int, epicsInt32*, double);
+  epicsInt32 inputReg16(int);
+  epicsInt32 inputReg32(int);
   char *inputDriver_;
+  epicsInt32 inputRegs_[MAX_INPUT_REGS];  /**< Input registers from the last poll */
+  asynStatus pollStatus_;                 /**< Status of the last block read */
 
 friend class ANG1Axis;
 };
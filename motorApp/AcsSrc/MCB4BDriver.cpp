@@ -265,41 +265,44 @@ asynStatus MCB4BAxis::poll(bool *moving)
   int limit;
   double position;
   asynStatus comStatus;
-
-  // Read the current motor position
-  sprintf(pC_->outString_, "#%02dP", axisNo_);
-  comStatus = pC_->writeReadController();
+  char commands[4][16];
+  char replies[4][MAX_CONTROLLER_STRING_SIZE];
+  asynMotorTransaction transactions[4];
+  int i;
+
+  // Read the position, moving status, limit status and drive power status
+  // with the queries sent back to back
+  sprintf(commands[0], "#%02dP", axisNo_);
+  sprintf(commands[1], "#%02dX", axisNo_);
+  sprintf(commands[2], "#%02dE", axisNo_);
+  sprintf(commands[3], "#%02dW", axisNo_);
+  memset(transactions, 0, sizeof(transactions));
+  for (i=0; i<4; i++) {
+    transactions[i].command = commands[i];
+    transactions[i].response = replies[i];
+    transactions[i].maxResponseLen = sizeof(replies[i]);
+  }
+  comStatus = pC_->writeReadControllerPipelined(transactions, 4, 4);
   if (comStatus) goto skip;
+
   // The response string is of the form "#01P=+1000"
-  position = atof(&pC_->inString_[5]);
+  position = atof(&replies[0][5]);
   setDoubleParam(pC_->motorPosition_, position);
 
-  // Read the moving status of this motor
-  sprintf(pC_->outString_, "#%02dX", axisNo_);
-  comStatus = pC_->writeReadController();
-  if (comStatus) goto skip;
   // The response string is of the form "#01X=1"
-  done = (pC_->inString_[5] == '0') ? 1:0;
+  done = (replies[1][5] == '0') ? 1:0;
   setIntegerParam(pC_->motorStatusDone_, done);
   *moving = done ? false:true;
 
-  // Read the limit status
-  sprintf(pC_->outString_, "#%02dE", axisNo_);
-  comStatus = pC_->writeReadController();
-  if (comStatus) goto skip;
   // The response string is of the form "#01E=1"
-  limit = (pC_->inString_[5] == '1') ? 1:0;
+  limit = (replies[2][5] == '1') ? 1:0;
   setIntegerParam(pC_->motorStatusHighLimit_, limit);
-  limit = (pC_->inString_[6] == '1') ? 1:0;
+  limit = (replies[2][6] == '1') ? 1:0;
   setIntegerParam(pC_->motorStatusLowLimit_, limit);
-  limit = (pC_->inString_[7] == '1') ? 1:0;
+  limit = (replies[2][7] == '1') ? 1:0;
   setIntegerParam(pC_->motorStatusAtHome_, limit);
 
-  // Read the drive power on status
-  sprintf(pC_->outString_, "#%02dW", axisNo_);
-  comStatus = pC_->writeReadController();
-  if (comStatus) goto skip;
-  driveOn = (pC_->inString_[5] == '1') ? 1:0;
+  driveOn = (replies[3][5] == '1') ? 1:0;
   setIntegerParam(pC_->motorStatusPowerOn_, driveOn);
   setIntegerParam(pC_->motorStatusProblem_, 0);
 
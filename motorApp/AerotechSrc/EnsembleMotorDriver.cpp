@@ -0,0 +1,988 @@
+/*
+FILENAME... EnsembleMotorDriver.cpp
+USAGE...    Motor driver support (model 3) for the Aerotech Ensemble controller.
+
+Based on drvEnsembleAsyn.cc (model 2) and ACRMotorDriver.cpp by:
+Mark Rivers
+March 4, 2011
+
+The Ensemble ASCII interface returns a single value per query, so the number of
+commands per poll cannot be reduced to one.  Instead EnsembleController::poll()
+reads PLANESTATUS once for the whole controller and then reads the per-axis
+status words for all axes in a single pass while holding the port lock.  The
+commanded position and actual velocity are only read while an axis is moving
+(or has just stopped), since they cannot change while the axis is idle.
+
+Profile moves use the AeroBasic program doCommand.bcx (see README), which must
+be present on the controller.  The Ensemble can only execute PVT trajectories
+on one axis through doCommand.bcx, so exactly one axis may be used per profile.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <iocsh.h>
+#include <epicsThread.h>
+
+#include <asynOctetSyncIO.h>
+
+#include "asynMotorController.h"
+#include "asynMotorAxis.h"
+
+#include <epicsExport.h>
+#include "EnsembleMotorDriver.h"
+#include "ParameterId.h"
+
+static const char *driverName = "EnsembleMotorDriver";
+
+/* The following should be defined to have the same value as
+the Ensemble parameters specified */
+#define ASCII_EOS_STR       "\n"
+#define ASCII_ACK_CHAR      '%'   /* AsciiCmdAckChar */
+#define ASCII_NAK_CHAR      '!'   /* AsciiCmdNakChar */
+#define ASCII_FAULT_CHAR    '#'   /* AsciiCmdFaultChar */
+
+#define ENSEMBLE_TIMEOUT    2.0
+#define ENSEMBLE_RETRIES    3
+
+/* Global variables used to communicate with doCommand.bcx; these must match doCommand.ab */
+#define CMD_VAR             45
+#define IARG1_VAR           46
+#define IARG2_VAR           47
+#define CMD_DONE            0
+#define CMD_DOTRAJECTORY    25
+#define CMD_TASK            1
+
+/* PLANESTATUS bit that indicates motion in progress */
+#define PLANE_MOTION_BIT    0x01
+
+/* Number of profile elements downloaded per hold of the lock */
+#define PROFILE_DOWNLOAD_CHUNK 10
+
+static void EnsembleProfileThreadC(void *pPvt);
+
+
+/** Creates a new EnsembleController object.
+  * \param[in] portName          The name of the asyn port that will be created for this driver
+  * \param[in] EnsemblePortName  The name of the drvAsynSerialPort or drvAsynIPPort that was created previously to connect to the Ensemble
+  * \param[in] numAxes           The number of axes that this controller supports
+  * \param[in] movingPollPeriod  The time between polls when any axis is moving
+  * \param[in] idlePollPeriod    The time between polls when no axis is moving
+  */
+EnsembleController::EnsembleController(const char *portName, const char *EnsemblePortName, int numAxes,
+                                       double movingPollPeriod, double idlePollPeriod)
+  :  asynMotorController(portName, numAxes, NUM_ENSEMBLE_PARAMS,
+                         0, // No additional interfaces beyond those in base class
+                         0, // No additional callback interfaces beyond those in base class
+                         ASYN_CANBLOCK | ASYN_MULTIDEVICE,
+                         1, // autoconnect
+                         0, 0),  // Default priority and stack size
+     numEnsembleAxes_(0), numGlobalDoubles_(0), profileAxis_(-1), profileNumElements_(0),
+     profilePVT_(NULL), profileAborted_(false)
+{
+  asynStatus status;
+  int axis, retry, value;
+  char command[MAX_CONTROLLER_STRING_SIZE];
+  char reply[MAX_CONTROLLER_STRING_SIZE];
+  static const char *functionName = "EnsembleController";
+
+  /* Connect to Ensemble controller */
+  status = pasynOctetSyncIO->connect(EnsemblePortName, 0, &pasynUserController_, NULL);
+  if (status) {
+    asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: cannot connect to Ensemble controller\n",
+      driverName, functionName);
+    return;
+  }
+  pasynOctetSyncIO->setInputEos(pasynUserController_, ASCII_EOS_STR, strlen(ASCII_EOS_STR));
+  pasynOctetSyncIO->setOutputEos(pasynUserController_, ASCII_EOS_STR, strlen(ASCII_EOS_STR));
+
+  /* We only care if we get a response, so we don't need to send a valid command */
+  for (retry=0; retry<ENSEMBLE_RETRIES; retry++) {
+    status = sendAndReceive("NONE", reply, sizeof(reply));
+    if ((status == asynSuccess) || (reply[0] == ASCII_NAK_CHAR)) break;
+  }
+
+  /* Create an axis object for each axis that actually exists on the controller */
+  for (axis=0; (axis<ENSEMBLE_MAX_AXES) && (numEnsembleAxes_<numAxes); axis++) {
+    sprintf(command, "GETPARM(@%d, %d)", axis, PARAMETERID_AxisName);
+    if (sendAndReceive(command, reply, sizeof(reply)) != asynSuccess) continue;
+    new EnsembleAxis(this, numEnsembleAxes_++, axis);
+  }
+  if (numEnsembleAxes_ < numAxes) {
+    asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: only %d of %d axes found on Ensemble\n",
+      driverName, functionName, numEnsembleAxes_, numAxes);
+  }
+
+  /* The number of DGLOBAL variables limits the length of a profile */
+  sprintf(command, "GETPARM(%d)", PARAMETERID_GlobalDoubles);
+  if (queryInteger(command, &value) == asynSuccess) numGlobalDoubles_ = value;
+
+  profileExecuteEvent_ = epicsEventMustCreate(epicsEventEmpty);
+  epicsThreadCreate("EnsembleProfile",
+                    epicsThreadPriorityLow,
+                    epicsThreadGetStackSize(epicsThreadStackMedium),
+                    (EPICSTHREADFUNC)EnsembleProfileThreadC, (void *)this);
+
+  startPoller(movingPollPeriod, idlePollPeriod, 2);
+}
+
+
+/** Creates a new EnsembleController object.
+  * Configuration command, called directly or from iocsh
+  * \param[in] portName          The name of the asyn port that will be created for this driver
+  * \param[in] EnsemblePortName  The name of the drvAsynSerialPort or drvAsynIPPort that was created previously to connect to the Ensemble
+  * \param[in] numAxes           The number of axes that this controller supports
+  * \param[in] movingPollPeriod  The time in ms between polls when any axis is moving
+  * \param[in] idlePollPeriod    The time in ms between polls when no axis is moving
+  */
+extern "C" int EnsembleCreateController(const char *portName, const char *EnsemblePortName, int numAxes,
+                                        int movingPollPeriod, int idlePollPeriod)
+{
+  if ((numAxes < 1) || (numAxes > ENSEMBLE_MAX_AXES)) {
+    printf("%s:EnsembleCreateController: numAxes must be in range 1 to %d\n", driverName, ENSEMBLE_MAX_AXES);
+    return asynError;
+  }
+  new EnsembleController(portName, EnsemblePortName, numAxes, movingPollPeriod/1000., idlePollPeriod/1000.);
+  return(asynSuccess);
+}
+
+/** Reports on status of the driver
+  * \param[in] fp The file pointer on which report information will be written
+  * \param[in] level The level of report detail desired
+  *
+  * If details > 0 then information is printed about each axis.
+  * After printing controller-specific information calls asynMotorController::report()
+  */
+void EnsembleController::report(FILE *fp, int level)
+{
+  fprintf(fp, "Ensemble motor driver %s, numAxes=%d, axes found=%d, moving poll period=%f, idle poll period=%f\n",
+    this->portName, numAxes_, numEnsembleAxes_, movingPollPeriod_, idlePollPeriod_);
+  if (level > 0) {
+    fprintf(fp, "  global doubles=%d, profile axis=%d, profile elements=%d\n",
+      numGlobalDoubles_, profileAxis_, profileNumElements_);
+  }
+
+  // Call the base class method
+  asynMotorController::report(fp, level);
+}
+
+/** Returns a pointer to an EnsembleAxis object.
+  * Returns NULL if the axis number encoded in pasynUser is invalid.
+  * \param[in] pasynUser asynUser structure that encodes the axis index number. */
+EnsembleAxis* EnsembleController::getAxis(asynUser *pasynUser)
+{
+  return static_cast<EnsembleAxis*>(asynMotorController::getAxis(pasynUser));
+}
+
+/** Returns a pointer to an EnsembleAxis object.
+  * Returns NULL if the axis number encoded in pasynUser is invalid.
+  * \param[in] axisNo Axis index number. */
+EnsembleAxis* EnsembleController::getAxis(int axisNo)
+{
+  return static_cast<EnsembleAxis*>(asynMotorController::getAxis(axisNo));
+}
+
+/** Sends a command to the Ensemble and reads the response.
+  * Retries the read if the controller does not respond within the timeout.
+  * Returns asynError if the controller did not acknowledge the command.
+  * \param[in] output The command string
+  * \param[out] input The reply; the value follows the acknowledge character
+  * \param[in] maxChars Size of the input buffer */
+asynStatus EnsembleController::sendAndReceive(const char *output, char *input, size_t maxChars)
+{
+  size_t nread;
+  int eomReason;
+  int retry;
+  asynStatus status;
+  static const char *functionName = "sendAndReceive";
+
+  input[0] = 0;
+  status = writeReadController(output, input, maxChars, &nread, ENSEMBLE_TIMEOUT);
+  for (retry=1; (status == asynTimeout) && (retry <= ENSEMBLE_RETRIES); retry++) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: retrying read, retry# = %d, command=%s\n",
+      driverName, functionName, retry, output);
+    status = pasynOctetSyncIO->read(pasynUserController_, input, maxChars, ENSEMBLE_TIMEOUT, &nread, &eomReason);
+  }
+  if (status) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: writeRead error, command=%s, status=%d, error=%s\n",
+      driverName, functionName, output, status, pasynUserController_->errorMessage);
+    return status;
+  }
+  if (input[0] == ASCII_FAULT_CHAR) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: error returned for command=%s, response=%s\n",
+      driverName, functionName, output, input);
+  }
+  return (input[0] == ASCII_ACK_CHAR) ? asynSuccess : asynError;
+}
+
+/** Sends a command to the Ensemble and discards the response value. */
+asynStatus EnsembleController::sendCommand(const char *output)
+{
+  char reply[MAX_CONTROLLER_STRING_SIZE];
+
+  return sendAndReceive(output, reply, sizeof(reply));
+}
+
+/** Sends a query to the Ensemble and converts the response to an integer. */
+asynStatus EnsembleController::queryInteger(const char *output, int *value)
+{
+  char reply[MAX_CONTROLLER_STRING_SIZE];
+  asynStatus status;
+
+  status = sendAndReceive(output, reply, sizeof(reply));
+  if (status == asynSuccess) *value = atoi(&reply[1]);
+  return status;
+}
+
+/** Sends a query to the Ensemble and converts the response to a double. */
+asynStatus EnsembleController::queryDouble(const char *output, double *value)
+{
+  char reply[MAX_CONTROLLER_STRING_SIZE];
+  asynStatus status;
+
+  status = sendAndReceive(output, reply, sizeof(reply));
+  if (status == asynSuccess) *value = atof(&reply[1]);
+  return status;
+}
+
+/** Polls the controller, rather than individual axes.
+  * Reads PLANESTATUS once, and then the status of every axis in one pass.
+  * EnsembleAxis::poll() then only decodes the values read here. */
+asynStatus EnsembleController::poll()
+{
+  int planeStatus = 0;
+  bool planeMoving;
+  int axis;
+  EnsembleAxis *pAxis;
+  asynStatus status;
+
+  status = queryInteger("PLANESTATUS(0)", &planeStatus);
+  planeMoving = (status == asynSuccess) && (planeStatus & PLANE_MOTION_BIT);
+
+  for (axis=0; axis<numAxes_; axis++) {
+    pAxis = getAxis(axis);
+    if (!pAxis) continue;
+    pAxis->readStatus(planeMoving);
+  }
+  return asynSuccess;
+}
+
+
+/* These are the functions for profile moves */
+
+/** Builds a PVT profile for the single axis in use.
+  * The positions, velocities and absolute times are stored in profilePVT_, and are
+  * downloaded to the DGLOBAL variables by runProfile(), because in relative mode
+  * they depend on the position when the profile is executed. */
+asynStatus EnsembleController::buildProfile()
+{
+  int i, j;
+  int numPoints;
+  int numUsed = 0;
+  int useAxis;
+  int buildStatus;
+  bool buildOK = true;
+  double accelTime, time, D0, D1, T0, T1;
+  double velocity, position;
+  double *pvt;
+  EnsembleAxis *pAxis = NULL;
+  char message[MAX_CONTROLLER_STRING_SIZE];
+  static const char *functionName = "buildProfile";
+
+  // Call the base class method which will build the time array if needed
+  asynMotorController::buildProfile();
+
+  strcpy(message, "");
+  setStringParam(profileBuildMessage_, message);
+  setIntegerParam(profileBuildState_, PROFILE_BUILD_BUSY);
+  setIntegerParam(profileBuildStatus_, PROFILE_STATUS_UNDEFINED);
+  callParamCallbacks();
+
+  getIntegerParam(profileNumPoints_, &numPoints);
+  getDoubleParam(profileAcceleration_, &accelTime);
+  profileAxis_ = -1;
+  profileNumElements_ = 0;
+
+  for (j=0; j<numAxes_; j++) {
+    getIntegerParam(j, profileUseAxis_, &useAxis);
+    if (!useAxis || !getAxis(j)) continue;
+    numUsed++;
+    profileAxis_ = j;
+  }
+  if (numUsed != 1) {
+    buildOK = false;
+    sprintf(message, "Ensemble profiles must use exactly 1 axis, %d selected", numUsed);
+    goto done;
+  }
+  if (numPoints < 2) {
+    buildOK = false;
+    sprintf(message, "Profile must have at least 2 points");
+    goto done;
+  }
+  if (accelTime <= 0.) {
+    buildOK = false;
+    sprintf(message, "Profile acceleration time must be > 0");
+    goto done;
+  }
+  /* A deceleration element is added to the user's points.  The acceleration needs no
+   * element: the axis starts at rest and reaches the first point at time accelTime. */
+  profileNumElements_ = numPoints + 1;
+  if (3*profileNumElements_ > numGlobalDoubles_) {
+    buildOK = false;
+    sprintf(message, "Profile needs %d global doubles, Ensemble has %d",
+            3*profileNumElements_, numGlobalDoubles_);
+    goto done;
+  }
+  for (i=0; i<numPoints-1; i++) {
+    if (profileTimes_[i] <= 0.) {
+      buildOK = false;
+      sprintf(message, "Profile time for element %d must be > 0", i);
+      goto done;
+    }
+  }
+
+  if (profilePVT_) free(profilePVT_);
+  profilePVT_ = (double *)calloc(3*profileNumElements_, sizeof(double));
+  pvt = profilePVT_;
+  pAxis = getAxis(profileAxis_);
+
+  /* Convert from controller steps to Ensemble units, and compute the velocity at each
+   * point as the average either side of the point */
+  time = accelTime;
+  for (i=0; i<numPoints; i++) {
+    T0 = (i > 0) ? profileTimes_[i-1] : profileTimes_[0];
+    T1 = (i < numPoints-1) ? profileTimes_[i] : T0;
+    D0 = (i > 0) ? pAxis->profilePositions_[i] - pAxis->profilePositions_[i-1] :
+                   pAxis->profilePositions_[1] - pAxis->profilePositions_[0];
+    D1 = (i < numPoints-1) ? pAxis->profilePositions_[i+1] - pAxis->profilePositions_[i] : D0;
+    velocity = (D0 + D1) / (T0 + T1);
+    *pvt++ = pAxis->profilePositions_[i] * fabs(pAxis->stepSize_);
+    *pvt++ = velocity * fabs(pAxis->stepSize_);
+    *pvt++ = time;
+    if (i < numPoints-1) time += profileTimes_[i];
+  }
+  /* Decelerate to 0 at the end of the profile */
+  velocity = pvt[-2];
+  position = pvt[-3] + 0.5 * velocity * accelTime;
+  *pvt++ = position;
+  *pvt++ = 0.;
+  *pvt++ = time + accelTime;
+
+  done:
+  buildStatus = buildOK ? PROFILE_STATUS_SUCCESS : PROFILE_STATUS_FAILURE;
+  setIntegerParam(profileBuildStatus_, buildStatus);
+  setStringParam(profileBuildMessage_, message);
+  if (!buildOK) {
+    profileNumElements_ = 0;
+    asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s:%s: %s\n",
+              driverName, functionName, message);
+  }
+  /* Clear build command.  This is a "busy" record, don't want to do this until build is complete. */
+  setIntegerParam(profileBuild_, 0);
+  setIntegerParam(profileBuildState_, PROFILE_BUILD_DONE);
+  callParamCallbacks();
+  return buildOK ? asynSuccess : asynError;
+}
+
+/* Function to execute trajectory */
+asynStatus EnsembleController::executeProfile()
+{
+  lock();
+  profileAborted_ = false;
+  unlock();
+  epicsEventSignal(profileExecuteEvent_);
+  return asynSuccess;
+}
+
+/* C Function which runs the profile thread */
+static void EnsembleProfileThreadC(void *pPvt)
+{
+  EnsembleController *pC = (EnsembleController*)pPvt;
+  pC->profileThread();
+}
+
+/* Function which runs in its own thread to execute profiles */
+void EnsembleController::profileThread()
+{
+  while (true) {
+    epicsEventWait(profileExecuteEvent_);
+    runProfile();
+  }
+}
+
+/** Makes sure doCommand.bcx is running in task 1 of the Ensemble. */
+asynStatus EnsembleController::startCommandProgram()
+{
+  int taskState = 0;
+  char command[MAX_CONTROLLER_STRING_SIZE];
+  asynStatus status;
+
+  status = queryInteger("TASKSTATE(1)", &taskState);
+  if (status == asynSuccess && taskState == 3) return asynSuccess;   /* Already running */
+  if (status != asynSuccess || taskState == 6) sendCommand("PROGRAM STOP 1");
+  sprintf(command, "IGLOBAL(%d) = %d", CMD_VAR, CMD_DONE);
+  sendCommand(command);
+  status = sendCommand("PROGRAM RUN 1, \"doCommand.bcx\"");
+  epicsThreadSleep(0.1);
+  return status;
+}
+
+/** Returns true if abortProfile() has been called since the profile was started. */
+bool EnsembleController::isProfileAborted()
+{
+  bool aborted;
+
+  lock();
+  aborted = profileAborted_;
+  unlock();
+  return aborted;
+}
+
+/** Waits for the profile axis to stop moving.  Must be called without the lock held. */
+asynStatus EnsembleController::waitMotionDone()
+{
+  bool moving;
+  EnsembleAxis *pAxis;
+
+  while (1) {
+    epicsThreadSleep(movingPollPeriod_);
+    lock();
+    pAxis = getAxis(profileAxis_);
+    moving = pAxis && pAxis->moveActive_;
+    unlock();
+    if (!moving) break;
+  }
+  return asynSuccess;
+}
+
+/* Function to run trajectory.  It runs in a dedicated thread, so it's OK to block.
+ * It needs to lock and unlock when it accesses class data. */
+asynStatus EnsembleController::runProfile()
+{
+  int i, end;
+  int numElements;
+  int moveMode;
+  int cmdState = 0;
+  int executeStatus;
+  bool executeOK = true;
+  double offset = 0.;
+  double *pvt;
+  asynStatus status = asynSuccess;
+  EnsembleAxis *pAxis;
+  char command[MAX_CONTROLLER_STRING_SIZE];
+  char message[MAX_CONTROLLER_STRING_SIZE];
+  static const char *functionName = "runProfile";
+
+  lock();
+  strcpy(message, " ");
+  setStringParam(profileExecuteMessage_, message);
+  setIntegerParam(profileExecuteState_, PROFILE_EXECUTE_MOVE_START);
+  setIntegerParam(profileExecuteStatus_, PROFILE_STATUS_UNDEFINED);
+  callParamCallbacks();
+  getIntegerParam(profileMoveMode_, &moveMode);
+  pAxis = getAxis(profileAxis_);
+  if (!pAxis || (profileNumElements_ == 0)) {
+    executeOK = false;
+    sprintf(message, "Profile has not been built");
+    unlock();
+    goto done;
+  }
+  if (moveMode == PROFILE_MOVE_MODE_RELATIVE) {
+    offset = pAxis->commandPosition_ * fabs(pAxis->stepSize_) - profilePVT_[0];
+  }
+  numElements = profileNumElements_;
+  unlock();
+
+  /* Download the profile into DGLOBAL(0) ... DGLOBAL(3*numElements-1).  The lock is
+   * released between chunks, so that the poller and the axes are not held off. */
+  for (i=0; i<numElements; ) {
+    lock();
+    if (profileAborted_) {
+      unlock();
+      goto aborted;
+    }
+    if (profileNumElements_ != numElements) {
+      unlock();
+      executeOK = false;
+      sprintf(message, "Profile was rebuilt while downloading");
+      goto done;
+    }
+    end = i + PROFILE_DOWNLOAD_CHUNK;
+    if (end > numElements) end = numElements;
+    for (; i<end; i++) {
+      pvt = &profilePVT_[3*i];
+      sprintf(command, "DGLOBAL(%d) = %.*f", 3*i,   pAxis->maxDigits_, pvt[0] + offset);
+      status = sendCommand(command);
+      sprintf(command, "DGLOBAL(%d) = %.*f", 3*i+1, pAxis->maxDigits_, pvt[1]);
+      status = (asynStatus)(status | sendCommand(command));
+      sprintf(command, "DGLOBAL(%d) = %f",   3*i+2, pvt[2]);
+      status = (asynStatus)(status | sendCommand(command));
+      if (status) break;
+    }
+    unlock();
+    if (status) {
+      executeOK = false;
+      sprintf(message, "Error downloading profile element %d", i);
+      goto done;
+    }
+  }
+
+  /* Move to the start position, from which the axis accelerates to the first point */
+  lock();
+  sprintf(command, "LINEAR @%d %.*f", pAxis->ensembleAxis_, pAxis->maxDigits_,
+          profilePVT_[0] + offset - 0.5 * profilePVT_[1] * profilePVT_[2]);
+  sendCommand("ABS");
+  status = sendCommand(command);
+  unlock();
+  wakeupPoller();
+  if (status) {
+    executeOK = false;
+    sprintf(message, "Error moving to start position");
+    goto done;
+  }
+  waitMotionDone();
+  if (isProfileAborted()) goto aborted;
+
+  lock();
+  setIntegerParam(profileExecuteState_, PROFILE_EXECUTE_EXECUTING);
+  callParamCallbacks();
+  status = startCommandProgram();
+  sprintf(command, "IGLOBAL(%d) = %d", IARG1_VAR, pAxis->ensembleAxis_);
+  status = (asynStatus)(status | sendCommand(command));
+  sprintf(command, "IGLOBAL(%d) = %d", IARG2_VAR, profileNumElements_);
+  status = (asynStatus)(status | sendCommand(command));
+  sprintf(command, "IGLOBAL(%d) = %d", CMD_VAR, CMD_DOTRAJECTORY);
+  status = (asynStatus)(status | sendCommand(command));
+  unlock();
+  if (status) {
+    executeOK = false;
+    sprintf(message, "Error starting doCommand.bcx trajectory");
+    goto done;
+  }
+  wakeupPoller();
+
+  /* doCommand.bcx negates IGLOBAL(CMD_VAR) when all PVT elements have been queued */
+  sprintf(command, "IGLOBAL(%d)", CMD_VAR);
+  while (!isProfileAborted()) {
+    epicsThreadSleep(movingPollPeriod_);
+    lock();
+    status = queryInteger(command, &cmdState);
+    unlock();
+    if (status || (cmdState <= 0)) break;
+  }
+  waitMotionDone();
+  if (isProfileAborted()) goto aborted;
+
+  done:
+  lock();
+  if (executeOK)           executeStatus = PROFILE_STATUS_SUCCESS;
+  else                     executeStatus = PROFILE_STATUS_FAILURE;
+  goto finish;
+
+  aborted:
+  lock();
+  executeOK = false;
+  executeStatus = PROFILE_STATUS_ABORT;
+  sprintf(message, "Profile aborted");
+
+  finish:
+  setIntegerParam(profileExecuteStatus_, executeStatus);
+  setStringParam(profileExecuteMessage_, message);
+  if (!executeOK) {
+    asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s:%s: %s\n",
+              driverName, functionName, message);
+  }
+  /* Clear execute command.  This is a "busy" record, don't want to do this until execute is complete. */
+  setIntegerParam(profileExecute_, 0);
+  setIntegerParam(profileExecuteState_, PROFILE_EXECUTE_DONE);
+  callParamCallbacks();
+  unlock();
+  return executeOK ? asynSuccess : asynError;
+}
+
+/** Aborts a profile move by aborting motion on the profile axis. */
+asynStatus EnsembleController::abortProfile()
+{
+  char command[MAX_CONTROLLER_STRING_SIZE];
+  EnsembleAxis *pAxis;
+  asynStatus status = asynSuccess;
+
+  lock();
+  profileAborted_ = true;
+  pAxis = getAxis(profileAxis_);
+  if (pAxis) {
+    sprintf(command, "ABORT @%d", pAxis->ensembleAxis_);
+    status = sendCommand(command);
+  }
+  unlock();
+  return status;
+}
+
+/** The Ensemble ASCII interface gives no access to data captured during the profile,
+  * so readbacks are not supported. */
+asynStatus EnsembleController::readbackProfile()
+{
+  setIntegerParam(profileReadbackState_, PROFILE_READBACK_BUSY);
+  callParamCallbacks();
+  setIntegerParam(profileNumReadbacks_, 0);
+  setIntegerParam(profileReadbackStatus_, PROFILE_STATUS_FAILURE);
+  setStringParam(profileReadbackMessage_, "Readback not supported by Ensemble");
+  setIntegerParam(profileReadback_, 0);
+  setIntegerParam(profileReadbackState_, PROFILE_READBACK_DONE);
+  callParamCallbacks();
+  return asynSuccess;
+}
+
+
+// These are the EnsembleAxis methods
+
+/** Creates a new EnsembleAxis object.
+  * \param[in] pC Pointer to the EnsembleController to which this axis belongs.
+  * \param[in] axisNo Index number of this axis, range 0 to pC->numAxes_-1.
+  * \param[in] ensembleAxis Axis number on the Ensemble.
+  *
+  * Reads the axis configuration parameters that the driver needs from the controller.
+  */
+EnsembleAxis::EnsembleAxis(EnsembleController *pC, int axisNo, int ensembleAxis)
+  : asynMotorAxis(pC, axisNo),
+    pC_(pC), ensembleAxis_(ensembleAxis), stepSize_(1.), homePreset_(0.), homeDirection_(0),
+    reverseDirec_(false), lastFault_(0), pollStatus_(asynSuccess), axisFault_(0), moveActive_(false),
+    encoderPosition_(0.), commandPosition_(0.), actualVelocity_(0.), refreshCommand_(true)
+{
+  char command[MAX_CONTROLLER_STRING_SIZE];
+  double countsPerUnit;
+  int value;
+
+  axisStatus_.All = 0;
+  swconfig_.All = 0;
+
+  sprintf(command, "GETPARM(@%d, %d)", ensembleAxis_, PARAMETERID_PositionFeedbackType);
+  if ((pC_->queryInteger(command, &value) == asynSuccess) && (value > 0))
+    setIntegerParam(pC_->motorStatusHasEncoder_, 1);
+
+  sprintf(command, "GETPARM(@%d, %d)", ensembleAxis_, PARAMETERID_CountsPerUnit);
+  if ((pC_->queryDouble(command, &countsPerUnit) == asynSuccess) && (countsPerUnit != 0.))
+    stepSize_ = 1. / countsPerUnit;
+  maxDigits_ = (int) -log10(fabs(stepSize_)) + 2;
+  if (maxDigits_ < 1) maxDigits_ = 1;
+
+  sprintf(command, "GETPARM(@%d, %d)", ensembleAxis_, PARAMETERID_HomeOffset);
+  pC_->queryDouble(command, &homePreset_);
+
+  sprintf(command, "GETPARM(@%d, %d)", ensembleAxis_, PARAMETERID_HomeSetup);
+  pC_->queryInteger(command, &homeDirection_);
+
+  sprintf(command, "GETPARM(@%d, %d)", ensembleAxis_, PARAMETERID_EndOfTravelLimitSetup);
+  if (pC_->queryInteger(command, &value) == asynSuccess) swconfig_.All = value;
+
+  /* Set RAMP MODE to RATE. */
+  sprintf(command, "RAMP MODE @%d RATE", ensembleAxis_);
+  pC_->sendCommand(command);
+
+  sprintf(command, "GETPARM(@%d, %d)", ensembleAxis_, PARAMETERID_ReverseMotionDirection);
+  if (pC_->queryInteger(command, &value) == asynSuccess) reverseDirec_ = (value != 0);
+
+  /* Set GAIN_SUPPORT on so that at least, CNEN functions. */
+  setIntegerParam(pC_->motorStatusGainSupport_, 1);
+}
+
+/** Reports on status of the axis
+  * \param[in] fp The file pointer on which report information will be written
+  * \param[in] level The level of report detail desired
+  *
+  * After printing device-specific information calls asynMotorAxis::report()
+  */
+void EnsembleAxis::report(FILE *fp, int level)
+{
+  if (level > 0) {
+    fprintf(fp, "  axis %d, Ensemble axis %d\n", axisNo_, ensembleAxis_);
+    fprintf(fp, "    axisStatus:  0x%x\n", axisStatus_.All);
+    fprintf(fp, "    home preset: %f\n", homePreset_);
+    fprintf(fp, "    step size:   %f\n", stepSize_);
+    fprintf(fp, "    max digits:  %d\n", maxDigits_);
+  }
+
+  // Call the base class method
+  asynMotorAxis::report(fp, level);
+}
+
+asynStatus EnsembleAxis::move(double position, int relative, double minVelocity, double maxVelocity, double acceleration)
+{
+  asynStatus status;
+  bool posdir;
+
+  if (relative) {
+    posdir = (position >= 0.0);
+    status = pC_->sendCommand("INC");
+  } else {
+    posdir = (position >= commandPosition_);
+    status = pC_->sendCommand("ABS");
+  }
+  if (status) return status;
+
+  if (acceleration > 0) { /* only use the acceleration if > 0 */
+    sprintf(pC_->outString_, "RAMP RATE %.*f", maxDigits_, acceleration * fabs(stepSize_));
+    pC_->sendCommand(pC_->outString_);
+  }
+
+  sprintf(pC_->outString_, "LINEAR @%d %.*f F%.*f", ensembleAxis_, maxDigits_, position * fabs(stepSize_),
+          maxDigits_, maxVelocity * fabs(stepSize_));
+  status = pC_->sendCommand(pC_->outString_);
+  if (status) return status;
+
+  setIntegerParam(pC_->motorStatusDirection_, posdir ? 1 : 0);
+  refreshCommand_ = true;
+  return asynSuccess;
+}
+
+asynStatus EnsembleAxis::home(double minVelocity, double maxVelocity, double acceleration, int forwards)
+{
+  asynStatus status;
+  int posdir;
+
+  if (maxVelocity > 0) {
+    sprintf(pC_->outString_, "SETPARM @%d, %d, %.*f", ensembleAxis_, PARAMETERID_HomeSpeed, maxDigits_,
+            maxVelocity * fabs(stepSize_)); /* HomeFeedRate */
+    pC_->sendCommand(pC_->outString_);
+  }
+  if (acceleration > 0) {
+    sprintf(pC_->outString_, "SETPARM @%d, %d, %.*f", ensembleAxis_, PARAMETERID_HomeRampRate, maxDigits_,
+            acceleration * fabs(stepSize_)); /* HomeAccelDecelRate */
+    pC_->sendCommand(pC_->outString_);
+  }
+
+  posdir = (forwards == (int) reverseDirec_); /* Adjust home direction for Reverse Direction paramter. */
+  if (posdir == 1)
+    homeDirection_ |= 0x00000001;
+  else
+    homeDirection_ &= 0xFFFFFFFE;
+  sprintf(pC_->outString_, "SETPARM @%d, %d, %d", ensembleAxis_, PARAMETERID_HomeSetup, homeDirection_); /* HomeDirection */
+  pC_->sendCommand(pC_->outString_);
+
+  /* Set IGLOBAL(32) for one axis and IGLOBAL(33) for axis #; according to HomeAsync.ab protocol*/
+  pC_->sendCommand("IGLOBAL(32) = 1");
+  sprintf(pC_->outString_, "IGLOBAL(33) = %d", ensembleAxis_);
+  pC_->sendCommand(pC_->outString_);
+
+  status = pC_->sendCommand("PROGRAM RUN 5, \"HomeAsync.bcx\"");
+  if (status) return status;
+
+  setIntegerParam(pC_->motorStatusDirection_, forwards);
+  refreshCommand_ = true;
+  return asynSuccess;
+}
+
+asynStatus EnsembleAxis::moveVelocity(double minVelocity, double maxVelocity, double acceleration)
+{
+  asynStatus status;
+
+  sprintf(pC_->outString_, "SETPARM @%d, %d, %.*f", ensembleAxis_, PARAMETERID_AbortDecelRate,
+          maxDigits_, acceleration * fabs(stepSize_));
+  pC_->sendCommand(pC_->outString_);
+  sprintf(pC_->outString_, "RAMP RATE @%d %.*f", ensembleAxis_, maxDigits_, acceleration * fabs(stepSize_));
+  pC_->sendCommand(pC_->outString_);
+  sprintf(pC_->outString_, "FREERUN @%d %.*f", ensembleAxis_, maxDigits_, maxVelocity * fabs(stepSize_));
+  status = pC_->sendCommand(pC_->outString_);
+
+  setIntegerParam(pC_->motorStatusDirection_, (maxVelocity > 0.0) ? 1 : 0);
+  refreshCommand_ = true;
+  return status;
+}
+
+asynStatus EnsembleAxis::stop(double acceleration)
+{
+  /* we can't accurately determine which type of motion is occurring on the controller,
+   * so don't worry about the acceleration rate, just stop the motion on the axis */
+  sprintf(pC_->outString_, "ABORT @%d", ensembleAxis_);
+  return pC_->sendCommand(pC_->outString_);
+}
+
+asynStatus EnsembleAxis::setPosition(double position)
+{
+  sprintf(pC_->outString_, "POSOFFSET SET @%d, %.*f", ensembleAxis_, maxDigits_, position * fabs(stepSize_));
+  refreshCommand_ = true;
+  return pC_->sendCommand(pC_->outString_);
+}
+
+asynStatus EnsembleAxis::setClosedLoop(bool closedLoop)
+{
+  asynStatus status;
+  int faultStatus;
+  static const char *functionName = "setClosedLoop";
+
+  if (closedLoop) {
+    sprintf(pC_->outString_, "AXISFAULT @%d", ensembleAxis_);
+    if ((pC_->queryInteger(pC_->outString_, &faultStatus) == asynSuccess) && faultStatus) {
+      asynPrint(pasynUser_, ASYN_TRACE_ERROR,
+        "%s:%s: FAULTACK = %X\n",
+        driverName, functionName, faultStatus);
+      sprintf(pC_->outString_, "FAULTACK @%d", ensembleAxis_);
+      pC_->sendCommand(pC_->outString_);
+    }
+    sprintf(pC_->outString_, "ENABLE @%d", ensembleAxis_);
+  } else {
+    sprintf(pC_->outString_, "DISABLE @%d", ensembleAxis_);
+  }
+  status = pC_->sendCommand(pC_->outString_);
+  /* Set indicator to force status update when Enable does not work. */
+  setIntegerParam(pC_->motorStatusPowerOn_, closedLoop ? 1 : 0);
+
+  /* Prevent ASCII interpreter from blocking during MOVEABS/INC commands. */
+  pC_->sendCommand("WAIT MODE NOWAIT");
+  return status;
+}
+
+/** Reads the status of this axis from the controller.
+  * Called by EnsembleController::poll() for every axis before the axes are polled.
+  * The commanded position and velocity are only read while the axis is moving,
+  * or on the first poll after it stopped or was told to move.
+  * \param[in] planeMoving Motion flag from PLANESTATUS, which is shared by all axes. */
+asynStatus EnsembleAxis::readStatus(bool planeMoving)
+{
+  int value;
+  bool readCommand;
+
+  sprintf(pC_->outString_, "AXISSTATUS(@%d)", ensembleAxis_);
+  pollStatus_ = pC_->queryInteger(pC_->outString_, &value);
+  if (pollStatus_) return pollStatus_;
+  axisStatus_.All = value;
+  readCommand = refreshCommand_ || moveActive_;
+  moveActive_ = planeMoving || axisStatus_.Bits.move_active;
+  readCommand = readCommand || moveActive_;
+
+  sprintf(pC_->outString_, "PFBKPROG(@%d)", ensembleAxis_);
+  pollStatus_ = pC_->queryDouble(pC_->outString_, &encoderPosition_);
+  if (pollStatus_) return pollStatus_;
+  encoderPosition_ /= fabs(stepSize_);
+
+  sprintf(pC_->outString_, "AXISFAULT(@%d)", ensembleAxis_);
+  pollStatus_ = pC_->queryInteger(pC_->outString_, &axisFault_);
+  if (pollStatus_) return pollStatus_;
+
+  if (readCommand) {
+    sprintf(pC_->outString_, "PCMDPROG(@%d)", ensembleAxis_);
+    pollStatus_ = pC_->queryDouble(pC_->outString_, &commandPosition_);
+    if (pollStatus_) return pollStatus_;
+    commandPosition_ /= fabs(stepSize_);
+
+    sprintf(pC_->outString_, "VFBK(@%d)", ensembleAxis_);
+    pollStatus_ = pC_->queryDouble(pC_->outString_, &actualVelocity_);
+    if (pollStatus_) return pollStatus_;
+    actualVelocity_ /= fabs(stepSize_);
+    refreshCommand_ = false;
+  } else {
+    actualVelocity_ = 0.;
+  }
+  return asynSuccess;
+}
+
+/** Polls the axis.
+  * The values were read from the controller by EnsembleController::poll(); this
+  * function decodes them and calls setIntegerParam() and setDoubleParam() for each item,
+  * and then calls callParamCallbacks() at the end.
+  * \param[out] moving A flag that is set indicating that the axis is moving (1) or done (0). */
+asynStatus EnsembleAxis::poll(bool *moving)
+{
+  int CW_sw_active, CCW_sw_active;
+  static const char *functionName = "poll";
+
+  *moving = false;
+  if (pollStatus_) goto skip;
+
+  *moving = moveActive_;
+  setIntegerParam(pC_->motorStatusDone_, moveActive_ ? 0 : 1);
+  setIntegerParam(pC_->motorStatusMoving_, moveActive_ ? 1 : 0);
+  setIntegerParam(pC_->motorStatusPowerOn_, axisStatus_.Bits.axis_enabled);
+  setIntegerParam(pC_->motorStatusHome_, axisStatus_.Bits.home_limit);
+
+  if (reverseDirec_)
+    setIntegerParam(pC_->motorStatusDirection_, axisStatus_.Bits.motion_ccw);
+  else
+    setIntegerParam(pC_->motorStatusDirection_, !axisStatus_.Bits.motion_ccw);
+
+  CW_sw_active  = !(axisStatus_.Bits.CW_limit  ^ swconfig_.Bits.CWEOTSWstate);
+  CCW_sw_active = !(axisStatus_.Bits.CCW_limit ^ swconfig_.Bits.CCWEOTSWstate);
+  if (!reverseDirec_) {
+    setIntegerParam(pC_->motorStatusHighLimit_, CW_sw_active);
+    setIntegerParam(pC_->motorStatusLowLimit_,  CCW_sw_active);
+  } else {
+    setIntegerParam(pC_->motorStatusHighLimit_, CCW_sw_active);
+    setIntegerParam(pC_->motorStatusLowLimit_,  CW_sw_active);
+  }
+
+  setDoubleParam(pC_->motorEncoderPosition_, encoderPosition_);
+  setDoubleParam(pC_->motorPosition_, commandPosition_);
+  setDoubleParam(pC_->motorVelocity_, actualVelocity_);
+
+  if (axisFault_ == 0) {
+    lastFault_ = 0;
+    setIntegerParam(pC_->motorStatusProblem_, 0);
+  } else {
+    setIntegerParam(pC_->motorStatusProblem_, 1);
+    if (axisFault_ != lastFault_) {
+      lastFault_ = axisFault_;
+      asynPrint(pasynUser_, ASYN_TRACE_ERROR,
+        "%s:%s: controller fault on axis=%d fault=0x%X\n",
+        driverName, functionName, axisNo_, axisFault_);
+    }
+  }
+
+  skip:
+  setIntegerParam(pC_->motorStatusCommsError_, pollStatus_ ? 1 : 0);
+  callParamCallbacks();
+  return pollStatus_ ? asynError : asynSuccess;
+}
+
+/** Code for iocsh registration */
+static const iocshArg EnsembleCreateControllerArg0 = {"Port name", iocshArgString};
+static const iocshArg EnsembleCreateControllerArg1 = {"Ensemble port name", iocshArgString};
+static const iocshArg EnsembleCreateControllerArg2 = {"Number of axes", iocshArgInt};
+static const iocshArg EnsembleCreateControllerArg3 = {"Moving poll period (ms)", iocshArgInt};
+static const iocshArg EnsembleCreateControllerArg4 = {"Idle poll period (ms)", iocshArgInt};
+static const iocshArg * const EnsembleCreateControllerArgs[] = {&EnsembleCreateControllerArg0,
+                                                                &EnsembleCreateControllerArg1,
+                                                                &EnsembleCreateControllerArg2,
+                                                                &EnsembleCreateControllerArg3,
+                                                                &EnsembleCreateControllerArg4};
+static const iocshFuncDef EnsembleCreateControllerDef = {"EnsembleCreateController", 5, EnsembleCreateControllerArgs};
+static void EnsembleCreateContollerCallFunc(const iocshArgBuf *args)
+{
+  EnsembleCreateController(args[0].sval, args[1].sval, args[2].ival, args[3].ival, args[4].ival);
+}
+
+/* EnsembleCreateProfile */
+static const iocshArg EnsembleCreateProfileArg0 = {"Port name", iocshArgString};
+static const iocshArg EnsembleCreateProfileArg1 = {"Max points", iocshArgInt};
+static const iocshArg * const EnsembleCreateProfileArgs[] = {&EnsembleCreateProfileArg0,
+                                                             &EnsembleCreateProfileArg1};
+static const iocshFuncDef EnsembleCreateProfileDef = {"EnsembleCreateProfile", 2, EnsembleCreateProfileArgs};
+static void EnsembleCreateProfileCallFunc(const iocshArgBuf *args)
+{
+  EnsembleController *pC = (EnsembleController*) findAsynPortDriver(args[0].sval);
+  if (!pC) {
+    printf("%s:EnsembleCreateProfile: Error port %s not found\n", driverName, args[0].sval);
+    return;
+  }
+  pC->lock();
+  pC->initializeProfile(args[1].ival);
+  pC->unlock();
+}
+
+static void EnsembleMotorRegister(void)
+{
+  iocshRegister(&EnsembleCreateControllerDef, EnsembleCreateContollerCallFunc);
+  iocshRegister(&EnsembleCreateProfileDef, EnsembleCreateProfileCallFunc);
+}
+
+extern "C" {
+epicsExportRegistrar(EnsembleMotorRegister);
+}
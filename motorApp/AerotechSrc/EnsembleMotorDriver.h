@@ -0,0 +1,101 @@
+/*
+FILENAME...   EnsembleMotorDriver.h
+USAGE...      Motor driver support (model 3) for the Aerotech Ensemble controller.
+
+Based on drvEnsembleAsyn.cc (model 2) and ACRMotorDriver.h by:
+Mark Rivers
+March 28, 2011
+
+*/
+
+#include <epicsEvent.h>
+
+#include "asynMotorController.h"
+#include "asynMotorAxis.h"
+#include "drvEnsembleAsyn.h"
+
+#define ENSEMBLE_MAX_AXES 10
+
+// No controller-specific parameters yet
+#define NUM_ENSEMBLE_PARAMS 0
+
+class epicsShareClass EnsembleAxis : public asynMotorAxis
+{
+public:
+  /* These are the methods we override from the base class */
+  EnsembleAxis(class EnsembleController *pC, int axisNo, int ensembleAxis);
+  void report(FILE *fp, int level);
+  asynStatus move(double position, int relative, double min_velocity, double max_velocity, double acceleration);
+  asynStatus moveVelocity(double min_velocity, double max_velocity, double acceleration);
+  asynStatus home(double min_velocity, double max_velocity, double acceleration, int forwards);
+  asynStatus stop(double acceleration);
+  asynStatus poll(bool *moving);
+  asynStatus setPosition(double position);
+  asynStatus setClosedLoop(bool closedLoop);
+
+private:
+  asynStatus readStatus(bool planeMoving);
+
+  EnsembleController *pC_;      /**< Pointer to the asynMotorController to which this axis belongs.
+                                  *   Abbreviated because it is used very frequently */
+  int ensembleAxis_;            /**< Axis number on the Ensemble, used in "@n" commands */
+  double stepSize_;             /**< Ensemble units per motor record step (1/CountsPerUnit) */
+  int maxDigits_;               /**< Number of digits to send in position/velocity commands */
+  double homePreset_;           /**< Cached HomeOffset parameter */
+  int homeDirection_;           /**< Cached HomeSetup parameter */
+  Switch_Level swconfig_;       /**< Cached EndOfTravelLimitSetup parameter */
+  bool reverseDirec_;           /**< Cached ReverseMotionDirection parameter */
+  int lastFault_;               /**< Last AXISFAULT value that was reported */
+
+  /* Values read by EnsembleController::poll() and decoded by EnsembleAxis::poll() */
+  asynStatus pollStatus_;       /**< Communication status of the last controller poll */
+  Axis_Status axisStatus_;      /**< Last AXISSTATUS word */
+  int axisFault_;               /**< Last AXISFAULT word */
+  bool moveActive_;             /**< Axis or plane reported motion in the last poll */
+  double encoderPosition_;      /**< Last PFBKPROG value, in steps */
+  double commandPosition_;      /**< Last PCMDPROG value, in steps */
+  double actualVelocity_;       /**< Last VFBK value, in steps/s */
+  bool refreshCommand_;         /**< Read PCMDPROG and VFBK on the next poll even if idle */
+
+friend class EnsembleController;
+};
+
+class epicsShareClass EnsembleController : public asynMotorController {
+public:
+  EnsembleController(const char *portName, const char *EnsemblePortName, int numAxes, double movingPollPeriod, double idlePollPeriod);
+
+  /* These are the methods that we override from asynMotorDriver */
+  void report(FILE *fp, int level);
+  EnsembleAxis* getAxis(asynUser *pasynUser);
+  EnsembleAxis* getAxis(int axisNo);
+  asynStatus poll();
+
+  /* These are the functions for profile moves */
+  asynStatus buildProfile();
+  asynStatus executeProfile();
+  asynStatus abortProfile();
+  asynStatus readbackProfile();
+
+  /* These are the methods that are new to this class */
+  void profileThread();
+  asynStatus runProfile();
+
+private:
+  asynStatus sendAndReceive(const char *output, char *input, size_t maxChars);
+  asynStatus sendCommand(const char *output);
+  asynStatus queryInteger(const char *output, int *value);
+  asynStatus queryDouble(const char *output, double *value);
+  asynStatus startCommandProgram();
+  bool isProfileAborted();
+  asynStatus waitMotionDone();
+
+  int numEnsembleAxes_;         /**< Number of axes found on the Ensemble */
+  int numGlobalDoubles_;        /**< Number of DGLOBAL variables available for profiles */
+  int profileAxis_;             /**< The single axis used by the current profile, -1 if none */
+  int profileNumElements_;      /**< Number of PVT elements built for the current profile */
+  double *profilePVT_;          /**< Position, velocity and absolute time for each PVT element */
+  bool profileAborted_;         /**< Set by abortProfile() while a profile is running; access with the lock held */
+  epicsEventId profileExecuteEvent_;
+
+friend class EnsembleAxis;
+};
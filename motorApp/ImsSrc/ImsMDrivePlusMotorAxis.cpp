@@ -374,29 +374,38 @@ asynStatus ImsMDrivePlusMotorAxis::setPosition(double position)
 asynStatus ImsMDrivePlusMotorAxis::poll(bool *moving)
 {
 	asynStatus status = asynError;
-	char cmd[MAX_CMD_LEN];
 	char resp[MAX_BUFF_LEN];
 	size_t nread;
 	int val=0;
-	double position;
+	int i;
+	double position=0;
+	double values[IMS_MAX_POLL_ITEMS];
+	char *p, *end;
 	*moving = false;
 	static const char *functionName = "poll()";
 	//epicsTime currentTime;
 
-	// get position
-	sprintf(cmd, "PR P");
-	status = pController->writeReadController(cmd, resp, sizeof(resp), &nread, IMS_TIMEOUT);
+	// get position, moving flag and switch inputs with one query, see buildPollQuery()
+	status = pController->writeReadController(pController->pollQuery, resp, sizeof(resp), &nread, IMS_TIMEOUT);
 	if (status) goto bail;
-	position = atof(resp);
+	p = resp;
+	for (i=0; i<pController->pollNumItems; i++) {
+		values[i] = strtod(p, &end);
+		if (end == p) break;
+		p = end;
+	}
+	if (i < pController->pollNumItems) {
+		asynPrint(pController->pasynUserSelf, ASYN_TRACE_ERROR, "%s:%s: bad response to %s: %s\n", DRIVER_NAME, functionName, pController->pollQuery, resp);
+		status = asynError;
+		goto bail;
+	}
+
+	position = values[0];
 	// update motor record position values, just update encoder's even if not using one
 	setDoubleParam(pController->motorEncoderPosition_, position);
 	setDoubleParam(pController->motorPosition_, position);
 
-	// get moving flag
-	sprintf(cmd, "PR MV");
-	status = pController->writeReadController(cmd, resp, sizeof(resp), &nread, IMS_TIMEOUT);
-	if (status) goto bail;
-	val = atoi(resp);
+	val = (int)values[1];
 	if (val == 1) *moving = true;  	// updating moving flag
 /*	else { // not moving
 		if (prevMovingState == 1) {// state changed, moving before, start idle timer
@@ -426,31 +435,9 @@ asynStatus ImsMDrivePlusMotorAxis::poll(bool *moving)
 	}
 */
 
-	// get home switch value
-	if (pController->homeSwitchInput != -1) {
-		sprintf(cmd, "PR I%d", pController->homeSwitchInput);
-		status = pController->writeReadController(cmd, resp, sizeof(resp), &nread, IMS_TIMEOUT);
-		if (status) goto bail;
-		val = atoi(resp);
-		setIntegerParam(pController->motorStatusHome_, val);
-	}
-
-	// get positive limit switch value
-	if (pController->posLimitSwitchInput != -1) {
-		sprintf(cmd, "PR I%d", pController->posLimitSwitchInput);
-		status = pController->writeReadController(cmd, resp, sizeof(resp), &nread, IMS_TIMEOUT);
-		if (status) goto bail;
-		val = atoi(resp);
-		setIntegerParam(pController->motorStatusHighLimit_, val);
-	}
-
-	// get negative limit switch value
-	if (pController->negLimitSwitchInput != -1) {
-		sprintf(cmd, "PR I%d", pController->negLimitSwitchInput);
-		status = pController->writeReadController(cmd, resp, sizeof(resp), &nread, IMS_TIMEOUT);
-		if (status) goto bail;
-		val = atoi(resp);
-		setIntegerParam(pController->motorStatusLowLimit_, val);
+	// home, positive and negative limit switch values
+	for (i=2; i<pController->pollNumItems; i++) {
+		setIntegerParam(pController->pollItemParam[i], (int)values[i]);
 	}
 
 	// error polling
@@ -20,6 +20,13 @@
 #define MAX_NAME_LEN 10
 #define LOCAL_LINE_LEN 256
 
+// switch inputs read by the batched poll, see ImsMDrivePlusConfigPoll()
+#define IMS_POLL_HOME      0x1
+#define IMS_POLL_POS_LIMIT 0x2
+#define IMS_POLL_NEG_LIMIT 0x4
+#define IMS_POLL_ALL       (IMS_POLL_HOME | IMS_POLL_POS_LIMIT | IMS_POLL_NEG_LIMIT)
+#define IMS_MAX_POLL_ITEMS 5    // P, MV and 3 switch inputs
+
 class epicsShareClass ImsMDrivePlusMotorController;
 
 ////////////////////////////////////
@@ -96,6 +96,7 @@ ImsMDrivePlusMotorController::ImsMDrivePlusMotorController(const char *motorPort
 
 	// read home and limit config from S1-S4
 	readHomeAndLimitConfig();
+	buildPollQuery();
 
 	startPoller(movingPollPeriod, idlePollPeriod, 2);
 }
@@ -122,6 +123,9 @@ void ImsMDrivePlusMotorController::initController(const char *devName, double mo
 	this->homeSwitchInput=-1;
 	this->posLimitSwitchInput=-1;
 	this->negLimitSwitchInput=-1;
+	this->pollInputs = IMS_POLL_ALL;
+	this->pollNumItems = 0;
+	this->pollQuery[0] = '\0';
 
 	// flush io buffer
 	pasynOctetSyncIO->flush(pAsynUserIMS);
@@ -169,6 +173,57 @@ int ImsMDrivePlusMotorController::readHomeAndLimitConfig()
 	return status;
 }
 
+////////////////////////////////////////
+//! buildPollQuery()
+//! build the single PR command used by poll() to read position, moving flag and switch inputs
+//! Items are separated by " " strings so the response can be split, e.g. PR P," ",MV," ",I1," ",I3
+//! replies "1200 1 0 1".  One turnaround per poll instead of one per item, which matters
+//! on a party-mode RS-485 chain where every drive shares the same half-duplex line.
+//! Only inputs configured as home/limit switches (S1-S4) and enabled in pollInputs are read.
+////////////////////////////////////////
+void ImsMDrivePlusMotorController::buildPollQuery()
+{
+	int inputs[3] = {homeSwitchInput, posLimitSwitchInput, negLimitSwitchInput};
+	int masks[3] = {IMS_POLL_HOME, IMS_POLL_POS_LIMIT, IMS_POLL_NEG_LIMIT};
+	int params[3] = {motorStatusHome_, motorStatusHighLimit_, motorStatusLowLimit_};
+	size_t len;
+
+	strcpy(pollQuery, "PR P,\" \",MV");
+	pollNumItems = 2;
+	for (int i=0; i<3; i++) {
+		if (inputs[i] == -1 || !(pollInputs & masks[i])) continue;
+		len = strlen(pollQuery);
+		sprintf(pollQuery+len, ",\" \",I%d", inputs[i]);
+		pollItemParam[pollNumItems] = params[i];
+		pollNumItems++;
+	}
+	asynPrint(pasynUserSelf, ASYN_TRACEIO_DRIVER, "%s:buildPollQuery(): pollQuery=%s\n", DRIVER_NAME, pollQuery);
+}
+
+////////////////////////////////////////
+//! configPoll()
+//! select the switch inputs read by poll()
+//! inputs left out are reported as off
+//
+//! @param[in] inputs  IMS_POLL_* bits: 1=home, 2=positive limit, 4=negative limit
+////////////////////////////////////////
+asynStatus ImsMDrivePlusMotorController::configPoll(int inputs)
+{
+	ImsMDrivePlusMotorAxis *pAxis = getAxis(0);
+
+	lock();
+	pollInputs = inputs & IMS_POLL_ALL;
+	buildPollQuery();
+	if (pAxis) {
+		if (!(pollInputs & IMS_POLL_HOME)) pAxis->setIntegerParam(motorStatusHome_, 0);
+		if (!(pollInputs & IMS_POLL_POS_LIMIT)) pAxis->setIntegerParam(motorStatusHighLimit_, 0);
+		if (!(pollInputs & IMS_POLL_NEG_LIMIT)) pAxis->setIntegerParam(motorStatusLowLimit_, 0);
+		pAxis->callParamCallbacks();
+	}
+	unlock();
+	return asynSuccess;
+}
+
 ////////////////////////////////////////
 //! getAxis()
 //! Override asynMotorController function to return pointer to IMS axis object
@@ -301,6 +356,7 @@ asynStatus ImsMDrivePlusMotorController::writeReadController(const char *output,
 // Start code for iocsh Registration :
 // Available Functions :
 //   ImsMDrivePlusCreateController()
+//   ImsMDrivePlusConfigPoll()
 ////////////////////////////////////////////////////////
 
 ////////////////////////////////////////////////////////
@@ -351,9 +407,41 @@ static void ImsMDrivePlusCreateControllerCallFunc(const iocshArgBuf *args)
 	ImsMDrivePlusCreateController(args[0].sval, args[1].sval, args[2].sval, args[3].dval, args[4].dval);
 }
 
+////////////////////////////////////////////////////////
+//! ImsMDrivePlusConfigPoll()
+//! IOCSH function
+//! Selects the switch inputs read on every poll, to drop inputs that are wired but not used
+//
+//! @param[in] motorPortName     Name of motor port given to ImsMDrivePlusCreateController()
+//! @param[in] pollInputs        Bit mask: 1=home, 2=positive limit, 4=negative limit, default 7
+////////////////////////////////////////////////////////
+extern "C" int ImsMDrivePlusConfigPoll(const char *motorPortName, int pollInputs)
+{
+	ImsMDrivePlusMotorController *pImsController;
+	static const char *functionName = "ImsMDrivePlusConfigPoll()";
+
+	pImsController = (ImsMDrivePlusMotorController *)findAsynPortDriver(motorPortName);
+	if (!pImsController) {
+		printf("%s:%s: ERROR port %s not found\n", DRIVER_NAME, functionName, motorPortName);
+		return(asynError);
+	}
+	return(pImsController->configPoll(pollInputs));
+}
+
+static const iocshArg ImsMDrivePlusConfigPollArg0 = {"Motor port name", iocshArgString};
+static const iocshArg ImsMDrivePlusConfigPollArg1 = {"Poll inputs mask", iocshArgInt};
+static const iocshArg * const ImsMDrivePlusConfigPollArgs[] = {&ImsMDrivePlusConfigPollArg0,
+                                                               &ImsMDrivePlusConfigPollArg1};
+static const iocshFuncDef ImsMDrivePlusConfigPollDef = {"ImsMDrivePlusConfigPoll", 2, ImsMDrivePlusConfigPollArgs};
+static void ImsMDrivePlusConfigPollCallFunc(const iocshArgBuf *args)
+{
+	ImsMDrivePlusConfigPoll(args[0].sval, args[1].ival);
+}
+
 static void ImsMDrivePlusMotorRegister(void)
 {
 	iocshRegister(&ImsMDrivePlusCreateControllerDef, ImsMDrivePlusCreateControllerCallFunc);
+	iocshRegister(&ImsMDrivePlusConfigPollDef, ImsMDrivePlusConfigPollCallFunc);
 }
 
 extern "C" {
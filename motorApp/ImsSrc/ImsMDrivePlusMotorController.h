@@ -30,6 +30,7 @@ public:
 	/////////////////////////////////////////
 	asynStatus writeReadController(const char *output, char *input, size_t maxChars, size_t *nread, double timeout);
 	asynStatus writeController(const char *output, double timeout);
+	asynStatus configPoll(int pollInputs);
 
 	
 
@@ -61,8 +62,15 @@ private:
 	int posLimitSwitchInput;
 	int negLimitSwitchInput;
 
+	// batched poll query, e.g. PR P," ",MV," ",I1 ; built by buildPollQuery()
+	int pollInputs;                      // IMS_POLL_* bits of the switch inputs to poll
+	char pollQuery[MAX_CMD_LEN];         // single query for position, moving flag and switch inputs
+	int pollNumItems;                    // number of values in the response to pollQuery
+	int pollItemParam[IMS_MAX_POLL_ITEMS];  // parameter set from each switch input value, after P and MV
+
 	void initController(const char *devName, double movingPollPeriod, double idlePollPeriod);
 	int readHomeAndLimitConfig();  // read home, positive limit, and neg limit switch configuration from controller (S1-S4 settings)
+	void buildPollQuery();
 
 	friend class ImsMDrivePlusMotorAxis;
 };
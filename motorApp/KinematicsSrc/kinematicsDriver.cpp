@@ -0,0 +1,633 @@
+/*
+FILENAME...  kinematicsDriver.cpp
+USAGE...     Motor driver support for virtual axes computed from real axes of other controllers.
+
+A move of a virtual axis computes the real targets with the inverse transform,
+checks them against the soft limits of the real motor records, and moves each real
+axis through its controller's writeFloat64(), as its motor record would, with the
+velocities scaled so that all real axes arrive together.  On each poll the positions
+and status of all real axes are read once and the forward transform computes every
+virtual axis.
+
+Homing, jogging and redefining the position of a virtual axis are not supported.
+
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <iocsh.h>
+#include <epicsThread.h>
+
+#include <asynPortDriver.h>
+#include "asynMotorController.h"
+#include "asynMotorAxis.h"
+
+#include <epicsExport.h>
+#include "kinematicsDriver.h"
+
+/* Acceleration time used if a move does not give an acceleration */
+#define DEFAULT_ACCEL_TIME 0.2
+/* Smallest derivative of a real position by a virtual position for a real limit to affect
+   the virtual axis */
+#define MIN_DERIVATIVE 1e-9
+
+static const char *driverName = "kinematicsDriver";
+
+/** Creates a new kinematicsController object.
+  * \param[in] portName          The name of the asyn port that will be created for this driver
+  * \param[in] numVirtual        The number of virtual axes
+  * \param[in] movingPollPeriod  The time between polls when any axis is moving
+  * \param[in] idlePollPeriod    The time between polls when no axis is moving
+  */
+kinematicsController::kinematicsController(const char *portName, int numVirtual,
+                                           double movingPollPeriod, double idlePollPeriod)
+  :  asynMotorController(portName, numVirtual, 0,
+                         0, // No additional interfaces beyond those in base class
+                         0, // No additional callback interfaces beyond those in base class
+                         ASYN_CANBLOCK | ASYN_MULTIDEVICE,
+                         1, // autoconnect
+                         0, 0),  // Default priority and stack size
+     numVirtual_(numVirtual), numReal_(0), pTransform_(NULL), pollStatus_(1),
+     allDone_(true), anyProblem_(false),
+     targetsValid_(false), movesDeferred_(false)
+{
+  int axis;
+
+  for (axis=0; axis<KINEMATICS_MAX_AXES; axis++) {
+    realPositions_[axis] = 0.0;
+    virtualPositions_[axis] = 0.0;
+    targets_[axis] = 0.0;
+    velocities_[axis] = 0.0;
+    accelerations_[axis] = 0.0;
+    moved_[axis] = false;
+    highLimits_[axis] = false;
+    lowLimits_[axis] = false;
+  }
+  for (axis=0; axis<numVirtual; axis++) {
+    new kinematicsAxis(this, axis);
+  }
+
+  startPoller(movingPollPeriod, idlePollPeriod, 2);
+}
+
+/** Creates a new kinematicsController object.
+  * Configuration command, called directly or from iocsh
+  * \param[in] portName          The name of the asyn port that will be created for this driver
+  * \param[in] numVirtual        The number of virtual axes
+  * \param[in] movingPollPeriod  The time in ms between polls when any axis is moving
+  * \param[in] idlePollPeriod    The time in ms between polls when no axis is moving
+  */
+extern "C" int kinematicsCreateController(const char *portName, int numVirtual,
+                                          int movingPollPeriod, int idlePollPeriod)
+{
+  if ((numVirtual < 1) || (numVirtual > KINEMATICS_MAX_AXES)) {
+    printf("%s:kinematicsCreateController: ERROR, number of virtual axes must be 1 to %d\n",
+      driverName, KINEMATICS_MAX_AXES);
+    return(asynError);
+  }
+  new kinematicsController(portName, numVirtual, movingPollPeriod/1000., idlePollPeriod/1000.);
+  return(asynSuccess);
+}
+
+/** Reports on status of the driver
+  * \param[in] fp The file pointer on which report information will be written
+  * \param[in] level The level of report detail desired
+  */
+void kinematicsController::report(FILE *fp, int level)
+{
+  int i;
+
+  fprintf(fp, "Kinematics motor driver %s, numVirtual=%d, numReal=%d, movesDeferred=%d\n",
+    this->portName, numVirtual_, numReal_, movesDeferred_);
+  if (level > 0) {
+    for (i=0; i<numReal_; i++) {
+      fprintf(fp, "  real %d: %s axis %d, dial position=%f\n",
+        i, real_[i].pC->portName, real_[i].axisNo, realPositions_[i]);
+    }
+    for (i=0; i<numVirtual_; i++) {
+      fprintf(fp, "  virtual %d: dial position=%f, target=%f\n",
+        i, virtualPositions_[i], targets_[i]);
+    }
+    if (pTransform_) pTransform_->report(fp);
+    else fprintf(fp, "    no transform\n");
+  }
+
+  // Call the base class method
+  asynMotorController::report(fp, level);
+}
+
+/** Returns a pointer to an kinematicsAxis object.
+  * Returns NULL if the axis number encoded in pasynUser is invalid.
+  * \param[in] pasynUser asynUser structure that encodes the axis index number. */
+kinematicsAxis* kinematicsController::getAxis(asynUser *pasynUser)
+{
+  return static_cast<kinematicsAxis*>(asynMotorController::getAxis(pasynUser));
+}
+
+/** Returns a pointer to an kinematicsAxis object.
+  * Returns NULL if the axis number encoded in pasynUser is invalid.
+  * \param[in] axisNo Axis index number. */
+kinematicsAxis* kinematicsController::getAxis(int axisNo)
+{
+  return static_cast<kinematicsAxis*>(asynMotorController::getAxis(axisNo));
+}
+
+/** Adds the next real axis.  Real axes are numbered in the order they are added.
+  * \param[in] realPort The asyn port of the asynMotorController with the real axis.
+  * \param[in] realAxis The axis number on that controller.
+  */
+asynStatus kinematicsController::addRealAxis(const char *realPort, int realAxis)
+{
+  kinematicsRealAxis *pR;
+  asynMotorController *pReal;
+  static const char *functionName = "addRealAxis";
+
+  if (numReal_ >= KINEMATICS_MAX_AXES) {
+    printf("%s:%s: too many real axes\n", driverName, functionName);
+    return asynError;
+  }
+  if (pTransform_) {
+    printf("%s:%s: real axes must be added before the transform is set\n", driverName, functionName);
+    return asynError;
+  }
+  pReal = (asynMotorController *) findAsynPortDriver(realPort);
+  if (!pReal) {
+    printf("%s:%s: controller %s not found\n", driverName, functionName, realPort);
+    return asynError;
+  }
+  pR = &real_[numReal_];
+  pR->pC = pReal;
+  pR->axisNo = realAxis;
+  pR->pAxis = pReal->getAxis(realAxis);
+  if (!pR->pAxis) {
+    printf("%s:%s: controller %s has no axis %d\n", driverName, functionName, realPort, realAxis);
+    return asynError;
+  }
+  if (pReal->findParam(motorPositionString,       &pR->positionParam) ||
+      pReal->findParam(motorRecResolutionString,  &pR->resolutionParam) ||
+      pReal->findParam(motorMoveAbsString,        &pR->moveAbsParam) ||
+      pReal->findParam(motorVelBaseString,        &pR->velBaseParam) ||
+      pReal->findParam(motorVelocityString,       &pR->velocityParam) ||
+      pReal->findParam(motorAccelString,          &pR->accelParam) ||
+      pReal->findParam(motorStatusDoneString,     &pR->doneParam) ||
+      pReal->findParam(motorStatusProblemString,  &pR->problemParam) ||
+      pReal->findParam(motorStatusHighLimitString, &pR->highLimitParam) ||
+      pReal->findParam(motorStatusLowLimitString, &pR->lowLimitParam) ||
+      pReal->findParam(motorHighLimitString,      &pR->softHighLimitParam) ||
+      pReal->findParam(motorLowLimitString,       &pR->softLowLimitParam)) {
+    printf("%s:%s: %s is not a motor controller\n", driverName, functionName, realPort);
+    return asynError;
+  }
+  pR->pasynUser = pasynManager->createAsynUser(0, 0);
+  if (pasynManager->connectDevice(pR->pasynUser, realPort, realAxis)) {
+    printf("%s:%s: cannot connect to %s axis %d\n", driverName, functionName, realPort, realAxis);
+    pasynManager->freeAsynUser(pR->pasynUser);
+    return asynError;
+  }
+  lock();
+  numReal_++;
+  unlock();
+  return asynSuccess;
+}
+
+/** Sets the transform, after all real axes have been added.
+  * \param[in] name The name of a registered transform, e.g. "matrix" or "sumDiff".
+  * \param[in] args The arguments of the transform.
+  */
+asynStatus kinematicsController::setTransform(const char *name, const char *args)
+{
+  kinematicsTransform *pT;
+
+  pT = kinematicsCreateTransform(name, numReal_, numVirtual_, args);
+  if (!pT) return asynError;
+  lock();
+  if (pTransform_) delete pTransform_;
+  pTransform_ = pT;
+  targetsValid_ = false;
+  unlock();
+  wakeupPoller();
+  return asynSuccess;
+}
+
+/** Polls all real axes and computes all virtual axes.
+  * The position and status of each real axis are read from the parameter library of its
+  * controller, which its own poller keeps up to date, so this does no I/O.
+  */
+asynStatus kinematicsController::poll()
+{
+  kinematicsRealAxis *pR;
+  double position, resolution;
+  int done, problem;
+  int highLimits[KINEMATICS_MAX_AXES], lowLimits[KINEMATICS_MAX_AXES];
+  bool allDone = true;
+  int i;
+
+  if (!pTransform_) {
+    pollStatus_ = 1;
+    return asynError;
+  }
+
+  anyProblem_ = false;
+  for (i=0; i<numReal_; i++) {
+    pR = &real_[i];
+    position = 0.0;
+    resolution = 0.0;
+    done = 1;
+    problem = highLimits[i] = lowLimits[i] = 0;
+    pR->pC->lock();
+    pR->pC->getDoubleParam(pR->axisNo, pR->positionParam, &position);
+    pR->pC->getDoubleParam(pR->axisNo, pR->resolutionParam, &resolution);
+    pR->pC->getIntegerParam(pR->axisNo, pR->doneParam, &done);
+    pR->pC->getIntegerParam(pR->axisNo, pR->problemParam, &problem);
+    pR->pC->getIntegerParam(pR->axisNo, pR->highLimitParam, &highLimits[i]);
+    pR->pC->getIntegerParam(pR->axisNo, pR->lowLimitParam, &lowLimits[i]);
+    pR->pC->unlock();
+    if (resolution == 0.0) resolution = 1.0;
+    realPositions_[i] = position * resolution;
+    if (resolution < 0.0) {
+      /* The limit switches are in controller directions; convert them to dial directions */
+      int tmp = highLimits[i];
+      highLimits[i] = lowLimits[i];
+      lowLimits[i] = tmp;
+    }
+    if (!done) allDone = false;
+    if (problem) anyProblem_ = true;
+  }
+  pollStatus_ = pTransform_->forward(realPositions_, virtualPositions_);
+  if (!pollStatus_) mapLimits(highLimits, lowLimits);
+  allDone_ = allDone;
+  /* Once everything has stopped the next move starts from the readbacks */
+  if (allDone_ && !movesDeferred_) targetsValid_ = false;
+
+  return pollStatus_ ? asynError : asynSuccess;
+}
+
+/** Works out which virtual axes the limit switches of the real axes stop.
+  * A real axis on its high limit stops a virtual axis in the direction that moves the real
+  * axis up, which is given by the sign of the derivative of the real position by the virtual
+  * position, with the other virtual axes fixed.  The derivatives are found by stepping each
+  * virtual axis through the inverse transform.  Virtual axes that do not move the real axis
+  * are not stopped.
+  * \param[in] highLimits High limit switch of each real axis, in dial directions.
+  * \param[in] lowLimits Low limit switch of each real axis, in dial directions. */
+void kinematicsController::mapLimits(const int *highLimits, const int *lowLimits)
+{
+  double virt[KINEMATICS_MAX_AXES], real0[KINEMATICS_MAX_AXES], real1[KINEMATICS_MAX_AXES];
+  double step, derivative;
+  bool anyLimit = false;
+  int i, j;
+
+  for (i=0; i<numVirtual_; i++) highLimits_[i] = lowLimits_[i] = false;
+  for (j=0; j<numReal_; j++) {
+    if (highLimits[j] || lowLimits[j]) anyLimit = true;
+  }
+  if (!anyLimit) return;
+
+  memcpy(virt, virtualPositions_, sizeof(virt));
+  if (pTransform_->inverse(virt, real0)) {
+    /* No derivatives; stop every virtual axis in both directions rather than miss a limit */
+    for (i=0; i<numVirtual_; i++) highLimits_[i] = lowLimits_[i] = true;
+    return;
+  }
+  for (i=0; i<numVirtual_; i++) {
+    step = 1e-6 * (fabs(virt[i]) > 1.0 ? fabs(virt[i]) : 1.0);
+    virt[i] += step;
+    if (pTransform_->inverse(virt, real1)) {
+      highLimits_[i] = lowLimits_[i] = true;
+    } else {
+      for (j=0; j<numReal_; j++) {
+        derivative = (real1[j] - real0[j]) / step;
+        if (fabs(derivative) < MIN_DERIVATIVE) continue;
+        if ((highLimits[j] && (derivative > 0.0)) || (lowLimits[j] && (derivative < 0.0)))
+          highLimits_[i] = true;
+        if ((lowLimits[j] && (derivative > 0.0)) || (highLimits[j] && (derivative < 0.0)))
+          lowLimits_[i] = true;
+      }
+    }
+    virt[i] = virtualPositions_[i];
+  }
+}
+
+/** Starts or ends deferred moves.  When deferred moves end, the moves of all virtual axes
+  * are sent together.
+  * \param[in] defer True to defer moves, false to send the deferred moves. */
+asynStatus kinematicsController::setDeferredMoves(bool defer)
+{
+  if (defer) {
+    movesDeferred_ = true;
+    return asynSuccess;
+  }
+  movesDeferred_ = false;
+  return processMoves();
+}
+
+/** Sets the target of a virtual axis, and sends the moves unless moves are deferred.
+  * \param[in] axis The virtual axis.
+  * \param[in] position The target, in dial units.
+  * \param[in] relative If non-zero position is relative to the current target.
+  * \param[in] velocity The velocity of the virtual axis, in dial units/s.
+  * \param[in] acceleration The acceleration of the virtual axis, in dial units/s/s.
+  */
+asynStatus kinematicsController::moveVirtual(int axis, double position, int relative,
+                                             double velocity, double acceleration)
+{
+  static const char *functionName = "moveVirtual";
+
+  if (!pTransform_ || pollStatus_) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: %s cannot move, no transform or no valid readback\n",
+      driverName, functionName, portName);
+    return asynError;
+  }
+  if (!targetsValid_) {
+    memcpy(targets_, virtualPositions_, sizeof(targets_));
+    targetsValid_ = true;
+  }
+  targets_[axis] = relative ? targets_[axis] + position : position;
+  velocities_[axis] = fabs(velocity);
+  accelerations_[axis] = fabs(acceleration);
+  moved_[axis] = true;
+
+  if (movesDeferred_) return asynSuccess;
+  return processMoves();
+}
+
+/** Sends the moves of the virtual axes to the real axes.
+  * The real targets are computed from all virtual targets in one pass, and nothing is moved
+  * if any of them is outside the soft limits of its motor record.  Each real axis is moved
+  * with writeFloat64() of its controller, the path of a move of its motor record, so that
+  * automatic power on, deferred moves and the done flag of the real controller apply.  All
+  * real axes get the same move time and acceleration time, those of the slowest virtual move,
+  * so that they arrive together.
+  */
+asynStatus kinematicsController::processMoves()
+{
+  kinematicsRealAxis *pR;
+  double realTargets[KINEMATICS_MAX_AXES], resolutions[KINEMATICS_MAX_AXES];
+  double moveTime = 0.0, accelTime = 0.0;
+  double distance, velocity, highLimit, lowLimit, tmp;
+  asynStatus status = asynSuccess;
+  bool anyMoved = false;
+  int i;
+  static const char *functionName = "processMoves";
+
+  for (i=0; i<numVirtual_; i++) {
+    if (!moved_[i]) continue;
+    anyMoved = true;
+    moved_[i] = false;
+    distance = fabs(targets_[i] - virtualPositions_[i]);
+    if (velocities_[i] > 0.0) {
+      if (distance / velocities_[i] > moveTime) moveTime = distance / velocities_[i];
+      if ((accelerations_[i] > 0.0) && (velocities_[i] / accelerations_[i] > accelTime))
+        accelTime = velocities_[i] / accelerations_[i];
+    }
+  }
+  if (!anyMoved) return asynSuccess;
+  if (moveTime <= 0.0) moveTime = 1.0;
+  if (accelTime <= 0.0) accelTime = DEFAULT_ACCEL_TIME;
+
+  if (pTransform_->inverse(targets_, realTargets)) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: %s no real positions for the requested virtual positions\n",
+      driverName, functionName, portName);
+    targetsValid_ = false;
+    return asynError;
+  }
+
+  /* The soft limits are the DHLM and DLLM of the real motor records, which send them to
+   * their controllers in controller units; equal limits mean there are none */
+  for (i=0; i<numReal_; i++) {
+    pR = &real_[i];
+    resolutions[i] = highLimit = lowLimit = 0.0;
+    pR->pC->lock();
+    pR->pC->getDoubleParam(pR->axisNo, pR->resolutionParam, &resolutions[i]);
+    pR->pC->getDoubleParam(pR->axisNo, pR->softHighLimitParam, &highLimit);
+    pR->pC->getDoubleParam(pR->axisNo, pR->softLowLimitParam, &lowLimit);
+    pR->pC->unlock();
+    if (resolutions[i] == 0.0) resolutions[i] = 1.0;
+    if (highLimit == lowLimit) continue;
+    highLimit *= resolutions[i];
+    lowLimit *= resolutions[i];
+    if (highLimit < lowLimit) {
+      tmp = highLimit;
+      highLimit = lowLimit;
+      lowLimit = tmp;
+    }
+    if ((realTargets[i] > highLimit) || (realTargets[i] < lowLimit)) {
+      asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+        "%s:%s: %s real %d (%s axis %d) target %f is outside its limits %f to %f\n",
+        driverName, functionName, portName, i, pR->pC->portName, pR->axisNo,
+        realTargets[i], lowLimit, highLimit);
+      targetsValid_ = false;
+      return asynError;
+    }
+  }
+
+  for (i=0; i<numReal_; i++) {
+    pR = &real_[i];
+    distance = fabs(realTargets[i] - realPositions_[i]);
+    if (distance < 0.5 * fabs(resolutions[i])) continue;
+    velocity = distance / moveTime / fabs(resolutions[i]);
+    asynPrint(pasynUserSelf, ASYN_TRACE_FLOW,
+      "%s:%s: %s real %d (%s axis %d) to %f, velocity=%f\n",
+      driverName, functionName, portName, i, pR->pC->portName, pR->axisNo,
+      realTargets[i], velocity);
+    pR->pC->lock();
+    pR->pC->setDoubleParam(pR->axisNo, pR->velBaseParam, 0.0);
+    pR->pC->setDoubleParam(pR->axisNo, pR->velocityParam, velocity);
+    pR->pC->setDoubleParam(pR->axisNo, pR->accelParam, velocity / accelTime);
+    pR->pasynUser->reason = pR->moveAbsParam;
+    if (pR->pC->writeFloat64(pR->pasynUser, realTargets[i] / resolutions[i])) status = asynError;
+    pR->pC->unlock();
+  }
+  return status;
+}
+
+/** Stops all real axes, each with the acceleration of its last move. */
+asynStatus kinematicsController::stopReal()
+{
+  double acceleration;
+  asynStatus status = asynSuccess;
+  int i;
+
+  for (i=0; i<numVirtual_; i++) moved_[i] = false;
+  for (i=0; i<numReal_; i++) {
+    acceleration = 0.0;
+    real_[i].pC->lock();
+    real_[i].pC->getDoubleParam(real_[i].axisNo, real_[i].accelParam, &acceleration);
+    if (real_[i].pAxis->stop(acceleration)) status = asynError;
+    real_[i].pC->unlock();
+    real_[i].pC->wakeupPoller();
+  }
+  targetsValid_ = false;
+  return status;
+}
+
+
+// These are the kinematicsAxis methods
+
+/** Creates a new kinematicsAxis object.
+  * \param[in] pC Pointer to the kinematicsController to which this axis belongs.
+  * \param[in] axisNo Index number of this axis, range 0 to pC->numAxes_-1.
+  */
+kinematicsAxis::kinematicsAxis(kinematicsController *pC, int axisNo)
+  : asynMotorAxis(pC, axisNo),
+    pC_(pC)
+{
+}
+
+/** Returns the dial units per controller unit of this axis, from MOTOR_REC_RESOLUTION */
+double kinematicsAxis::dialResolution()
+{
+  double resolution = 0.0;
+
+  pC_->getDoubleParam(axisNo_, pC_->motorRecResolution_, &resolution);
+  return (resolution == 0.0) ? 1.0 : resolution;
+}
+
+asynStatus kinematicsAxis::move(double position, int relative, double minVelocity, double maxVelocity, double acceleration)
+{
+  double resolution = dialResolution();
+
+  return pC_->moveVirtual(axisNo_, position * resolution, relative,
+                          maxVelocity * resolution, acceleration * resolution);
+}
+
+asynStatus kinematicsAxis::moveVelocity(double minVelocity, double maxVelocity, double acceleration)
+{
+  asynPrint(pasynUser_, ASYN_TRACE_ERROR,
+    "%s:moveVelocity: %s axis %d, jogging a virtual axis is not supported\n",
+    driverName, pC_->portName, axisNo_);
+  return asynError;
+}
+
+asynStatus kinematicsAxis::home(double minVelocity, double maxVelocity, double acceleration, int forwards)
+{
+  asynPrint(pasynUser_, ASYN_TRACE_ERROR,
+    "%s:home: %s axis %d, home the real axes instead\n",
+    driverName, pC_->portName, axisNo_);
+  return asynError;
+}
+
+/** Stops the virtual axis, which stops all real axes. */
+asynStatus kinematicsAxis::stop(double acceleration)
+{
+  return pC_->stopReal();
+}
+
+asynStatus kinematicsAxis::setPosition(double position)
+{
+  asynPrint(pasynUser_, ASYN_TRACE_ERROR,
+    "%s:setPosition: %s axis %d, set the real axes instead\n",
+    driverName, pC_->portName, axisNo_);
+  return asynError;
+}
+
+/** Polls the axis.
+  * This function sets the position and status computed by kinematicsController::poll().
+  * \param[out] moving A flag that is set indicating that the axis is moving (true) or done (false). */
+asynStatus kinematicsAxis::poll(bool *moving)
+{
+  double position, resolution;
+  bool highLimit, lowLimit;
+
+  if (pC_->pollStatus_) {
+    *moving = false;
+    setIntegerParam(pC_->motorStatusProblem_, 1);
+    callParamCallbacks();
+    return asynError;
+  }
+
+  resolution = dialResolution();
+  position = pC_->virtualPositions_[axisNo_] / resolution;
+  setDoubleParam(pC_->motorPosition_, position);
+  setDoubleParam(pC_->motorEncoderPosition_, position);
+
+  *moving = !pC_->allDone_;
+  setIntegerParam(pC_->motorStatusDone_, pC_->allDone_ ? 1 : 0);
+  setIntegerParam(pC_->motorStatusMoving_, pC_->allDone_ ? 0 : 1);
+  setIntegerParam(pC_->motorStatusProblem_, pC_->anyProblem_ ? 1 : 0);
+  /* The real limits that stop this axis, see mapLimits(), in controller directions */
+  highLimit = (resolution < 0.0) ? pC_->lowLimits_[axisNo_] : pC_->highLimits_[axisNo_];
+  lowLimit  = (resolution < 0.0) ? pC_->highLimits_[axisNo_] : pC_->lowLimits_[axisNo_];
+  setIntegerParam(pC_->motorStatusHighLimit_, highLimit ? 1 : 0);
+  setIntegerParam(pC_->motorStatusLowLimit_, lowLimit ? 1 : 0);
+  callParamCallbacks();
+  return asynSuccess;
+}
+
+
+extern "C" int kinematicsAddRealAxis(const char *portName, const char *realPort, int realAxis)
+{
+  kinematicsController *pC = (kinematicsController*) findAsynPortDriver(portName);
+
+  if (!pC) {
+    printf("%s:kinematicsAddRealAxis: ERROR, controller %s not found\n", driverName, portName);
+    return(-1);
+  }
+  return pC->addRealAxis(realPort, realAxis) ? -1 : 0;
+}
+
+extern "C" int kinematicsSetTransform(const char *portName, const char *name, const char *args)
+{
+  kinematicsController *pC = (kinematicsController*) findAsynPortDriver(portName);
+
+  if (!pC) {
+    printf("%s:kinematicsSetTransform: ERROR, controller %s not found\n", driverName, portName);
+    return(-1);
+  }
+  return pC->setTransform(name, args) ? -1 : 0;
+}
+
+/** Code for iocsh registration */
+static const iocshArg kinematicsCreateControllerArg0 = {"Port name", iocshArgString};
+static const iocshArg kinematicsCreateControllerArg1 = {"Number of virtual axes", iocshArgInt};
+static const iocshArg kinematicsCreateControllerArg2 = {"Moving poll period (ms)", iocshArgInt};
+static const iocshArg kinematicsCreateControllerArg3 = {"Idle poll period (ms)", iocshArgInt};
+static const iocshArg * const kinematicsCreateControllerArgs[] = {&kinematicsCreateControllerArg0,
+                                                                  &kinematicsCreateControllerArg1,
+                                                                  &kinematicsCreateControllerArg2,
+                                                                  &kinematicsCreateControllerArg3};
+static const iocshFuncDef kinematicsCreateControllerDef = {"kinematicsCreateController", 4, kinematicsCreateControllerArgs};
+static void kinematicsCreateControllerCallFunc(const iocshArgBuf *args)
+{
+  kinematicsCreateController(args[0].sval, args[1].ival, args[2].ival, args[3].ival);
+}
+
+static const iocshArg kinematicsAddRealAxisArg0 = {"Port name", iocshArgString};
+static const iocshArg kinematicsAddRealAxisArg1 = {"Real controller port name", iocshArgString};
+static const iocshArg kinematicsAddRealAxisArg2 = {"Real axis", iocshArgInt};
+static const iocshArg * const kinematicsAddRealAxisArgs[] = {&kinematicsAddRealAxisArg0,
+                                                             &kinematicsAddRealAxisArg1,
+                                                             &kinematicsAddRealAxisArg2};
+static const iocshFuncDef kinematicsAddRealAxisDef = {"kinematicsAddRealAxis", 3, kinematicsAddRealAxisArgs};
+static void kinematicsAddRealAxisCallFunc(const iocshArgBuf *args)
+{
+  kinematicsAddRealAxis(args[0].sval, args[1].sval, args[2].ival);
+}
+
+static const iocshArg kinematicsSetTransformArg0 = {"Port name", iocshArgString};
+static const iocshArg kinematicsSetTransformArg1 = {"Transform name", iocshArgString};
+static const iocshArg kinematicsSetTransformArg2 = {"Transform arguments", iocshArgString};
+static const iocshArg * const kinematicsSetTransformArgs[] = {&kinematicsSetTransformArg0,
+                                                              &kinematicsSetTransformArg1,
+                                                              &kinematicsSetTransformArg2};
+static const iocshFuncDef kinematicsSetTransformDef = {"kinematicsSetTransform", 3, kinematicsSetTransformArgs};
+static void kinematicsSetTransformCallFunc(const iocshArgBuf *args)
+{
+  kinematicsSetTransform(args[0].sval, args[1].sval, args[2].sval);
+}
+
+static void kinematicsRegister(void)
+{
+  iocshRegister(&kinematicsCreateControllerDef, kinematicsCreateControllerCallFunc);
+  iocshRegister(&kinematicsAddRealAxisDef, kinematicsAddRealAxisCallFunc);
+  iocshRegister(&kinematicsSetTransformDef, kinematicsSetTransformCallFunc);
+}
+
+extern "C" {
+epicsExportRegistrar(kinematicsRegister);
+}
@@ -0,0 +1,102 @@
+/*
+FILENAME...  kinematicsDriver.h
+USAGE...     Motor driver support for virtual axes computed from real axes of other controllers.
+
+The kinematics controller replaces the transform/calcout/dfanout record chains
+of pseudoMotor.db, sumDiff2D.db and coordTrans2D.db.  Each virtual axis has its
+own motor record.  The real axes are axes of other asynMotorController drivers
+in this IOC.  Positions are converted between controller units and dial units
+with the MOTOR_REC_RESOLUTION of each axis, and the transform works on dial
+positions.
+
+*/
+
+#include "asynMotorController.h"
+#include "asynMotorAxis.h"
+#include "kinematicsTransform.h"
+
+/** A real axis, as seen by the kinematics controller */
+typedef struct kinematicsRealAxis {
+  asynMotorController *pC;    /**< Controller of the real axis */
+  asynMotorAxis *pAxis;       /**< The real axis */
+  int axisNo;                 /**< Axis number on its controller */
+  asynUser *pasynUser;        /**< Connected to the axis, for writes to the real controller */
+  /* Parameter indices on the real controller */
+  int positionParam;
+  int resolutionParam;
+  int moveAbsParam;
+  int velBaseParam;
+  int velocityParam;
+  int accelParam;
+  int doneParam;
+  int problemParam;
+  int highLimitParam;
+  int lowLimitParam;
+  int softHighLimitParam;     /**< Dial high limit of the motor record, in controller units */
+  int softLowLimitParam;      /**< Dial low limit of the motor record, in controller units */
+} kinematicsRealAxis;
+
+class epicsShareClass kinematicsAxis : public asynMotorAxis
+{
+public:
+  /* These are the methods we override from the base class */
+  kinematicsAxis(class kinematicsController *pC, int axis);
+  asynStatus move(double position, int relative, double min_velocity, double max_velocity, double acceleration);
+  asynStatus moveVelocity(double min_velocity, double max_velocity, double acceleration);
+  asynStatus home(double min_velocity, double max_velocity, double acceleration, int forwards);
+  asynStatus stop(double acceleration);
+  asynStatus poll(bool *moving);
+  asynStatus setPosition(double position);
+
+private:
+  double dialResolution();
+
+  kinematicsController *pC_;  /**< Pointer to the kinematics controller */
+
+friend class kinematicsController;
+};
+
+class epicsShareClass kinematicsController : public asynMotorController {
+public:
+  kinematicsController(const char *portName, int numVirtual, double movingPollPeriod, double idlePollPeriod);
+
+  void report(FILE *fp, int level);
+  kinematicsAxis* getAxis(asynUser *pasynUser);
+  kinematicsAxis* getAxis(int axisNo);
+  asynStatus poll();
+  asynStatus setDeferredMoves(bool defer);
+
+  /* These are the functions that are new to this class */
+  asynStatus addRealAxis(const char *realPort, int realAxis);
+  asynStatus setTransform(const char *name, const char *args);
+
+private:
+  asynStatus moveVirtual(int axis, double position, int relative, double velocity, double acceleration);
+  asynStatus processMoves();
+  asynStatus stopReal();
+  void mapLimits(const int *highLimits, const int *lowLimits);
+
+  int numVirtual_;
+  int numReal_;
+  kinematicsRealAxis real_[KINEMATICS_MAX_AXES];
+  kinematicsTransform *pTransform_;
+
+  /* Results of the last poll, in dial units */
+  double realPositions_[KINEMATICS_MAX_AXES];
+  double virtualPositions_[KINEMATICS_MAX_AXES];
+  int pollStatus_;       /**< Non-zero if the last poll could not compute the virtual positions */
+  bool allDone_;         /**< All real axes are done */
+  bool anyProblem_;      /**< A real axis has the problem bit set */
+  bool highLimits_[KINEMATICS_MAX_AXES];      /**< A real limit stops the virtual axis moving up */
+  bool lowLimits_[KINEMATICS_MAX_AXES];       /**< A real limit stops the virtual axis moving down */
+
+  /* Virtual targets, in dial units.  A move of one virtual axis keeps the others at their targets */
+  double targets_[KINEMATICS_MAX_AXES];
+  double velocities_[KINEMATICS_MAX_AXES];    /**< Velocity of each virtual move, dial units/s */
+  double accelerations_[KINEMATICS_MAX_AXES]; /**< Acceleration of each virtual move, dial units/s/s */
+  bool moved_[KINEMATICS_MAX_AXES];           /**< Virtual axis has a move not yet sent */
+  bool targetsValid_;    /**< targets_ hold the last commanded positions; false once all axes stop */
+  bool movesDeferred_;
+
+friend class kinematicsAxis;
+};
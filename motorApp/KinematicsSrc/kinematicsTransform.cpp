@@ -0,0 +1,295 @@
+/*
+FILENAME...  kinematicsTransform.cpp
+USAGE...     Transforms between the real and virtual axes of a kinematics controller.
+
+Built-in transforms:
+  matrix   args "m00 m01 ... m(n-1)(n-1)", row major, virt = M * real, n real and n virtual axes.
+  sumDiff  args "c1 c2 e", the geometry of sumDiff2D.db, 2 real and 2 virtual axes:
+           sum = (real0*c1 + real1*c2)/(c1+c2), diff = (real0-real1)*e.
+
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <epicsString.h>
+
+#include "kinematicsTransform.h"
+
+#define MAX_TRANSFORMS 32
+
+static const char *driverName = "kinematicsTransform";
+
+typedef struct {
+  char *name;
+  kinematicsTransformFactory factory;
+} transformEntry;
+
+static transformEntry transforms[MAX_TRANSFORMS];
+static int numTransforms = 0;
+
+kinematicsTransform::kinematicsTransform(int numReal, int numVirtual)
+  : numReal_(numReal), numVirtual_(numVirtual)
+{
+}
+
+kinematicsTransform::~kinematicsTransform()
+{
+}
+
+void kinematicsTransform::report(FILE *fp)
+{
+  fprintf(fp, "    transform with %d real and %d virtual axes\n", numReal_, numVirtual_);
+}
+
+/** Creates a linear transform.
+  * \param[in] numAxes Number of real and of virtual axes.
+  * \param[in] matrix numAxes*numAxes elements, row major; virt[i] = sum over j of matrix[i*numAxes+j]*real[j].
+  */
+matrixTransform::matrixTransform(int numAxes, const double *matrix)
+  : kinematicsTransform(numAxes, numAxes), singular_(false)
+{
+  int n = numAxes;
+  int i, j, k, pivot;
+  double *work;
+  double tmp, scale;
+
+  matrix_  = (double *)calloc(n*n, sizeof(double));
+  inverse_ = (double *)calloc(n*n, sizeof(double));
+  work     = (double *)calloc(n*n, sizeof(double));
+  memcpy(matrix_, matrix, n*n*sizeof(double));
+  memcpy(work, matrix, n*n*sizeof(double));
+  for (i=0; i<n; i++) inverse_[i*n+i] = 1.0;
+
+  /* Gauss-Jordan elimination with partial pivoting */
+  for (k=0; k<n; k++) {
+    pivot = k;
+    for (i=k+1; i<n; i++) {
+      if (fabs(work[i*n+k]) > fabs(work[pivot*n+k])) pivot = i;
+    }
+    if (fabs(work[pivot*n+k]) < 1e-12) {
+      singular_ = true;
+      break;
+    }
+    if (pivot != k) {
+      for (j=0; j<n; j++) {
+        tmp = work[k*n+j];     work[k*n+j] = work[pivot*n+j];         work[pivot*n+j] = tmp;
+        tmp = inverse_[k*n+j]; inverse_[k*n+j] = inverse_[pivot*n+j]; inverse_[pivot*n+j] = tmp;
+      }
+    }
+    scale = 1.0 / work[k*n+k];
+    for (j=0; j<n; j++) {
+      work[k*n+j] *= scale;
+      inverse_[k*n+j] *= scale;
+    }
+    for (i=0; i<n; i++) {
+      if (i == k) continue;
+      scale = work[i*n+k];
+      if (scale == 0.0) continue;
+      for (j=0; j<n; j++) {
+        work[i*n+j] -= scale * work[k*n+j];
+        inverse_[i*n+j] -= scale * inverse_[k*n+j];
+      }
+    }
+  }
+  free(work);
+}
+
+matrixTransform::~matrixTransform()
+{
+  free(matrix_);
+  free(inverse_);
+}
+
+int matrixTransform::forward(const double *real, double *virt)
+{
+  int n = numReal_;
+  int i, j;
+
+  for (i=0; i<n; i++) {
+    virt[i] = 0.0;
+    for (j=0; j<n; j++) virt[i] += matrix_[i*n+j] * real[j];
+  }
+  return 0;
+}
+
+int matrixTransform::inverse(const double *virt, double *real)
+{
+  int n = numReal_;
+  int i, j;
+
+  if (singular_) return -1;
+  for (i=0; i<n; i++) {
+    real[i] = 0.0;
+    for (j=0; j<n; j++) real[i] += inverse_[i*n+j] * virt[j];
+  }
+  return 0;
+}
+
+void matrixTransform::report(FILE *fp)
+{
+  int n = numReal_;
+  int i, j;
+
+  fprintf(fp, "    matrix transform, %d axes%s\n", n, singular_ ? ", SINGULAR" : "");
+  for (i=0; i<n; i++) {
+    fprintf(fp, "     ");
+    for (j=0; j<n; j++) fprintf(fp, " %g", matrix_[i*n+j]);
+    fprintf(fp, "\n");
+  }
+}
+
+functionTransform::functionTransform(int numReal, int numVirtual, kinematicsFunction forwardFunc,
+                                     kinematicsFunction inverseFunc, void *userPvt)
+  : kinematicsTransform(numReal, numVirtual),
+    forwardFunc_(forwardFunc), inverseFunc_(inverseFunc), userPvt_(userPvt)
+{
+}
+
+int functionTransform::forward(const double *real, double *virt)
+{
+  return forwardFunc_(real, virt, userPvt_);
+}
+
+int functionTransform::inverse(const double *virt, double *real)
+{
+  return inverseFunc_(virt, real, userPvt_);
+}
+
+/** Parses up to maxValues numbers separated by spaces or commas.
+  * \return The number of values parsed, or -1 if the string has something that is not a number. */
+int kinematicsParseArgs(const char *args, double *values, int maxValues)
+{
+  const char *p = args;
+  char *end;
+  int num = 0;
+
+  if (!args) return 0;
+  while (*p) {
+    if ((*p == ' ') || (*p == ',') || (*p == '\t')) {
+      p++;
+      continue;
+    }
+    if (num >= maxValues) return -1;
+    values[num] = strtod(p, &end);
+    if (end == p) return -1;
+    num++;
+    p = end;
+  }
+  return num;
+}
+
+static kinematicsTransform* createMatrix(int numReal, int numVirtual, const char *args)
+{
+  double matrix[KINEMATICS_MAX_AXES*KINEMATICS_MAX_AXES];
+  matrixTransform *pT;
+  int num;
+  static const char *functionName = "createMatrix";
+
+  if (numReal != numVirtual) {
+    printf("%s:%s: matrix needs as many virtual axes (%d) as real axes (%d)\n",
+      driverName, functionName, numVirtual, numReal);
+    return NULL;
+  }
+  num = kinematicsParseArgs(args, matrix, KINEMATICS_MAX_AXES*KINEMATICS_MAX_AXES);
+  if (num != numReal*numReal) {
+    printf("%s:%s: matrix needs %d elements, got %d\n",
+      driverName, functionName, numReal*numReal, num);
+    return NULL;
+  }
+  pT = new matrixTransform(numReal, matrix);
+  if (pT->singular()) {
+    printf("%s:%s: matrix is singular\n", driverName, functionName);
+    delete pT;
+    return NULL;
+  }
+  return pT;
+}
+
+static kinematicsTransform* createSumDiff(int numReal, int numVirtual, const char *args)
+{
+  double values[3];
+  double matrix[4];
+  static const char *functionName = "createSumDiff";
+
+  if ((numReal != 2) || (numVirtual != 2)) {
+    printf("%s:%s: sumDiff needs 2 real and 2 virtual axes\n", driverName, functionName);
+    return NULL;
+  }
+  if ((kinematicsParseArgs(args, values, 3) != 3) || (values[0] + values[1] == 0.0)) {
+    printf("%s:%s: sumDiff needs \"c1 c2 e\" with c1+c2 non-zero\n", driverName, functionName);
+    return NULL;
+  }
+  if (values[2] == 0.0) {
+    printf("%s:%s: sumDiff needs a non-zero e\n", driverName, functionName);
+    return NULL;
+  }
+  matrix[0] = values[0] / (values[0] + values[1]);
+  matrix[1] = values[1] / (values[0] + values[1]);
+  matrix[2] = values[2];
+  matrix[3] = -values[2];
+  return new matrixTransform(2, matrix);
+}
+
+static int addTransform(const char *name, kinematicsTransformFactory factory)
+{
+  int i;
+  static const char *functionName = "addTransform";
+
+  for (i=0; i<numTransforms; i++) {
+    if (strcmp(transforms[i].name, name) == 0) {
+      transforms[i].factory = factory;
+      return 0;
+    }
+  }
+  if (numTransforms >= MAX_TRANSFORMS) {
+    printf("%s:%s: too many transforms, cannot add %s\n", driverName, functionName, name);
+    return -1;
+  }
+  transforms[numTransforms].name = epicsStrDup(name);
+  transforms[numTransforms].factory = factory;
+  numTransforms++;
+  return 0;
+}
+
+static void addBuiltinTransforms()
+{
+  static bool done = false;
+
+  if (done) return;
+  done = true;
+  addTransform("matrix", createMatrix);
+  addTransform("sumDiff", createSumDiff);
+}
+
+/** Adds a transform to the registry.  Registering a name again replaces the factory.
+  * \param[in] name The name given to kinematicsSetTransform.
+  * \param[in] factory The function that creates the transform.
+  */
+int kinematicsRegisterTransform(const char *name, kinematicsTransformFactory factory)
+{
+  addBuiltinTransforms();
+  return addTransform(name, factory);
+}
+
+/** Creates a transform by name.
+  * \param[in] name The registered name of the transform.
+  * \param[in] numReal Number of real axes.
+  * \param[in] numVirtual Number of virtual axes.
+  * \param[in] args Argument string passed to the factory.
+  */
+kinematicsTransform* kinematicsCreateTransform(const char *name, int numReal, int numVirtual, const char *args)
+{
+  int i;
+  static const char *functionName = "kinematicsCreateTransform";
+
+  addBuiltinTransforms();
+  for (i=0; i<numTransforms; i++) {
+    if (strcmp(transforms[i].name, name) == 0)
+      return transforms[i].factory(numReal, numVirtual, args);
+  }
+  printf("%s:%s: unknown transform %s\n", driverName, functionName, name);
+  return NULL;
+}
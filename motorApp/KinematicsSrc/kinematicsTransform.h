@@ -0,0 +1,84 @@
+/*
+FILENAME...  kinematicsTransform.h
+USAGE...     Transforms between the real and virtual axes of a kinematics controller.
+
+A transform maps the dial positions of the real axes to the dial positions of the
+virtual axes (forward) and back (inverse).  Transforms are created by name from
+a registry, so that a site can add its own C++ transform with
+kinematicsRegisterTransform() from a registrar function.
+
+*/
+
+#ifndef kinematicsTransform_H
+#define kinematicsTransform_H
+
+#include <stdio.h>
+#include <shareLib.h>
+
+#define KINEMATICS_MAX_AXES 16
+
+class epicsShareClass kinematicsTransform {
+public:
+  kinematicsTransform(int numReal, int numVirtual);
+  virtual ~kinematicsTransform();
+
+  /** Computes the virtual positions from the real positions.
+    * \param[in] real Array of numReal_ real positions.
+    * \param[out] virt Array of numVirtual_ virtual positions.
+    * \return 0 on success, non-zero if there is no solution. */
+  virtual int forward(const double *real, double *virt) = 0;
+
+  /** Computes the real positions that put the virtual axes at the requested positions.
+    * \param[in] virt Array of numVirtual_ virtual positions.
+    * \param[out] real Array of numReal_ real positions.
+    * \return 0 on success, non-zero if there is no solution. */
+  virtual int inverse(const double *virt, double *real) = 0;
+
+  virtual void report(FILE *fp);
+
+  int numReal_;     /**< Number of real axes */
+  int numVirtual_;  /**< Number of virtual axes */
+};
+
+/** Linear transform, virt = M * real, with the inverse computed once when it is created. */
+class epicsShareClass matrixTransform : public kinematicsTransform {
+public:
+  matrixTransform(int numAxes, const double *matrix);
+  ~matrixTransform();
+  int forward(const double *real, double *virt);
+  int inverse(const double *virt, double *real);
+  void report(FILE *fp);
+  bool singular() { return singular_; }
+
+private:
+  double *matrix_;    /**< numAxes*numAxes elements, row major */
+  double *inverse_;   /**< Inverse of matrix_ */
+  bool singular_;
+};
+
+/** Transform from a pair of plain functions, for code that does not want to derive a class. */
+typedef int (*kinematicsFunction)(const double *in, double *out, void *userPvt);
+
+class epicsShareClass functionTransform : public kinematicsTransform {
+public:
+  functionTransform(int numReal, int numVirtual, kinematicsFunction forwardFunc,
+                    kinematicsFunction inverseFunc, void *userPvt);
+  int forward(const double *real, double *virt);
+  int inverse(const double *virt, double *real);
+
+private:
+  kinematicsFunction forwardFunc_;
+  kinematicsFunction inverseFunc_;
+  void *userPvt_;
+};
+
+/** Creates a transform for numReal real and numVirtual virtual axes from an argument string.
+  * Returns NULL, after printing the reason, if the arguments do not fit. */
+typedef kinematicsTransform* (*kinematicsTransformFactory)(int numReal, int numVirtual, const char *args);
+
+epicsShareFunc int kinematicsRegisterTransform(const char *name, kinematicsTransformFactory factory);
+epicsShareFunc kinematicsTransform* kinematicsCreateTransform(const char *name, int numReal,
+                                                             int numVirtual, const char *args);
+epicsShareFunc int kinematicsParseArgs(const char *args, double *values, int maxValues);
+
+#endif /* kinematicsTransform_H */
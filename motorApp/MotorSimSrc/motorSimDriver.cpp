@@ -32,6 +32,7 @@ December 13, 2009
 #define DEFAULT_HI_LIMIT   10000
 #define DEFAULT_HOME       0
 #define DEFAULT_START      0
+#define MAX_MESSAGE_LEN    256
 
 static const char *driverName = "motorSimDriver";
 
@@ -49,28 +50,24 @@ static int motorSimControllerListInitialized = 0;
 motorSimAxis::motorSimAxis(motorSimController *pController, int axis, double lowHardLimit, double hiHardLimit, double home, double start )
   : asynMotorAxis(pController, axis),
     pC_(pController),
-    lowHardLimit_(lowHardLimit), hiHardLimit_(hiHardLimit), home_(home)
-{
-  route_pars_t pars;
-
-  pars.numRoutedAxes = 1;
-  pars.routedAxisList[0] = 1;
-  pars.Tsync = 0.0;
-  pars.Tcoast = 0.0;
-  pars.axis[0].Amax = 1.0;
-  pars.axis[0].Vmax = 1.0;
-
-  endpoint_.T = 0;
-  endpoint_.axis[0].p = start;
-  endpoint_.axis[0].v = 0;
-  nextpoint_.T = 0;
-  nextpoint_.axis[0].p = start;
-  route_ = routeNew( &(this->endpoint_), &pars );
-  deferred_move_ = 0;
+    lowHardLimit_(lowHardLimit), hiHardLimit_(hiHardLimit), enc_offset_(0.0), home_(home), homing_(0),
+    deferred_position_(0.0), deferred_move_(0), deferred_relative_(0),
+    lastTimeSecs_(0.0), delayedDone_(0), lastDone_(0), needsUpdate_(1),
+    nextIdlePoll_(0.0), polledDone_(0),
+    profileKnotPositions_(NULL), profileKnotVelocities_(NULL), profileOrigin_(0.0),
+    profileSimReadbacks_(NULL), profileSimErrors_(NULL), profileUse_(0)
+{
+  pC_->mode_[axisNo_]         = SIM_IDLE;
+  pC_->position_[axisNo_]     = start;
+  pC_->lastPosition_[axisNo_] = start;
+  pC_->velocity_[axisNo_]     = 0.0;
+  pC_->target_[axisNo_]       = start;
+  pC_->maxVelocity_[axisNo_]  = 1.0;
+  pC_->acceleration_[axisNo_] = 1.0;
 }
 
 
-motorSimController::motorSimController(const char *portName, int numAxes, int priority, int stackSize)
+motorSimController::motorSimController(const char *portName, int numAxes, int priority, int stackSize, int tickRate)
   :  asynMotorController(portName, numAxes, NUM_SIM_CONTROLLER_PARAMS, 
                          asynInt32Mask | asynFloat64Mask, 
                          asynInt32Mask | asynFloat64Mask,
@@ -80,6 +77,7 @@ motorSimController::motorSimController(const char *portName, int numAxes, int pr
 {
   int axis;
   motorSimControllerNode *pNode;
+  route_axis_pars_t *routePars;
   
   if (!motorSimControllerListInitialized) {
     motorSimControllerListInitialized = 1;
@@ -92,18 +90,110 @@ motorSimController::motorSimController(const char *portName, int numAxes, int pr
   pNode->pController = this;
   ellAdd(&motorSimControllerList, (ELLNODE *)pNode);
 
+  // Create controller-specific parameters
+  createParam(motorSimMoveLatencyString,  asynParamFloat64, &motorSimMoveLatency_);
+  createParam(motorSimPollLatencyString,  asynParamFloat64, &motorSimPollLatency_);
+  createParam(motorSimStopLatencyString,  asynParamFloat64, &motorSimStopLatency_);
+  createParam(motorSimJitterString,       asynParamFloat64, &motorSimJitter_);
+  createParam(motorSimLatencyDistString,  asynParamInt32,   &motorSimLatencyDist_);
+  createParam(motorSimDropRateString,     asynParamFloat64, &motorSimDropRate_);
+  createParam(motorSimErrorRateString,    asynParamFloat64, &motorSimErrorRate_);
+  createParam(motorSimErrorBurstString,   asynParamInt32,   &motorSimErrorBurst_);
+  createParam(motorSimTimeoutString,      asynParamFloat64, &motorSimTimeout_);
+  createParam(motorSimSeedString,         asynParamInt32,   &motorSimSeed_);
+  createParam(motorSimNumCallsString,     asynParamInt32,   &motorSimNumCalls_);
+  createParam(motorSimNumDroppedString,   asynParamInt32,   &motorSimNumDropped_);
+  createParam(motorSimNumErrorsString,    asynParamInt32,   &motorSimNumErrors_);
+
+  // By default the simulator answers every call at once
+  setDoubleParam(motorSimMoveLatency_, 0.0);
+  setDoubleParam(motorSimPollLatency_, 0.0);
+  setDoubleParam(motorSimStopLatency_, 0.0);
+  setDoubleParam(motorSimJitter_, 0.0);
+  setIntegerParam(motorSimLatencyDist_, SIM_LATENCY_UNIFORM);
+  setDoubleParam(motorSimDropRate_, 0.0);
+  setDoubleParam(motorSimErrorRate_, 0.0);
+  setIntegerParam(motorSimErrorBurst_, 1);
+  setDoubleParam(motorSimTimeout_, DEFAULT_CONTROLLER_TIMEOUT);
+  setIntegerParam(motorSimSeed_, 1);
+  setIntegerParam(motorSimNumCalls_, 0);
+  setIntegerParam(motorSimNumDropped_, 0);
+  setIntegerParam(motorSimNumErrors_, 0);
+  randomState_ = 1;
+  errorBurstRemaining_ = 0;
+  commsDelay_ = 0.0;
+  numCalls_ = 0;
+  nextCountersPost_ = 0.0;
+
   if (numAxes < 1 ) numAxes = 1;
   numAxes_ = numAxes;
   this->movesDeferred_ = 0;
+
+  if (tickRate == 0) tickRate = DEFAULT_TICK_RATE;
+  if (tickRate < MIN_TICK_RATE) tickRate = MIN_TICK_RATE;
+  if (tickRate > MAX_TICK_RATE) tickRate = MAX_TICK_RATE;
+  tickPeriod_ = 1.0 / tickRate;
+
+  mode_         = (int *)   calloc(numAxes, sizeof(int));
+  position_     = (double *)calloc(numAxes, sizeof(double));
+  lastPosition_ = (double *)calloc(numAxes, sizeof(double));
+  velocity_     = (double *)calloc(numAxes, sizeof(double));
+  target_       = (double *)calloc(numAxes, sizeof(double));
+  maxVelocity_  = (double *)calloc(numAxes, sizeof(double));
+  acceleration_ = (double *)calloc(numAxes, sizeof(double));
+  jerk_         = (double *)calloc(numAxes, sizeof(double));
+  scurve_       = (motorSimScurve *)calloc(numAxes, sizeof(motorSimScurve));
+
+  profileKnotTimes_ = NULL;
+  profileNumKnots_ = 0;
+  profileExecuting_ = PROFILE_EXECUTE_DONE;
+  profileTime_ = 0.0;
+  profileKnot_ = 0;
+  profilePulseStart_ = 0.0;
+  profilePulsePeriod_ = 0.0;
+  profilePulseTotal_ = 0;
+  profilePulseCount_ = 0;
   for (axis=0; axis<numAxes; axis++) {
     new motorSimAxis(this, axis, DEFAULT_LOW_LIMIT, DEFAULT_HI_LIMIT, DEFAULT_HOME, DEFAULT_START);
     setDoubleParam(axis, this->motorPosition_, DEFAULT_START);
   }
 
+  /* One single axis route per axis, all solved together on each tick */
+  routeValid_   = (int *)   calloc(numAxes, sizeof(int));
+  reroute_      = (route_reroute_t *)calloc(numAxes, sizeof(route_reroute_t));
+  endT_         = (double *)calloc(numAxes, sizeof(double));
+  endP_         = (double *)calloc(numAxes, sizeof(double));
+  endV_         = (double *)calloc(numAxes, sizeof(double));
+  nextT_        = (double *)calloc(numAxes, sizeof(double));
+  nextP_        = (double *)calloc(numAxes, sizeof(double));
+  nextV_        = (double *)calloc(numAxes, sizeof(double));
+  routeStatus_  = (route_status_t *)calloc(numAxes, sizeof(route_status_t));
+  routePars     = (route_axis_pars_t *)calloc(numAxes, sizeof(route_axis_pars_t));
+  simTime_ = 0.0;
+  for (axis=0; axis<numAxes; axis++) {
+    routePars[axis].Amax = acceleration_[axis];
+    routePars[axis].Vmax = maxVelocity_[axis];
+    routeValid_[axis] = 1;
+    reroute_[axis] = ROUTE_CALC_ROUTE;
+    endP_[axis] = position_[axis];
+  }
+  route_ = routeBatchNew(numAxes, 1, 0.0, 0.0, routePars, simTime_, position_, velocity_);
+  free(routePars);
+  if (route_ == NULL) {
+    asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s:motorSimController: port %s, cannot create the routes\n",
+              driverName, portName);
+    return;
+  }
+
   this->motorThread_ = epicsThreadCreate("motorSimThread", 
                                          epicsThreadPriorityLow,
                                          epicsThreadGetStackSize(epicsThreadStackMedium),
                                          (EPICSTHREADFUNC) motorSimTaskC, (void *) this);
+
+  /* The status is published by the asynMotorController poller through motorSimAxis::poll(),
+   * so that the poll latency and faults go through the same path as for a real controller */
+  startPoller(tickPeriod_, SIM_IDLE_POLL_PERIOD, 2);
 }
 
 void motorSimController::report(FILE *fp, int level)
@@ -111,8 +201,8 @@ void motorSimController::report(FILE *fp, int level)
   int axis;
   motorSimAxis *pAxis;
 
-  fprintf(fp, "Simulation motor driver %s, numAxes=%d\n", 
-          this->portName, numAxes_);
+  fprintf(fp, "Simulation motor driver %s, numAxes=%d, tick rate=%g Hz\n", 
+          this->portName, numAxes_, 1.0 / tickPeriod_);
 
   for (axis=0; axis<numAxes_; axis++) {
     pAxis = getAxis(axis);
@@ -123,14 +213,13 @@ void motorSimController::report(FILE *fp, int level)
       double lowSoftLimit=0.0;
       double hiSoftLimit=0.0;
 
-      fprintf(fp, "  Current position = %f, velocity = %f at current time: %f\n", 
-           pAxis->nextpoint_.axis[0].p, 
-           pAxis->nextpoint_.axis[0].v,
-           pAxis->nextpoint_.T);
-      fprintf(fp, "  Destination posn = %f, velocity = %f at desination time:  %f\n",
-           pAxis->endpoint_.axis[0].p, 
-           pAxis->endpoint_.axis[0].v,
-           pAxis->endpoint_.T);
+      fprintf(fp, "  Current position = %f, velocity = %f\n", 
+           position_[axis], velocity_[axis]);
+      fprintf(fp, "  Mode = %s, target = %f, max. velocity = %f, acceleration = %f\n",
+           (mode_[axis] == SIM_POSITION) ? "position" : (mode_[axis] == SIM_VELOCITY) ? "velocity" : "idle",
+           target_[axis], maxVelocity_[axis], acceleration_[axis]);
+      fprintf(fp, "  Route end posn = %f, velocity = %f at time %f, current time %f, status %d\n",
+           endP_[axis], endV_[axis], endT_[axis], simTime_, routeStatus_[axis]);
 
       fprintf(fp, "    Hard limits: %f, %f\n", pAxis->lowHardLimit_, pAxis->hiHardLimit_);
       fprintf(fp, "           Home: %f\n", pAxis->home_);
@@ -140,8 +229,31 @@ void motorSimController::report(FILE *fp, int level)
       fprintf(fp, "    Soft limits: %f, %f\n", lowSoftLimit, hiSoftLimit );
 
       if (pAxis->homing_) fprintf(fp, "    Currently homing axis\n" );
+      if (pAxis->profileUse_) fprintf(fp, "    Used in profile, origin: %f\n", pAxis->profileOrigin_);
+      if (jerk_[axis] > 0) fprintf(fp, "    S-curve: jerk=%f, plan time=%f/%f, peak velocity=%f\n",
+                                   jerk_[axis], scurve_[axis].time, scurve_[axis].plan.T, scurve_[axis].plan.vPeak);
     }
   }
+  if (level > 0) {
+    double moveLatency, pollLatency, stopLatency, jitter, dropRate, errorRate;
+    int numCalls, numDropped, numErrors;
+
+    getDoubleParam(motorSimMoveLatency_, &moveLatency);
+    getDoubleParam(motorSimPollLatency_, &pollLatency);
+    getDoubleParam(motorSimStopLatency_, &stopLatency);
+    getDoubleParam(motorSimJitter_, &jitter);
+    getDoubleParam(motorSimDropRate_, &dropRate);
+    getDoubleParam(motorSimErrorRate_, &errorRate);
+    numCalls = numCalls_;
+    getIntegerParam(motorSimNumDropped_, &numDropped);
+    getIntegerParam(motorSimNumErrors_, &numErrors);
+    fprintf(fp, "  Latency: move=%f, poll=%f, stop=%f, jitter=%f\n",
+            moveLatency, pollLatency, stopLatency, jitter);
+    fprintf(fp, "  Faults: drop rate=%f, error rate=%f; calls=%d, dropped=%d, errors=%d\n",
+            dropRate, errorRate, numCalls, numDropped, numErrors);
+    fprintf(fp, "  Profile: %d knots, execute state=%d, time=%f, pulses=%d/%d\n",
+            profileNumKnots_, profileExecuting_, profileTime_, profilePulseCount_, profilePulseTotal_);
+  }
 
   // Call the base class method
   asynMotorController::report(fp, level);
@@ -160,10 +272,9 @@ asynStatus motorSimController::processDeferredMoves()
     if (pAxis->deferred_move_) {
       position = pAxis->deferred_position_;
       /* Check to see if in hard limits */
-      if ((pAxis->nextpoint_.axis[0].p >= pAxis->hiHardLimit_  &&  position > pAxis->nextpoint_.axis[0].p) ||
-          (pAxis->nextpoint_.axis[0].p <= pAxis->lowHardLimit_ &&  position < pAxis->nextpoint_.axis[0].p)) return asynError;
-      pAxis->endpoint_.axis[0].p = position - pAxis->enc_offset_;
-      pAxis->endpoint_.axis[0].v = 0.0;    
+      if ((position_[axis] >= pAxis->hiHardLimit_  &&  position > position_[axis]) ||
+          (position_[axis] <= pAxis->lowHardLimit_ &&  position < position_[axis])) return asynError;
+      pAxis->setTarget(position - pAxis->enc_offset_);
       setIntegerParam(axis, motorStatusDone_, 0);
       pAxis->deferred_move_ = 0;
     }
@@ -194,6 +305,13 @@ asynStatus motorSimController::writeInt32(asynUser *pasynUser, epicsInt32 value)
       processDeferredMoves();
     }
     movesDeferred_ = value;
+  } else if (function == motorSimNumCalls_) {
+    /* Reset or preset the call counter */
+    numCalls_ = value;
+  } else if (function == motorSimSeed_) {
+    /* Restart the fault sequence */
+    randomState_ = value ? value : 1;
+    errorBurstRemaining_ = 0;
   } else {
     /* Call base class call its method (if we have our parameters check this here) */
     status = asynMotorController::writeInt32(pasynUser, value);
@@ -222,14 +340,586 @@ motorSimAxis* motorSimController::getAxis(int axisNo)
   return static_cast<motorSimAxis*>(asynMotorController::getAxis(axisNo));
 }
 
-asynStatus motorSimController::profileMove(asynUser *pasynUser, int npoints, double positions[], double times[], int relative, int trigger )
+/** Allocates the profile arrays of the controller and all axes.
+  * The knot arrays have 2 more elements than the profile, for the acceleration
+  * and deceleration points.
+  * \param[in] maxPoints Maximum number of profile points. */
+asynStatus motorSimController::initializeProfile(size_t maxPoints)
+{
+  asynMotorController::initializeProfile(maxPoints);
+  if (profileKnotTimes_) free(profileKnotTimes_);
+  profileKnotTimes_ = (double *)calloc(maxPoints+2, sizeof(double));
+  profileNumKnots_ = 0;
+  return asynSuccess;
+}
+
+/** Builds a PVT profile from the profile positions and times.
+  * As on the XPS, an acceleration element is added before the first point and a
+  * deceleration element after the last one.  They last PROFILE_ACCELERATION seconds.
+  * The velocity at each point is the average velocity of the elements either side of it. */
+asynStatus motorSimController::buildProfile()
+{
+  motorSimAxis *pAxis;
+  int i, axis;
+  int numPoints, numElements;
+  int startPulses, endPulses, numPulses;
+  int lastElement;
+  int numUsed = 0;
+  bool buildOK = true;
+  double accelTime, rampTime;
+  double T0, T1, D0, D1;
+  double *positions, *knotPositions, *knotVelocities;
+  char message[MAX_MESSAGE_LEN];
+  static const char *functionName = "buildProfile";
+
+  // Call the base class method which will build the time array if needed
+  asynMotorController::buildProfile();
+
+  strcpy(message, " ");
+  setStringParam(profileBuildMessage_, message);
+  setIntegerParam(profileBuildState_, PROFILE_BUILD_BUSY);
+  setIntegerParam(profileBuildStatus_, PROFILE_STATUS_UNDEFINED);
+  callParamCallbacks();
+
+  profileNumKnots_ = 0;
+  getIntegerParam(profileNumPoints_,   &numPoints);
+  getIntegerParam(profileStartPulses_, &startPulses);
+  getIntegerParam(profileEndPulses_,   &endPulses);
+  getIntegerParam(profileNumPulses_,   &numPulses);
+  getDoubleParam(profileAcceleration_, &accelTime);
+  numElements = numPoints - 1;
+
+  if (maxProfilePoints_ == 0) {
+    buildOK = false;
+    sprintf(message, "Profile not initialized, call motorSimCreateProfile");
+    goto done;
+  }
+  if ((numPoints < 2) || (numPoints > (int)maxProfilePoints_)) {
+    buildOK = false;
+    sprintf(message, "Number of points must be between 2 and %d", (int)maxProfilePoints_);
+    goto done;
+  }
+  for (i=0; i<numElements; i++) {
+    if (profileTimes_[i] <= 0) {
+      buildOK = false;
+      sprintf(message, "Negative or null delta time at element %d", i+1);
+      goto done;
+    }
+  }
+  // Valid range of start and end pulses;  these start at 1, not 0.
+  if ((startPulses < 1)           || (startPulses > numElements) ||
+      (endPulses   < startPulses) || (endPulses   > numElements+1)) {
+    buildOK = false;
+    sprintf(message, "Error: start or end pulses outside valid range");
+    goto done;
+  }
+  if ((numPulses < 0) || (numPulses > (int)maxProfilePoints_)) {
+    buildOK = false;
+    sprintf(message, "Number of pulses must be between 0 and %d", (int)maxProfilePoints_);
+    goto done;
+  }
+  if (accelTime < tickPeriod_) accelTime = tickPeriod_;
+
+  /* Knot i+1 is profile point i */
+  profileKnotTimes_[0] = 0.0;
+  profileKnotTimes_[1] = accelTime;
+  for (i=0; i<numElements; i++) {
+    profileKnotTimes_[i+2] = profileKnotTimes_[i+1] + profileTimes_[i];
+  }
+  profileKnotTimes_[numPoints+1] = profileKnotTimes_[numPoints] + accelTime;
+
+  for (axis=0; axis<numAxes_; axis++) {
+    pAxis = getAxis(axis);
+    getIntegerParam(axis, profileUseAxis_, &pAxis->profileUse_);
+    if (!pAxis->profileUse_) continue;
+    numUsed++;
+    positions = pAxis->profilePositions_;
+    knotPositions = pAxis->profileKnotPositions_;
+    knotVelocities = pAxis->profileKnotVelocities_;
+    for (i=0; i<numPoints; i++) {
+      if (i == 0) {
+        knotVelocities[i+1] = (positions[1] - positions[0]) / profileTimes_[0];
+      } else if (i == numElements) {
+        knotVelocities[i+1] = (positions[i] - positions[i-1]) / profileTimes_[i-1];
+      } else {
+        /* Average either side of the point */
+        T0 = profileTimes_[i-1];
+        T1 = profileTimes_[i];
+        D0 = positions[i] - positions[i-1];
+        D1 = positions[i+1] - positions[i];
+        knotVelocities[i+1] = (D0 + D1) / (T0 + T1);
+      }
+      knotPositions[i+1] = positions[i];
+    }
+    /* Constant acceleration from and to rest */
+    knotPositions[0] = positions[0] - 0.5 * knotVelocities[1] * accelTime;
+    knotVelocities[0] = 0.0;
+    knotPositions[numPoints+1] = positions[numElements] + 0.5 * knotVelocities[numPoints] * accelTime;
+    knotVelocities[numPoints+1] = 0.0;
+    /* An axis with a jerk limit must be able to reach the start and end velocities in time */
+    if (jerk_[axis] > 0) {
+      rampTime = scurveRampTime((fabs(knotVelocities[1]) > fabs(knotVelocities[numPoints])) ?
+                                knotVelocities[1] : knotVelocities[numPoints],
+                                acceleration_[axis], jerk_[axis]);
+      if (rampTime > accelTime) {
+        buildOK = false;
+        sprintf(message, "Axis %d needs %f s to accelerate with its jerk limit", axis, rampTime);
+        goto done;
+      }
+    }
+  }
+  if (numUsed == 0) {
+    buildOK = false;
+    sprintf(message, "No axes are used in the profile");
+    goto done;
+  }
+
+  /* Pulses are output at a fixed period from the beginning of element startPulses
+   * to the end of element endPulses */
+  lastElement = endPulses;
+  if (lastElement > numElements) lastElement = numElements;
+  profilePulseStart_ = profileKnotTimes_[startPulses];
+  profilePulseTotal_ = numPulses;
+  if (numPulses > 0)
+    profilePulsePeriod_ = (profileKnotTimes_[lastElement+1] - profilePulseStart_) / numPulses;
+  else
+    profilePulsePeriod_ = 0.0;
+  profileNumKnots_ = numPoints + 2;
+
+  done:
+  setIntegerParam(profileBuildStatus_, buildOK ? PROFILE_STATUS_SUCCESS : PROFILE_STATUS_FAILURE);
+  setStringParam(profileBuildMessage_, message);
+  if (!buildOK) {
+    asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s:%s: %s\n",
+              driverName, functionName, message);
+  }
+  /* Clear build command.  This is a "busy" record, don't want to do this until build is complete. */
+  setIntegerParam(profileBuild_, 0);
+  setIntegerParam(profileBuildState_, PROFILE_BUILD_DONE);
+  callParamCallbacks();
+  return buildOK ? asynSuccess : asynError;
+}
+
+/** Starts a profile.  The axes are moved to the start of the acceleration element,
+  * and processProfile() runs the rest of the profile from the simulation thread. */
+asynStatus motorSimController::executeProfile()
+{
+  motorSimAxis *pAxis;
+  int axis;
+  int moveMode;
+  const char *message;
+  static const char *functionName = "executeProfile";
+
+  if ((profileNumKnots_ == 0) || (profileExecuting_ != PROFILE_EXECUTE_DONE)) {
+    message = profileNumKnots_ ? "Profile is already executing" : "Profile has not been built";
+    setIntegerParam(profileExecuteStatus_, PROFILE_STATUS_FAILURE);
+    setStringParam(profileExecuteMessage_, message);
+    setIntegerParam(profileExecute_, 0);
+    callParamCallbacks();
+    asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s:%s: %s\n",
+              driverName, functionName, message);
+    return asynError;
+  }
+
+  // The origin of the trajectory depends on whether we are in absolute or relative mode
+  getIntegerParam(profileMoveMode_, &moveMode);
+  for (axis=0; axis<numAxes_; axis++) {
+    pAxis = getAxis(axis);
+    if (!pAxis->profileUse_) continue;
+    if (moveMode == PROFILE_MOVE_MODE_ABSOLUTE)
+      pAxis->profileOrigin_ = -pAxis->enc_offset_;
+    else
+      pAxis->profileOrigin_ = position_[axis];
+    pAxis->setTarget(pAxis->profileOrigin_ + pAxis->profileKnotPositions_[0]);
+  }
+  profileTime_ = 0.0;
+  profileKnot_ = 0;
+  profilePulseCount_ = 0;
+  profileExecuting_ = PROFILE_EXECUTE_MOVE_START;
+  setIntegerParam(profileCurrentPoint_, 0);
+  setIntegerParam(profileActualPulses_, 0);
+  setStringParam(profileExecuteMessage_, " ");
+  setIntegerParam(profileExecuteState_, PROFILE_EXECUTE_MOVE_START);
+  setIntegerParam(profileExecuteStatus_, PROFILE_STATUS_UNDEFINED);
+  callParamCallbacks();
+  return asynSuccess;
+}
+
+/** Aborts a profile.  The axes decelerate to a stop from wherever they are. */
+asynStatus motorSimController::abortProfile()
+{
+  int axis;
+
+  if (profileExecuting_ == PROFILE_EXECUTE_DONE) return asynSuccess;
+  for (axis=0; axis<numAxes_; axis++) {
+    if (!getAxis(axis)->profileUse_ || (mode_[axis] == SIM_IDLE)) continue;
+    mode_[axis] = SIM_VELOCITY;
+    target_[axis] = 0.0;
+    startRoute(axis);
+  }
+  finishProfile(PROFILE_STATUS_ABORT, "Profile aborted");
+  return asynSuccess;
+}
+
+/** Posts the readbacks and following errors recorded at each pulse of the last profile */
+asynStatus motorSimController::readbackProfile()
+{
+  motorSimAxis *pAxis;
+  int axis;
+  bool readbackOK = true;
+  char message[MAX_MESSAGE_LEN];
+  static const char *functionName = "readbackProfile";
+
+  strcpy(message, " ");
+  setStringParam(profileReadbackMessage_, message);
+  setIntegerParam(profileReadbackState_, PROFILE_READBACK_BUSY);
+  setIntegerParam(profileReadbackStatus_, PROFILE_STATUS_UNDEFINED);
+  callParamCallbacks();
+
+  if (maxProfilePoints_ == 0) {
+    readbackOK = false;
+    sprintf(message, "Profile not initialized, call motorSimCreateProfile");
+    goto done;
+  }
+  if (profilePulseCount_ < profilePulseTotal_) {
+    readbackOK = false;
+    sprintf(message, "Error, numPulses=%d, readbacks=%d", profilePulseTotal_, profilePulseCount_);
+  }
+  /* The base class converts the arrays in place, so start from the raw values each time */
+  for (axis=0; axis<numAxes_; axis++) {
+    pAxis = getAxis(axis);
+    memcpy(pAxis->profileReadbacks_,       pAxis->profileSimReadbacks_, profilePulseCount_*sizeof(double));
+    memcpy(pAxis->profileFollowingErrors_, pAxis->profileSimErrors_,    profilePulseCount_*sizeof(double));
+  }
+  setIntegerParam(profileActualPulses_, profilePulseCount_);
+  setIntegerParam(profileNumReadbacks_, profilePulseCount_);
+  /* Convert from controller to user units and post the arrays */
+  asynMotorController::readbackProfile();
+
+  done:
+  setIntegerParam(profileReadbackStatus_, readbackOK ? PROFILE_STATUS_SUCCESS : PROFILE_STATUS_FAILURE);
+  setStringParam(profileReadbackMessage_, message);
+  if (!readbackOK) {
+    asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s:%s: %s\n",
+              driverName, functionName, message);
+  }
+  /* Clear readback command.  This is a "busy" record, don't want to do this until readback is complete. */
+  setIntegerParam(profileReadback_, 0);
+  setIntegerParam(profileReadbackState_, PROFILE_READBACK_DONE);
+  callParamCallbacks();
+  return readbackOK ? asynSuccess : asynError;
+}
+
+/** Sets the execute status and returns the profile to the done state */
+void motorSimController::finishProfile(int status, const char *message)
+{
+  static const char *functionName = "finishProfile";
+
+  profileExecuting_ = PROFILE_EXECUTE_DONE;
+  setIntegerParam(profileExecuteStatus_, status);
+  setStringParam(profileExecuteMessage_, message);
+  if (status != PROFILE_STATUS_SUCCESS) {
+    asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s:%s: %s\n",
+              driverName, functionName, message);
+  }
+  /* Clear execute command.  This is a "busy" record, don't want to do this until the profile is complete. */
+  setIntegerParam(profileExecute_, 0);
+  setIntegerParam(profileExecuteState_, PROFILE_EXECUTE_DONE);
+  callParamCallbacks();
+}
+
+/** Evaluates the profile of an axis by cubic Hermite interpolation between knots.
+  * \param[in] pAxis Axis to evaluate.
+  * \param[in] time Time since the start of the acceleration element.
+  * \param[out] position Setpoint position, without the profile origin.
+  * \param[out] velocity Setpoint velocity. */
+void motorSimController::profileSample(motorSimAxis *pAxis, double time, double *position, double *velocity)
+{
+  int k = profileKnot_;
+  double h, s, s2, s3;
+  double p0, p1, m0, m1;
+
+  while ((k > 0) && (time < profileKnotTimes_[k])) k--;
+  while ((k < profileNumKnots_-2) && (time >= profileKnotTimes_[k+1])) k++;
+  h = profileKnotTimes_[k+1] - profileKnotTimes_[k];
+  s = (time - profileKnotTimes_[k]) / h;
+  if (s < 0.0) s = 0.0;
+  if (s > 1.0) s = 1.0;
+  s2 = s*s;
+  s3 = s2*s;
+  p0 = pAxis->profileKnotPositions_[k];
+  p1 = pAxis->profileKnotPositions_[k+1];
+  m0 = pAxis->profileKnotVelocities_[k] * h;
+  m1 = pAxis->profileKnotVelocities_[k+1] * h;
+  *position = (2*s3 - 3*s2 + 1)*p0 + (s3 - 2*s2 + s)*m0 + (-2*s3 + 3*s2)*p1 + (s3 - s2)*m1;
+  *velocity = ((6*s2 - 6*s)*p0 + (3*s2 - 4*s + 1)*m0 + (-6*s2 + 6*s)*p1 + (3*s2 - 2*s)*m1) / h;
+}
+
+/** Advances a running profile by one tick.
+  * Called from motorSimTask() with the lock held, after processRoutes() and
+  * before the axes check their limits.
+  * \param[in] delta Time since the last tick in seconds. */
+void motorSimController::processProfile(double delta)
+{
+  motorSimAxis *pAxis;
+  int axis;
+  int numPoints;
+  int currentPoint;
+  double pulseTime, setpoint, velocity, followingError;
+
+  if (profileExecuting_ == PROFILE_EXECUTE_DONE) return;
+
+  if (profileExecuting_ == PROFILE_EXECUTE_MOVE_START) {
+    /* Wait for the axes to reach the start of the acceleration element */
+    for (axis=0; axis<numAxes_; axis++) {
+      if (getAxis(axis)->profileUse_ && (mode_[axis] != SIM_IDLE)) return;
+    }
+    for (axis=0; axis<numAxes_; axis++) {
+      pAxis = getAxis(axis);
+      if (!pAxis->profileUse_) continue;
+      if (position_[axis] != pAxis->profileOrigin_ + pAxis->profileKnotPositions_[0]) {
+        finishProfile(PROFILE_STATUS_ABORT, "Move to the profile start was interrupted");
+        return;
+      }
+    }
+    for (axis=0; axis<numAxes_; axis++) {
+      if (getAxis(axis)->profileUse_) mode_[axis] = SIM_PROFILE;
+    }
+    profileExecuting_ = PROFILE_EXECUTE_EXECUTING;
+    setIntegerParam(profileExecuteState_, PROFILE_EXECUTE_EXECUTING);
+    callParamCallbacks();
+    return;
+  }
+
+  if (profileExecuting_ == PROFILE_EXECUTE_FLYBACK) {
+    for (axis=0; axis<numAxes_; axis++) {
+      if (getAxis(axis)->profileUse_ && (mode_[axis] != SIM_IDLE)) return;
+    }
+    finishProfile(PROFILE_STATUS_SUCCESS, " ");
+    return;
+  }
+
+  /* Executing.  An axis that was stopped or moved elsewhere ends the profile. */
+  for (axis=0; axis<numAxes_; axis++) {
+    if (getAxis(axis)->profileUse_ && (mode_[axis] != SIM_PROFILE)) {
+      abortProfile();
+      return;
+    }
+  }
+  profileTime_ += delta;
+
+  /* Record the readbacks at each pulse since the last tick */
+  while (profilePulseCount_ < profilePulseTotal_) {
+    pulseTime = profilePulseStart_ + profilePulseCount_ * profilePulsePeriod_;
+    if (pulseTime > profileTime_) break;
+    for (axis=0; axis<numAxes_; axis++) {
+      pAxis = getAxis(axis);
+      if (pAxis->profileUse_) {
+        profileSample(pAxis, pulseTime, &setpoint, &velocity);
+        followingError = -velocity * SIM_PROFILE_LAG;
+        setpoint += pAxis->profileOrigin_ + pAxis->enc_offset_;
+      } else {
+        followingError = 0.0;
+        setpoint = position_[axis] + pAxis->enc_offset_;
+      }
+      pAxis->profileSimReadbacks_[profilePulseCount_] = setpoint + followingError;
+      pAxis->profileSimErrors_[profilePulseCount_] = followingError;
+    }
+    profilePulseCount_++;
+  }
+
+  while ((profileKnot_ < profileNumKnots_-2) && (profileTime_ >= profileKnotTimes_[profileKnot_+1])) profileKnot_++;
+  if (profileTime_ >= profileKnotTimes_[profileNumKnots_-1]) {
+    /* End of the deceleration element, move back to the last profile point */
+    for (axis=0; axis<numAxes_; axis++) {
+      pAxis = getAxis(axis);
+      if (!pAxis->profileUse_) continue;
+      position_[axis] = pAxis->profileOrigin_ + pAxis->profileKnotPositions_[profileNumKnots_-1];
+      velocity_[axis] = 0.0;
+      pAxis->setTarget(pAxis->profileOrigin_ + pAxis->profileKnotPositions_[profileNumKnots_-2]);
+    }
+    profileExecuting_ = PROFILE_EXECUTE_FLYBACK;
+    setIntegerParam(profileExecuteState_, PROFILE_EXECUTE_FLYBACK);
+  } else {
+    for (axis=0; axis<numAxes_; axis++) {
+      pAxis = getAxis(axis);
+      if (!pAxis->profileUse_) continue;
+      profileSample(pAxis, profileTime_, &setpoint, &velocity);
+      position_[axis] = pAxis->profileOrigin_ + setpoint;
+      velocity_[axis] = velocity;
+    }
+  }
+
+  /* Knot k+1 is profile point k, so profileKnot_ points have been passed */
+  numPoints = profileNumKnots_ - 2;
+  currentPoint = profileKnot_;
+  if (currentPoint > numPoints) currentPoint = numPoints;
+  setIntegerParam(profileCurrentPoint_, currentPoint);
+  setIntegerParam(profileActualPulses_, profilePulseCount_);
+  callParamCallbacks();
+}
+
+/** Sets the simulated latency of each kind of transaction.
+  * \param[in] moveLatency Latency of move, home and set position commands in seconds.
+  * \param[in] pollLatency Latency of polls in seconds.
+  * \param[in] stopLatency Latency of stop commands in seconds.
+  * \param[in] jitter Spread of the latency in seconds.
+  * \param[in] distribution motorSimLatencyDist, the shape of the spread. */
+asynStatus motorSimController::configLatency(double moveLatency, double pollLatency, double stopLatency,
+                                             double jitter, int distribution)
 {
-  return asynError;
+  lock();
+  setDoubleParam(motorSimMoveLatency_, moveLatency);
+  setDoubleParam(motorSimPollLatency_, pollLatency);
+  setDoubleParam(motorSimStopLatency_, stopLatency);
+  setDoubleParam(motorSimJitter_, jitter);
+  setIntegerParam(motorSimLatencyDist_, distribution);
+  callParamCallbacks();
+  unlock();
+  return asynSuccess;
+}
+
+/** Sets the rates of simulated communication faults.
+  * \param[in] dropRate Probability that the reply to a transaction is lost.
+  * \param[in] errorRate Probability that a transaction starts a burst of errors.
+  * \param[in] errorBurst Number of consecutive transactions that fail in a burst.
+  * \param[in] timeout Time to wait for a lost reply in seconds, 0 to leave unchanged.
+  * \param[in] seed Seed of the fault sequence. */
+asynStatus motorSimController::configFaults(double dropRate, double errorRate, int errorBurst,
+                                            double timeout, int seed)
+{
+  lock();
+  setDoubleParam(motorSimDropRate_, dropRate);
+  setDoubleParam(motorSimErrorRate_, errorRate);
+  setIntegerParam(motorSimErrorBurst_, errorBurst);
+  if (timeout > 0) setDoubleParam(motorSimTimeout_, timeout);
+  setIntegerParam(motorSimSeed_, seed);
+  randomState_ = seed ? seed : 1;
+  errorBurstRemaining_ = 0;
+  callParamCallbacks();
+  unlock();
+  return asynSuccess;
+}
+
+/** Selects jerk limited (S-curve) or trapezoidal motion for an axis.
+  * S-curve moves use the velocity and acceleration of the move as limits.
+  * \param[in] axis Axis number.
+  * \param[in] jerk Maximum jerk in steps/s^3, 0 for trapezoidal motion. */
+asynStatus motorSimController::configJerk(int axis, double jerk)
+{
+  if ((axis < 0) || (axis >= numAxes_) || (jerk < 0)) return asynError;
+  lock();
+  jerk_[axis] = jerk;
+  /* Make a new plan from the current motion on the next tick */
+  scurve_[axis].mode = SIM_IDLE;
+  unlock();
+  return asynSuccess;
 }
 
-asynStatus motorSimController::triggerProfile(asynUser *pasynUser)
+/** Returns a pseudo-random number in [0, 1).
+  * This is xorshift32 rather than rand(), so that a seed gives the same fault
+  * sequence on every platform. */
+double motorSimController::uniformRandom()
 {
-  return asynError;
+  randomState_ ^= randomState_ << 13;
+  randomState_ ^= randomState_ >> 17;
+  randomState_ ^= randomState_ << 5;
+  return randomState_ / 4294967296.0;
+}
+
+/** Simulates the communication latency and faults of a real controller.
+  * It is called with the lock held at the start of each transaction, and sleeps for
+  * the simulated latency without releasing it, as a driver waiting for a reply would.
+  * \param[in] pasynUser asynUser used for tracing, normally that of the axis.
+  * \param[in] operation motorSimOperation of the transaction, which selects the latency.
+  * \returns asynError if the controller rejected the command, which must then not be
+  * executed.  asynTimeout if the command was executed but the reply was lost. */
+asynStatus motorSimController::simulateComms(asynUser *pasynUser, int operation)
+{
+  double latency, jitter, dropRate, errorRate, timeout, delay;
+  int dist, errorBurst, count;
+  int latencyParam;
+  asynStatus status = asynSuccess;
+  static const char *operationNames[] = {"move", "poll", "stop"};
+  static const char *functionName = "simulateComms";
+
+  switch (operation) {
+    case SIM_OPERATION_POLL: latencyParam = motorSimPollLatency_; break;
+    case SIM_OPERATION_STOP: latencyParam = motorSimStopLatency_; break;
+    default:                 latencyParam = motorSimMoveLatency_; break;
+  }
+  getDoubleParam(latencyParam, &latency);
+  getDoubleParam(motorSimJitter_, &jitter);
+  getIntegerParam(motorSimLatencyDist_, &dist);
+  getDoubleParam(motorSimDropRate_, &dropRate);
+  getDoubleParam(motorSimErrorRate_, &errorRate);
+  getIntegerParam(motorSimErrorBurst_, &errorBurst);
+  getDoubleParam(motorSimTimeout_, &timeout);
+  numCalls_++;
+
+  delay = latency;
+  if (jitter > 0) {
+    if (dist == SIM_LATENCY_EXPONENTIAL)
+      delay += -jitter * log(1.0 - uniformRandom());
+    else
+      delay += jitter * (2.0 * uniformRandom() - 1.0);
+  }
+  if (delay < 0) delay = 0;
+
+  if (errorBurstRemaining_ > 0) {
+    errorBurstRemaining_--;
+    status = asynError;
+  } else if ((errorRate > 0) && (uniformRandom() < errorRate)) {
+    /* Start a burst of errorBurst consecutive errors */
+    errorBurstRemaining_ = (errorBurst > 1) ? errorBurst - 1 : 0;
+    status = asynError;
+  } else if ((dropRate > 0) && (uniformRandom() < dropRate)) {
+    /* The reply never arrives, so the caller waits for its timeout */
+    delay = timeout;
+    status = asynTimeout;
+  }
+  if (status == asynError) {
+    getIntegerParam(motorSimNumErrors_, &count);
+    setIntegerParam(motorSimNumErrors_, count+1);
+  } else if (status == asynTimeout) {
+    getIntegerParam(motorSimNumDropped_, &count);
+    setIntegerParam(motorSimNumDropped_, count+1);
+  }
+
+  if (delay > 0) {
+    commsDelay_ += delay;
+    epicsThreadSleep(delay);
+  }
+  asynPrint(pasynUser, ASYN_TRACEIO_DRIVER,
+            "%s:%s: port %s, %s, latency=%f, status=%d\n",
+            driverName, functionName, this->portName, operationNames[operation], delay, status);
+  /* The fault counters are on address 0, which the axis callbacks only cover for
+   * axis 0.  SIM_NUM_CALLS changes on every call and is posted by poll(). */
+  if (status != asynSuccess) callParamCallbacks(0);
+  return status;
+}
+
+/** Posts SIM_NUM_CALLS at the idle poll period.
+  * Called by the asynMotorController poller before it polls the axes.  The
+  * counter changes on every simulated call, so posting it each time would flood
+  * its clients while the poller runs at the tick rate. */
+asynStatus motorSimController::poll()
+{
+  epicsTimeStamp now;
+  double nowSecs;
+
+  epicsTimeGetCurrent(&now);
+  nowSecs = now.secPastEpoch + (now.nsec / 1.e9);
+  if (nowSecs >= nextCountersPost_) {
+    nextCountersPost_ = nowSecs + idlePollPeriod_;
+    setIntegerParam(motorSimNumCalls_, numCalls_);
+    callParamCallbacks(0);
+  }
+  return asynSuccess;
 }
 
 static void motorSimTaskC(void *drvPvt)
@@ -239,59 +929,191 @@ static void motorSimTaskC(void *drvPvt)
 }
   
 
-#define DELTA 0.1
+/** Starts the route of an axis to the target of its mode.
+  * In SIM_POSITION mode the route ends at rest at the target.  In SIM_VELOCITY mode
+  * it ends where the axis reaches the target velocity at full acceleration, and
+  * carries on at that velocity.  A route that was left by other motion first starts
+  * again from the current position and velocity.  Axes with a jerk limit are left
+  * to processScurve().
+  * \param[in] axis Axis number. */
+void motorSimController::startRoute(int axis)
+{
+  route_axis_pars_t pars, startPars;
+  double deltaV;
+
+  if ((mode_[axis] != SIM_POSITION) && (mode_[axis] != SIM_VELOCITY)) return;
+  if ((jerk_[axis] > 0) || (route_ == NULL)) return;
+
+  pars.Amax = acceleration_[axis];
+  pars.Vmax = maxVelocity_[axis];
+  if (mode_[axis] == SIM_POSITION) {
+    endP_[axis] = target_[axis];
+    endV_[axis] = 0.0;
+  } else {
+    deltaV = target_[axis] - velocity_[axis];
+    endP_[axis] = position_[axis] + fabs(deltaV) / pars.Amax * (velocity_[axis] + 0.5 * deltaV);
+    endV_[axis] = target_[axis];
+    /* A jog may be faster than the last move */
+    if (fabs(endV_[axis]) > pars.Vmax) pars.Vmax = fabs(endV_[axis]);
+  }
+
+  if (!routeValid_[axis]) {
+    /* The route must accept the current velocity, it then slows to the limit */
+    startPars = pars;
+    if (startPars.Vmax <= fabs(velocity_[axis])) startPars.Vmax = 2.0 * fabs(velocity_[axis]);
+    routeBatchSetParams(route_, axis, &startPars);
+    routeBatchSetDemand(route_, axis, simTime_, &position_[axis], &velocity_[axis]);
+    routeValid_[axis] = 1;
+  }
+  routeBatchSetParams(route_, axis, &pars);
+  endT_[axis] = simTime_;
+  reroute_[axis] = ROUTE_NEW_ROUTE;
+}
+
+/** Advances the motion of all axes on a route by one tick.
+  * The routes of all axes are solved in one routeBatchFind() call, which only
+  * replans the routes whose end point has changed and evaluates all of them in a
+  * single vectorized pass, so that it stays cheap for thousands of axes.  Idle axes
+  * keep their position.  Axes with a jerk limit or in a profile are moved by
+  * processScurve() and processProfile(), and their route is restarted from where
+  * they are when they are next on one.
+  * \param[in] delta Time since the last tick in seconds. */
+void motorSimController::processRoutes(double delta)
+{
+  int axis;
+  bool routed;
+
+  if (route_ == NULL) return;
+  for (axis=0; axis<numAxes_; axis++) {
+    lastPosition_[axis] = position_[axis];
+    routed = ((mode_[axis] == SIM_POSITION) || (mode_[axis] == SIM_VELOCITY)) && (jerk_[axis] <= 0);
+    if (routed && !routeValid_[axis]) startRoute(axis);
+    else if (!routed && (mode_[axis] != SIM_IDLE)) routeValid_[axis] = 0;
+  }
+
+  simTime_ += delta;
+  for (axis=0; axis<numAxes_; axis++) nextT_[axis] = simTime_;
+  routeBatchFind(route_, reroute_, endT_, endP_, endV_, nextT_, nextP_, nextV_, routeStatus_);
+
+  for (axis=0; axis<numAxes_; axis++) {
+    reroute_[axis] = ROUTE_CALC_ROUTE;
+    if (((mode_[axis] != SIM_POSITION) && (mode_[axis] != SIM_VELOCITY)) || (jerk_[axis] > 0)) continue;
+    position_[axis] = nextP_[axis];
+    velocity_[axis] = nextV_[axis];
+  }
+}
+
+/** Advances the motion of the axes with a jerk limit by one tick.
+  * The S-curve of an axis is planned from its current position and velocity
+  * when its mode or target changes, and then evaluated at the time since.
+  * Called from motorSimTask() with the lock held, after processRoutes().
+  * \param[in] delta Time since the last tick in seconds. */
+void motorSimController::processScurve(double delta)
+{
+  motorSimScurve *pScurve;
+  int axis;
+  scurve_status_t status;
+
+  for (axis=0; axis<numAxes_; axis++) {
+    if (jerk_[axis] <= 0) continue;
+    pScurve = &scurve_[axis];
+    if ((mode_[axis] != SIM_POSITION) && (mode_[axis] != SIM_VELOCITY)) {
+      pScurve->mode = mode_[axis];
+      continue;
+    }
+    if ((mode_[axis] != pScurve->mode) || (target_[axis] != pScurve->target)) {
+      if (mode_[axis] == SIM_POSITION)
+        status = scurvePlan(&pScurve->plan, position_[axis], velocity_[axis], target_[axis],
+                            maxVelocity_[axis], acceleration_[axis], jerk_[axis]);
+      else
+        status = scurveVelocity(&pScurve->plan, position_[axis], velocity_[axis], target_[axis],
+                                acceleration_[axis], jerk_[axis]);
+      if (status != SCURVE__OK) {
+        asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+                  "%s:processScurve: port %s, axis %d, invalid S-curve limits, using trapezoidal motion\n",
+                  driverName, this->portName, axis);
+        jerk_[axis] = 0.0;
+        continue;
+      }
+      pScurve->mode = mode_[axis];
+      pScurve->target = target_[axis];
+      pScurve->time = 0.0;
+    }
+    pScurve->time += delta;
+    scurveEval(&pScurve->plan, pScurve->time, &position_[axis], &velocity_[axis], NULL);
+  }
+}
+
 void motorSimController::motorSimTask()
 {
   epicsTimeStamp now;
   double delta;
+  double nowSecs;
   int axis;
-  motorSimAxis *pAxis;
 
   while ( 1 )
   {
-    /* Get a new timestamp */
+    /* Get a new timestamp.  Take it with the lock held, because simulateComms()
+     * holds the lock for the simulated latency */
+    this->lock();
     epicsTimeGetCurrent( &now );
     delta = epicsTimeDiffInSeconds( &now, &(prevTime_) );
     prevTime_ = now;
 
-    if ( delta > (DELTA/4.0) && delta <= (4.0*DELTA) )
+    if ( delta > (tickPeriod_/4.0) && delta <= (4.0*tickPeriod_ + 0.1 + commsDelay_) )
     {
       /* A reasonable time has elapsed, it's not a time step in the clock */
+      nowSecs = now.secPastEpoch + (now.nsec / 1.e9);
+      processRoutes(delta);
+      processScurve(delta);
+      processProfile(delta);
       for (axis=0; axis<numAxes_; axis++) 
       {     
-        this->lock();
-        pAxis = getAxis(axis);
-        pAxis->process(delta );
-        this->unlock();
+        getAxis(axis)->process(nowSecs);
       }
     }
-    epicsThreadSleep( DELTA );
+    commsDelay_ = 0.0;
+    this->unlock();
+    epicsThreadSleep( tickPeriod_ );
   }
 }
 
+/** Starts a move to a position, in controller coordinates without the encoder offset */
+void motorSimAxis::setTarget(double position)
+{
+  pC_->mode_[axisNo_] = SIM_POSITION;
+  pC_->target_[axisNo_] = position;
+  pC_->startRoute(axisNo_);
+  needsUpdate_ = 1;
+}
+
 asynStatus motorSimAxis::move(double position, int relative, double minVelocity, double maxVelocity, double acceleration)
 {
-  route_pars_t pars;
+  double currentPosition = pC_->position_[axisNo_];
+  asynStatus commsStatus;
   static const char *functionName = "move";
 
-  if (relative) position += endpoint_.axis[0].p + enc_offset_;
+  commsStatus = pC_->simulateComms(pasynUser_, SIM_OPERATION_MOVE);
+  if (commsStatus == asynError) return asynError;
+
+  if (relative) {
+    if (pC_->mode_[axisNo_] == SIM_POSITION) position += pC_->target_[axisNo_] + enc_offset_;
+    else                                     position += currentPosition + enc_offset_;
+  }
 
   /* Check to see if in hard limits */
-  if ((nextpoint_.axis[0].p >= hiHardLimit_  &&  position > nextpoint_.axis[0].p) ||
-    (nextpoint_.axis[0].p <= lowHardLimit_ &&  position < nextpoint_.axis[0].p)  ) return asynError;
+  if ((currentPosition >= hiHardLimit_  &&  position > currentPosition) ||
+    (currentPosition <= lowHardLimit_ &&  position < currentPosition)  ) return asynError;
 
+  if (maxVelocity != 0) pC_->maxVelocity_[axisNo_] = fabs(maxVelocity);
+  if (acceleration != 0) pC_->acceleration_[axisNo_] = fabs(acceleration);
   if (pC_->movesDeferred_ == 0) { /*Normal move.*/
-    endpoint_.axis[0].p = position - enc_offset_;
-    endpoint_.axis[0].v = 0.0;
+    setTarget(position - enc_offset_);
   } else { /*Deferred moves.*/
     deferred_position_ = position;
     deferred_move_ = 1;
     deferred_relative_ = relative;
   }
-  routeGetParams(route_, &pars);
-  if (maxVelocity != 0) pars.axis[0].Vmax = fabs(maxVelocity);
-  if (acceleration != 0) pars.axis[0].Amax = fabs(acceleration);
-  routeSetParams( route_, &pars ); 
 
   setIntegerParam(pC_->motorStatusDone_, 0);
   callParamCallbacks();
@@ -299,29 +1121,22 @@ asynStatus motorSimAxis::move(double position, int relative, double minVelocity,
   asynPrint(pasynUser_, ASYN_TRACE_FLOW, 
             "%s:%s: Set driver %s, axis %d move to %f, min vel=%f, maxVel=%f, accel=%f\n",
             driverName, functionName, pC_->portName, axisNo_, position, minVelocity, maxVelocity, acceleration );
-  return asynSuccess;
+  return commsStatus;
 }
 
 asynStatus motorSimAxis::setVelocity(double velocity, double acceleration )
 {
-  route_pars_t pars;
-  double deltaV = velocity - this->nextpoint_.axis[0].v;        
-  double time;
+  double currentPosition = pC_->position_[axisNo_];
 
   /* Check to see if in hard limits */
-  if ((this->nextpoint_.axis[0].p > hiHardLimit_ && velocity > 0) ||
-      (this->nextpoint_.axis[0].p < lowHardLimit_ && velocity < 0)  ) return asynError;
-
-  routeGetParams( this->route_, &pars );
-  if (acceleration != 0) pars.axis[0].Amax = fabs(acceleration);
-  routeSetParams( this->route_, &pars );
-
-  time = fabs( deltaV / pars.axis[0].Amax );
-
-  this->endpoint_.axis[0].v = velocity;
-  this->endpoint_.axis[0].p = (this->nextpoint_.axis[0].p +
-                              time * ( this->nextpoint_.axis[0].v + 0.5 * deltaV));
-  this->reroute_ = ROUTE_NEW_ROUTE;
+  if ((currentPosition > hiHardLimit_ && velocity > 0) ||
+      (currentPosition < lowHardLimit_ && velocity < 0)  ) return asynError;
+
+  if (acceleration != 0) pC_->acceleration_[axisNo_] = fabs(acceleration);
+  pC_->mode_[axisNo_] = SIM_VELOCITY;
+  pC_->target_[axisNo_] = velocity;
+  pC_->startRoute(axisNo_);
+  needsUpdate_ = 1;
   return asynSuccess;
 }
 
@@ -329,36 +1144,51 @@ asynStatus motorSimAxis::setVelocity(double velocity, double acceleration )
 asynStatus motorSimAxis::home(double minVelocity, double maxVelocity, double acceleration, int forwards )
 {
   asynStatus status = asynError;
+  asynStatus commsStatus;
   // static const char *functionName = "home";
 
+  commsStatus = pC_->simulateComms(pasynUser_, SIM_OPERATION_MOVE);
+  if (commsStatus == asynError) return asynError;
   status = setVelocity((forwards? maxVelocity: -maxVelocity), acceleration );
   homing_ = 1;
-  return status;
+  return status ? status : commsStatus;
 }
 
 
 asynStatus motorSimAxis::moveVelocity(double minVelocity, double velocity, double acceleration )
 {
   asynStatus status = asynError;
+  asynStatus commsStatus;
   // static const char *functionName = "moveVelocity";
 
+  commsStatus = pC_->simulateComms(pasynUser_, SIM_OPERATION_MOVE);
+  if (commsStatus == asynError) return asynError;
   status = setVelocity(velocity, acceleration );
-  return status;
+  return status ? status : commsStatus;
 }
 
 asynStatus motorSimAxis::stop(double acceleration )
 {
+  asynStatus commsStatus;
   // static const char *functionName = "moveVelocityAxis";
 
+  commsStatus = pC_->simulateComms(pasynUser_, SIM_OPERATION_STOP);
+  if (commsStatus == asynError) return asynError;
   setVelocity(0.0, acceleration );
   deferred_move_ = 0;
-  return asynSuccess;
+  return commsStatus;
 }
 
 asynStatus motorSimAxis::setPosition(double position)
 {
-  enc_offset_ = position - nextpoint_.axis[0].p;
-  return asynSuccess;
+  asynStatus commsStatus;
+
+  commsStatus = pC_->simulateComms(pasynUser_, SIM_OPERATION_MOVE);
+  if (commsStatus == asynError) return asynError;
+  enc_offset_ = position - pC_->position_[axisNo_];
+  needsUpdate_ = 1;
+  nextIdlePoll_ = 0.0;
+  return commsStatus;
 }
 
 asynStatus motorSimAxis::config(int hiHardLimit, int lowHardLimit, int home, int start)
@@ -367,71 +1197,118 @@ asynStatus motorSimAxis::config(int hiHardLimit, int lowHardLimit, int home, int
   lowHardLimit_ = lowHardLimit;
   home_ = home;
   enc_offset_ = start;
+  needsUpdate_ = 1;
+  nextIdlePoll_ = 0.0;
   return asynSuccess;
 }
 
-asynStatus motorSimAxis::poll(bool *moving)
+asynStatus motorSimAxis::initializeProfile(size_t maxPoints)
 {
+  asynMotorAxis::initializeProfile(maxPoints);
+  if (profileKnotPositions_)  free(profileKnotPositions_);
+  profileKnotPositions_ =  (double *)calloc(maxPoints+2, sizeof(double));
+  if (profileKnotVelocities_) free(profileKnotVelocities_);
+  profileKnotVelocities_ = (double *)calloc(maxPoints+2, sizeof(double));
+  if (profileSimReadbacks_)   free(profileSimReadbacks_);
+  profileSimReadbacks_ =   (double *)calloc(maxPoints, sizeof(double));
+  if (profileSimErrors_)      free(profileSimErrors_);
+  profileSimErrors_ =      (double *)calloc(maxPoints, sizeof(double));
   return asynSuccess;
 }
 
+/** Polls the axis.
+  * Called by the asynMotorController poller.  The simulation thread advances the
+  * motion; this reads the state it left, after the simulated poll latency.  A poll
+  * that fails or loses its reply leaves the previous status in place.
+  * The poller runs at the tick period while any axis moves; an idle axis whose
+  * done status has been published is only polled at the idle poll period.
+  * \param[out] moving Set if the axis is moving. */
+asynStatus motorSimAxis::poll(bool *moving)
+{
+  asynStatus status;
+  double position, velocity;
+  epicsTimeStamp now;
+  double nowSecs;
 
-/** Process one iteration of an axis
+  epicsTimeGetCurrent(&now);
+  nowSecs = now.secPastEpoch + (now.nsec / 1.e9);
+  if ((pC_->mode_[axisNo_] == SIM_IDLE) && lastDone_ && polledDone_ && (nowSecs < nextIdlePoll_)) {
+    *moving = false;
+    return asynSuccess;
+  }
+  nextIdlePoll_ = nowSecs + pC_->idlePollPeriod_;
+
+  status = pC_->simulateComms(pasynUser_, SIM_OPERATION_POLL);
+  *moving = (pC_->mode_[axisNo_] != SIM_IDLE) || (lastDone_ == 0);
+  setIntegerParam(pC_->motorStatusCommsError_, status ? 1 : 0);
+  if (status == asynSuccess) {
+    /* Position and velocity are those at the time the poll was answered */
+    position = pC_->position_[axisNo_];
+    velocity = pC_->velocity_[axisNo_];
+    setDoubleParam (pC_->motorPosition_,         (position+enc_offset_));
+    setDoubleParam (pC_->motorEncoderPosition_,  (position+enc_offset_));
+    setIntegerParam(pC_->motorStatusDirection_,  (velocity >  0));
+    setIntegerParam(pC_->motorStatusDone_,       lastDone_);
+    setIntegerParam(pC_->motorStatusHighLimit_,  (position >= hiHardLimit_));
+    setIntegerParam(pC_->motorStatusHome_,       (position == home_));
+    setIntegerParam(pC_->motorStatusMoving_,     !lastDone_);
+    setIntegerParam(pC_->motorStatusLowLimit_,   (position <= lowHardLimit_));
+    polledDone_ = lastDone_;
+  }
+  callParamCallbacks();
+  return status;
+}
 
-  This routine takes a single axis and propogates its motion forward a given amount
-  of time.
 
-  \param delta  [in]   Time in seconds to propogate motion forwards.
+/** Process one iteration of an axis
+
+  This routine is called for each axis after processRoutes() has propagated
+  the motion of all axes forward by one tick.  It handles the limits and home
+  switch, and works out whether the move is done.  The status is published by
+  poll().  Idle axes that are already done are skipped.
 
-  \return Integer indicating 0 (asynSuccess) for success or non-zero for failure. 
+  \param nowSecs  [in]   Time of this tick in seconds.
 */
 
-void motorSimAxis::process(double delta )
+void motorSimAxis::process(double nowSecs)
 {
-  double lastpos;
+  int *mode = &pC_->mode_[axisNo_];
+  double *target = &pC_->target_[axisNo_];
+  double position = pC_->position_[axisNo_];
+  double lastpos = pC_->lastPosition_[axisNo_];
+  double velocity = pC_->velocity_[axisNo_];
   int done = 0;
   double postMoveDelay = 0.0;
-  epicsTimeStamp nowTime;
-  double nowTimeSecs = 0.0;
 
-  lastpos = nextpoint_.axis[0].p;
-  nextpoint_.T += delta;
-  routeFind( route_, reroute_, &endpoint_, &nextpoint_ );
-  /*  if (reroute_ == ROUTE_NEW_ROUTE) routePrint( route_, reroute_, &endpoint_, &nextpoint_, stdout ); */
-  reroute_ = ROUTE_CALC_ROUTE;
+  if ((*mode == SIM_IDLE) && !needsUpdate_ && !delayedDone_ && lastDone_) return;
+  needsUpdate_ = 0;
 
   /* No, do a limits check */
   if (homing_ && 
-    ((lastpos - home_) * (nextpoint_.axis[0].p - home_)) <= 0)
+    ((lastpos - home_) * (position - home_)) <= 0)
   {
     /* Homing and have crossed the home sensor - return to home */
     homing_ = 0;
-    reroute_ = ROUTE_NEW_ROUTE;
-    endpoint_.axis[0].p = home_;
-    endpoint_.axis[0].v = 0.0;
+    setTarget(home_);
   }
-  if ( nextpoint_.axis[0].p > hiHardLimit_ && nextpoint_.axis[0].v > 0 )
+  if ( position > hiHardLimit_ && velocity > 0 )
   {
-    if (homing_) setVelocity(-endpoint_.axis[0].v, 0.0 );
-    else
-    {
-      reroute_ = ROUTE_NEW_ROUTE;
-      endpoint_.axis[0].p = hiHardLimit_;
-      endpoint_.axis[0].v = 0.0;
-    }
+    if (homing_) setVelocity(-(*target), 0.0 );
+    else         setTarget(hiHardLimit_);
   }
-  else if (nextpoint_.axis[0].p < lowHardLimit_ && nextpoint_.axis[0].v < 0)
+  else if (position < lowHardLimit_ && velocity < 0)
   {
-    if (homing_) setVelocity(-endpoint_.axis[0].v, 0.0 );
-    else
-    {
-      reroute_ = ROUTE_NEW_ROUTE;
-      endpoint_.axis[0].p = lowHardLimit_;
-      endpoint_.axis[0].v = 0.0;
-    }
+    if (homing_) setVelocity(-(*target), 0.0 );
+    else         setTarget(lowHardLimit_);
   }
 
-  if (nextpoint_.axis[0].v ==  0) {
+  /* The move is complete when the axis has stopped at its target or velocity */
+  if ((velocity == 0) &&
+      ((*mode == SIM_VELOCITY && *target == 0) || (*mode == SIM_POSITION && position == *target))) {
+    *mode = SIM_IDLE;
+  }
+
+  if (*mode == SIM_IDLE) {
     if (!deferred_move_) {
       if (!delayedDone_) {
 	done = 1;
@@ -442,40 +1319,28 @@ void motorSimAxis::process(double delta )
   }
 
   //Post move delay
-  epicsTimeGetCurrent(&nowTime);
-  pC_->getDoubleParam(axisNo_, pC_->motorPostMoveDelay_, &postMoveDelay);
   if ((lastDone_ == 0) && (done == 1)) {
+    pC_->getDoubleParam(axisNo_, pC_->motorPostMoveDelay_, &postMoveDelay);
     if (postMoveDelay > 0) {
       delayedDone_ = 1;
       done = 0;
-      lastTimeSecs_ = nowTime.secPastEpoch + (nowTime.nsec / 1.e9);
+      lastTimeSecs_ = nowSecs + postMoveDelay;
     }
   }
   if (delayedDone_ == 1) {
-    nowTimeSecs = nowTime.secPastEpoch + (nowTime.nsec / 1.e9);
-    if ((nowTimeSecs - lastTimeSecs_) >= postMoveDelay) {
+    if (nowSecs >= lastTimeSecs_) {
       done = 1;
       delayedDone_ = 0;
     }
   }
 
   lastDone_ = done;
-
-  setDoubleParam (pC_->motorPosition_,         (nextpoint_.axis[0].p+enc_offset_));
-  setDoubleParam (pC_->motorEncoderPosition_,  (nextpoint_.axis[0].p+enc_offset_));
-  setIntegerParam(pC_->motorStatusDirection_,  (nextpoint_.axis[0].v >  0));
-  setIntegerParam(pC_->motorStatusDone_,       done);
-  setIntegerParam(pC_->motorStatusHighLimit_,  (nextpoint_.axis[0].p >= hiHardLimit_));
-  setIntegerParam(pC_->motorStatusHome_,       (nextpoint_.axis[0].p == home_));
-  setIntegerParam(pC_->motorStatusMoving_,     !done);
-  setIntegerParam(pC_->motorStatusLowLimit_,   (nextpoint_.axis[0].p <= lowHardLimit_));
-  callParamCallbacks();
 }
 
 /** Configuration command, called directly or from iocsh */
-extern "C" int motorSimCreateController(const char *portName, int numAxes, int priority, int stackSize)
+extern "C" int motorSimCreateController(const char *portName, int numAxes, int priority, int stackSize, int tickRate)
 {
-  new motorSimController(portName,numAxes, priority, stackSize);
+  new motorSimController(portName,numAxes, priority, stackSize, tickRate);
   return(asynSuccess);
 }
 
@@ -504,19 +1369,90 @@ extern "C" int motorSimConfigAxis(const char *portName, int axis, int hiHardLimi
   return(-1);
 }
 
+/** Returns the controller with this port name, or NULL if there is none */
+static motorSimController *findMotorSimController(const char *portName)
+{
+  motorSimControllerNode *pNode;
+
+  if (!motorSimControllerListInitialized) return NULL;
+  pNode = (motorSimControllerNode*)ellFirst(&motorSimControllerList);
+  while(pNode) {
+    if (strcmp(pNode->portName, portName) == 0) return pNode->pController;
+    pNode = (motorSimControllerNode*)ellNext((ELLNODE*)pNode);
+  }
+  return NULL;
+}
+
+extern "C" int motorSimCreateProfile(const char *portName, int maxPoints)
+{
+  motorSimController *pC = findMotorSimController(portName);
+
+  if (!pC) {
+    printf("%s:motorSimCreateProfile: ERROR, controller %s not found\n", driverName, portName);
+    return(-1);
+  }
+  pC->lock();
+  pC->initializeProfile(maxPoints);
+  pC->unlock();
+  return(0);
+}
+
+extern "C" int motorSimConfigLatency(const char *portName, double moveLatency, double pollLatency,
+                                     double stopLatency, double jitter, int distribution)
+{
+  motorSimController *pC = findMotorSimController(portName);
+
+  if (!pC) {
+    printf("%s:motorSimConfigLatency: ERROR, controller %s not found\n", driverName, portName);
+    return(-1);
+  }
+  pC->configLatency(moveLatency, pollLatency, stopLatency, jitter, distribution);
+  return(0);
+}
+
+extern "C" int motorSimConfigFaults(const char *portName, double dropRate, double errorRate,
+                                    int errorBurst, double timeout, int seed)
+{
+  motorSimController *pC = findMotorSimController(portName);
+
+  if (!pC) {
+    printf("%s:motorSimConfigFaults: ERROR, controller %s not found\n", driverName, portName);
+    return(-1);
+  }
+  pC->configFaults(dropRate, errorRate, errorBurst, timeout, seed);
+  return(0);
+}
+
+extern "C" int motorSimConfigJerk(const char *portName, int axis, double jerk)
+{
+  motorSimController *pC = findMotorSimController(portName);
+
+  if (!pC) {
+    printf("%s:motorSimConfigJerk: ERROR, controller %s not found\n", driverName, portName);
+    return(-1);
+  }
+  if (pC->configJerk(axis, jerk) != asynSuccess) {
+    printf("%s:motorSimConfigJerk: ERROR, invalid axis %d or jerk %f\n", driverName, axis, jerk);
+    return(-1);
+  }
+  return(0);
+}
+
 /** Code for iocsh registration */
 static const iocshArg motorSimCreateControllerArg0 = {"Port name", iocshArgString};
 static const iocshArg motorSimCreateControllerArg1 = {"Number of axes", iocshArgInt};
 static const iocshArg motorSimCreateControllerArg2 = {"priority", iocshArgInt};
 static const iocshArg motorSimCreateControllerArg3 = {"stackSize", iocshArgInt};
+static const iocshArg motorSimCreateControllerArg4 = {"Tick rate (Hz)", iocshArgInt};
 static const iocshArg * const motorSimCreateControllerArgs[] =  {&motorSimCreateControllerArg0,
                                                                  &motorSimCreateControllerArg1,
                                                                  &motorSimCreateControllerArg2,
-                                                                 &motorSimCreateControllerArg3};
-static const iocshFuncDef motorSimCreateControllerDef = {"motorSimCreateController", 4, motorSimCreateControllerArgs};
+                                                                 &motorSimCreateControllerArg3,
+                                                                 &motorSimCreateControllerArg4};
+static const iocshFuncDef motorSimCreateControllerDef = {"motorSimCreateController", 5, motorSimCreateControllerArgs};
 static void motorSimCreateContollerCallFunc(const iocshArgBuf *args)
 {
-  motorSimCreateController(args[0].sval, args[1].ival, args[2].ival, args[3].ival);
+  motorSimCreateController(args[0].sval, args[1].ival, args[2].ival, args[3].ival, args[4].ival);
 }
 
 static const iocshArg motorSimConfigAxisArg0 = { "Post name",     iocshArgString};
@@ -541,11 +1477,73 @@ static void motorSimConfigAxisCallFunc(const iocshArgBuf *args)
   motorSimConfigAxis(args[0].sval, args[1].ival, args[2].ival, args[3].ival, args[4].ival, args[5].ival);
 }
 
+static const iocshArg motorSimCreateProfileArg0 = {"Port name", iocshArgString};
+static const iocshArg motorSimCreateProfileArg1 = {"Max points", iocshArgInt};
+static const iocshArg * const motorSimCreateProfileArgs[] = {&motorSimCreateProfileArg0,
+                                                             &motorSimCreateProfileArg1};
+static const iocshFuncDef motorSimCreateProfileDef = {"motorSimCreateProfile", 2, motorSimCreateProfileArgs};
+static void motorSimCreateProfileCallFunc(const iocshArgBuf *args)
+{
+  motorSimCreateProfile(args[0].sval, args[1].ival);
+}
+
+static const iocshArg motorSimConfigLatencyArg0 = {"Port name", iocshArgString};
+static const iocshArg motorSimConfigLatencyArg1 = {"Move latency (s)", iocshArgDouble};
+static const iocshArg motorSimConfigLatencyArg2 = {"Poll latency (s)", iocshArgDouble};
+static const iocshArg motorSimConfigLatencyArg3 = {"Stop latency (s)", iocshArgDouble};
+static const iocshArg motorSimConfigLatencyArg4 = {"Jitter (s)", iocshArgDouble};
+static const iocshArg motorSimConfigLatencyArg5 = {"Distribution (0=uniform, 1=exponential)", iocshArgInt};
+static const iocshArg * const motorSimConfigLatencyArgs[] = {&motorSimConfigLatencyArg0,
+                                                             &motorSimConfigLatencyArg1,
+                                                             &motorSimConfigLatencyArg2,
+                                                             &motorSimConfigLatencyArg3,
+                                                             &motorSimConfigLatencyArg4,
+                                                             &motorSimConfigLatencyArg5};
+static const iocshFuncDef motorSimConfigLatencyDef = {"motorSimConfigLatency", 6, motorSimConfigLatencyArgs};
+static void motorSimConfigLatencyCallFunc(const iocshArgBuf *args)
+{
+  motorSimConfigLatency(args[0].sval, args[1].dval, args[2].dval, args[3].dval, args[4].dval, args[5].ival);
+}
+
+static const iocshArg motorSimConfigFaultsArg0 = {"Port name", iocshArgString};
+static const iocshArg motorSimConfigFaultsArg1 = {"Drop rate", iocshArgDouble};
+static const iocshArg motorSimConfigFaultsArg2 = {"Error rate", iocshArgDouble};
+static const iocshArg motorSimConfigFaultsArg3 = {"Error burst length", iocshArgInt};
+static const iocshArg motorSimConfigFaultsArg4 = {"Timeout (s)", iocshArgDouble};
+static const iocshArg motorSimConfigFaultsArg5 = {"Seed", iocshArgInt};
+static const iocshArg * const motorSimConfigFaultsArgs[] = {&motorSimConfigFaultsArg0,
+                                                            &motorSimConfigFaultsArg1,
+                                                            &motorSimConfigFaultsArg2,
+                                                            &motorSimConfigFaultsArg3,
+                                                            &motorSimConfigFaultsArg4,
+                                                            &motorSimConfigFaultsArg5};
+static const iocshFuncDef motorSimConfigFaultsDef = {"motorSimConfigFaults", 6, motorSimConfigFaultsArgs};
+static void motorSimConfigFaultsCallFunc(const iocshArgBuf *args)
+{
+  motorSimConfigFaults(args[0].sval, args[1].dval, args[2].dval, args[3].ival, args[4].dval, args[5].ival);
+}
+
+static const iocshArg motorSimConfigJerkArg0 = {"Port name", iocshArgString};
+static const iocshArg motorSimConfigJerkArg1 = {"Axis #", iocshArgInt};
+static const iocshArg motorSimConfigJerkArg2 = {"Jerk (steps/s^3, 0=trapezoidal)", iocshArgDouble};
+static const iocshArg * const motorSimConfigJerkArgs[] = {&motorSimConfigJerkArg0,
+                                                          &motorSimConfigJerkArg1,
+                                                          &motorSimConfigJerkArg2};
+static const iocshFuncDef motorSimConfigJerkDef = {"motorSimConfigJerk", 3, motorSimConfigJerkArgs};
+static void motorSimConfigJerkCallFunc(const iocshArgBuf *args)
+{
+  motorSimConfigJerk(args[0].sval, args[1].ival, args[2].dval);
+}
+
 static void motorSimDriverRegister(void)
 {
 
   iocshRegister(&motorSimCreateControllerDef, motorSimCreateContollerCallFunc);
   iocshRegister(&motorSimConfigAxisDef, motorSimConfigAxisCallFunc);
+  iocshRegister(&motorSimCreateProfileDef, motorSimCreateProfileCallFunc);
+  iocshRegister(&motorSimConfigLatencyDef, motorSimConfigLatencyCallFunc);
+  iocshRegister(&motorSimConfigFaultsDef, motorSimConfigFaultsCallFunc);
+  iocshRegister(&motorSimConfigJerkDef, motorSimConfigJerkCallFunc);
 }
 
 extern "C" {
@@ -15,9 +15,59 @@ March 28, 2010
 
 #include "asynMotorController.h"
 #include "asynMotorAxis.h"
+#include "scurve.h"
 #include "route.h"
 
-#define NUM_SIM_CONTROLLER_PARAMS 0
+/* Controller parameters for latency and fault injection */
+#define motorSimMoveLatencyString  "SIM_MOVE_LATENCY"
+#define motorSimPollLatencyString  "SIM_POLL_LATENCY"
+#define motorSimStopLatencyString  "SIM_STOP_LATENCY"
+#define motorSimJitterString       "SIM_JITTER"
+#define motorSimLatencyDistString  "SIM_LATENCY_DIST"
+#define motorSimDropRateString     "SIM_DROP_RATE"
+#define motorSimErrorRateString    "SIM_ERROR_RATE"
+#define motorSimErrorBurstString   "SIM_ERROR_BURST"
+#define motorSimTimeoutString      "SIM_TIMEOUT"
+#define motorSimSeedString         "SIM_SEED"
+#define motorSimNumCallsString     "SIM_NUM_CALLS"
+#define motorSimNumDroppedString   "SIM_NUM_DROPPED"
+#define motorSimNumErrorsString    "SIM_NUM_ERRORS"
+
+#define DEFAULT_TICK_RATE 10     /* Simulation ticks per second */
+#define MIN_TICK_RATE     1
+#define MAX_TICK_RATE     1000
+#define SIM_IDLE_POLL_PERIOD 0.5 /* Poller period when no axis is moving (s); moving polls use the tick period */
+
+#define SIM_PROFILE_LAG   0.001  /* Servo lag used to synthesize profile following errors (s) */
+
+/* Shapes of the simulated latency distribution */
+typedef enum {
+  SIM_LATENCY_UNIFORM,      /* Latency +/- jitter */
+  SIM_LATENCY_EXPONENTIAL   /* Latency plus an exponential tail with mean jitter */
+} motorSimLatencyDist;
+
+/* Kinds of simulated controller transactions, each with its own latency */
+typedef enum {
+  SIM_OPERATION_MOVE,
+  SIM_OPERATION_POLL,
+  SIM_OPERATION_STOP
+} motorSimOperation;
+
+/* Motion modes of a simulated axis */
+typedef enum {
+  SIM_IDLE,
+  SIM_POSITION,     /* Moving to a target position, on a route */
+  SIM_VELOCITY,     /* Moving at a target velocity, on a route */
+  SIM_PROFILE       /* Following a profile, driven by motorSimController::processProfile() */
+} motorSimMode;
+
+/* Jerk limited motion of an axis, advanced by motorSimController::processScurve() */
+typedef struct motorSimScurve {
+  scurve_t plan;   /**< Current plan, from the position and velocity when it was made */
+  double time;     /**< Time since the start of the plan */
+  int mode;        /**< Mode the plan was made for, the plan is remade when it changes */
+  double target;   /**< Target the plan was made for */
+} motorSimScurve;
 
 class epicsShareClass motorSimAxis : public asynMotorAxis
 {
@@ -31,54 +81,142 @@ public:
   asynStatus stop(double acceleration);
   asynStatus poll(bool *moving);
   asynStatus setPosition(double position);
+  asynStatus initializeProfile(size_t maxPoints);
 
   /* These are the methods that are new to this class */
   asynStatus config(int hiHardLimit, int lowHardLimit, int home, int start);
   asynStatus setVelocity(double velocity, double acceleration);
-  void process(double delta );
+  void setTarget(double position);
+  void process(double nowSecs);
 
 private:
   motorSimController *pC_;
-  ROUTE_ID route_;
-  route_reroute_t reroute_;
-  route_demand_t endpoint_;
-  route_demand_t nextpoint_;
   double lowHardLimit_;
   double hiHardLimit_;
   double enc_offset_;
   double home_;
   int homing_;
-  epicsTimeStamp tLast_;
   double deferred_position_;
   int deferred_move_;
   int deferred_relative_;
   double lastTimeSecs_;
   int delayedDone_;
   int lastDone_;
+  int needsUpdate_;      /**< Process the axis on the next tick even if it is idle */
+  double nextIdlePoll_;  /**< Time of the next poll while the axis is idle */
+  int polledDone_;       /**< Done status published by the last successful poll */
+
+  /* Profile trajectory, in controller coordinates without the encoder offset.
+   * Knot 0 and the last knot are the acceleration and deceleration points. */
+  double *profileKnotPositions_;
+  double *profileKnotVelocities_;
+  double profileOrigin_;  /**< Offset added to the knots when the profile is executed */
+  double *profileSimReadbacks_;    /**< Readbacks in controller units, before conversion by readbackProfile() */
+  double *profileSimErrors_;       /**< Following errors in controller units */
+  int profileUse_;        /**< Axis is used in the built profile */
   
 friend class motorSimController;
 };
 
-class epicsShareClass motorSimController : asynMotorController {
+class epicsShareClass motorSimController : public asynMotorController {
 public:
 
   /* These are the fucntions we override from the base class */
-  motorSimController(const char *portName, int numAxes, int priority, int stackSize);
+  motorSimController(const char *portName, int numAxes, int priority, int stackSize, int tickRate);
   asynStatus writeInt32(asynUser *pasynUser, epicsInt32 value);
   void report(FILE *fp, int level);
+  asynStatus poll();
   motorSimAxis* getAxis(asynUser *pasynUser);
   motorSimAxis* getAxis(int axisNo);
-  asynStatus profileMove(asynUser *pasynUser, int npoints, double positions[], double times[], int relative, int trigger);
-  asynStatus triggerProfile(asynUser *pasynUser);
+
+  /* These are the functions for profile moves */
+  asynStatus initializeProfile(size_t maxPoints);
+  asynStatus buildProfile();
+  asynStatus executeProfile();
+  asynStatus abortProfile();
+  asynStatus readbackProfile();
 
   /* These are the functions that are new to this class */
   void motorSimTask();  // Should be pivate, but called from non-member function
+  asynStatus configLatency(double moveLatency, double pollLatency, double stopLatency, double jitter, int distribution);
+  asynStatus configFaults(double dropRate, double errorRate, int errorBurst, double timeout, int seed);
+  asynStatus configJerk(int axis, double jerk);
+  asynStatus simulateComms(asynUser *pasynUser, int operation);
+
+protected:
+  #define FIRST_SIM_PARAM motorSimMoveLatency_
+  int motorSimMoveLatency_;
+  int motorSimPollLatency_;
+  int motorSimStopLatency_;
+  int motorSimJitter_;
+  int motorSimLatencyDist_;
+  int motorSimDropRate_;
+  int motorSimErrorRate_;
+  int motorSimErrorBurst_;
+  int motorSimTimeout_;
+  int motorSimSeed_;
+  int motorSimNumCalls_;
+  int motorSimNumDropped_;
+  int motorSimNumErrors_;
+  #define LAST_SIM_PARAM motorSimNumErrors_
 
 private:
   asynStatus processDeferredMoves();
+  void startRoute(int axis);
+  void processRoutes(double delta);
+  void processProfile(double delta);
+  void processScurve(double delta);
+  void profileSample(motorSimAxis *pAxis, double time, double *position, double *velocity);
+  void finishProfile(int status, const char *message);
+  double uniformRandom();
   epicsThreadId motorThread_;
   epicsTimeStamp prevTime_;
   int movesDeferred_;
+  double tickPeriod_;
+
+  /* Kinematic state of all axes, indexed by axis number, so that each tick
+   * advances every axis in a single pass over contiguous arrays */
+  int *mode_;            /**< motorSimMode of each axis */
+  double *position_;     /**< Current position, without the encoder offset */
+  double *lastPosition_; /**< Position at the previous tick */
+  double *velocity_;     /**< Current velocity */
+  double *target_;       /**< Target position in SIM_POSITION mode, target velocity in SIM_VELOCITY mode */
+  double *maxVelocity_;  /**< Maximum velocity for position moves */
+  double *acceleration_; /**< Acceleration */
+  double *jerk_;         /**< Maximum jerk of S-curve motion, 0 for trapezoidal motion */
+  motorSimScurve *scurve_; /**< S-curve plan of each axis with a jerk limit */
+
+  /* Route of each axis, as a batch of single axis routes advanced by processRoutes() */
+  ROUTE_BATCH_ID route_;
+  double simTime_;             /**< Time of the last tick, on the time scale of the routes */
+  int *routeValid_;            /**< The route starts from the current position and velocity */
+  route_reroute_t *reroute_;   /**< ROUTE_NEW_ROUTE when the end point has changed */
+  double *endT_;               /**< End point of each route */
+  double *endP_;
+  double *endV_;
+  double *nextT_;              /**< Demand of each route at the next tick */
+  double *nextP_;
+  double *nextV_;
+  route_status_t *routeStatus_;
+
+  /* Profile execution state, advanced by processProfile() on each tick */
+  double *profileKnotTimes_;   /**< Time of each knot from the start of the acceleration */
+  int profileNumKnots_;        /**< Number of knots in the built profile, 0 if none */
+  int profileExecuting_;       /**< ProfileExecuteState while a profile runs */
+  double profileTime_;         /**< Time since the start of the acceleration */
+  int profileKnot_;            /**< Knot at the start of the current segment */
+  double profilePulseStart_;   /**< Time of the first output pulse */
+  double profilePulsePeriod_;  /**< Time between output pulses */
+  int profilePulseTotal_;      /**< Number of pulses to output */
+  int profilePulseCount_;      /**< Number of pulses output so far */
+
+  /* Fault injection state */
+  epicsUInt32 randomState_;    /**< State of the random number generator, set from SIM_SEED */
+  int errorBurstRemaining_;    /**< Number of calls left in the current error burst */
+  double commsDelay_;          /**< Simulated latency since the last tick, during which the lock was held */
+  epicsInt32 numCalls_;        /**< Number of simulated calls, posted as SIM_NUM_CALLS by poll() */
+  double nextCountersPost_;    /**< Time at which poll() next posts SIM_NUM_CALLS */
   
 friend class motorSimAxis;
 };
+#define NUM_SIM_CONTROLLER_PARAMS ((int)(&LAST_SIM_PARAM - &FIRST_SIM_PARAM + 1))
@@ -2,30 +2,81 @@
 #include <float.h>
 #include <stdio.h>     /* For definition of the NULL pointer! */
 #include <stdlib.h>    /* For definition of malloc            */
+#include <string.h>
 #include <route.h>
 
 #define LOCAL static
 
-typedef struct path_str
+/* Tells the compiler that the arrays of routeDemandKernel do not overlap */
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define RESTRICT __restrict
+#else
+#define RESTRICT
+#endif
+
+typedef route_path_t path_t;
+
+/* The state of one route as seen by routeFindPaths, so that the same path finding
+   serves a route_t and a route of a batch.  The positions and velocities of axis j
+   are element j*stride of their arrays. */
+typedef struct route_view_str
 {
-    double dist;
-    double vi;
-    double vf;
-    double v2;
-    double t1;
-    double t2;
-    double t3;
-    double t4;
-    double T;
-} path_t;
-
-typedef struct route_str
+    unsigned int numRoutedAxes;       /* Number of axes to be routed              */
+    const int * routedAxisList;       /* Axis number + 1 of each routed axis, or
+                                         NULL if axes 0 to numRoutedAxes-1 are     */
+    const route_axis_pars_t * axis;   /* Limits of each axis                      */
+    double Tsync;                     /* As in route_pars_t                       */
+    double Tcoast;
+    path_t * path;                    /* Path of each axis                        */
+    unsigned int stride;
+    double * demandT;                 /* Last demand                              */
+    double * demandP;
+    double * demandV;
+    double lastEndT;                  /* Endpoint of the last call                */
+    const double * lastEndP;
+    const double * lastEndV;
+    const double * endP;              /* Endpoint of this call                    */
+    const double * endV;
+    int recalculated;                 /* Set if the paths were recalculated       */
+} route_view_t;
+
+#define VIEW_AXIS(view, i) ((view)->routedAxisList ? (view)->routedAxisList[i] - 1 : (int) (i))
+
+/* A batch of routes, see routeBatchNew.  Element r*numAxes + a of the arrays of
+   size n is axis a of route r. */
+struct route_batch_str
 {
-    route_pars_t   pars;
-    route_demand_t demand;
-    path_t path[NUM_AXES];
-    route_demand_t endp;
-} route_t;
+    unsigned int numRoutes;
+    unsigned int numAxes;
+    unsigned int n;                   /* numRoutes*numAxes                        */
+    double Tsync;
+    double Tcoast;
+    route_axis_pars_t * axis;         /* n limits                                 */
+    path_t * path;                    /* n paths, for path finding                */
+    double * vi;                      /* n copies of each path member, and of     */
+    double * v2;                      /* the terms of routeDemand that depend     */
+    double * vf;                      /* only on the path, for routeDemandKernel  */
+    double * t1;
+    double * t2;
+    double * t3;
+    double * t4;
+    double * accel1;
+    double * accel2;
+    double * p1;
+    double * p2;
+    double * p3;
+    double * a0;
+    double * demandT;                 /* numRoutes times of the last demands      */
+    double * demandP;                 /* n last demands                           */
+    double * demandV;
+    double * lastEndT;                /* numRoutes times of the last endpoints    */
+    double * lastEndP;                /* n last endpoints                         */
+    double * lastEndV;
+    double * t;                       /* n times relative to the endpoints        */
+    int * failed;                     /* numRoutes flags for routeBatchFind       */
+};
+
+LOCAL route_status_t routeFindPaths( route_view_t *, route_reroute_t, double *, double, route_status_t * );
 
 typedef enum
 {
@@ -165,6 +216,138 @@ LOCAL route_status_t routeDemand(path_t * path, double t, route_axis_demand_t *
 }
 
 
+/*+                      r o u t e D e m a n d K e r n e l
+  
+   Function Name: routeDemandKernel
+  
+   Function: Returns the position and velocity for particular times on n paths.
+ 
+   Description:
+      This function does what routeDemand does, for n paths at once.  The paths
+      are given as separate arrays of their members, and of the accelerations and
+      positions that routeDemand calculates from them, which routeBatchSavePath
+      fills in when a path changes.  t is relative to the end of each path
+      (normally t <= 0).  Every phase of the path is evaluated and the right one
+      selected without branches, so that the loop is vectorized.  The results
+      are the same as those of routeDemand.
+ 
+   Call:
+      routeDemandKernel( n, t, vi, v2, vf, t1, t2, t3, t4, accel1, accel2,
+                         p1, p2, p3, a0, endp, p, v )
+  
+   Parameters:
+      ("<" input, "!" modified, "W" workspace, ">" output)
+
+      (<) n        (unsigned int)  Number of paths.
+      (<) t        (double *)      Times at which to find the position and velocity
+      (<) vi .. t4 (double *)      Path members, see route_path_t.
+      (<) accel1   (double *)      Accelerations in the first and third phases.
+      (<) accel2   (double *)
+      (<) p1 .. p3 (double *)      Positions at the end of the first three phases,
+                                   relative to the end of the path.
+      (<) a0       (double *)      Distance covered in the second phase at the
+                                   mean of vi and v2, as routeDemand has it.
+      (<) endp     (double *)      Position at the end of each path.
+      (>) p        (double *)      Positions at time t.
+      (>) v        (double *)      Velocities at time t.
+
+*-
+
+   History:
+*/
+
+LOCAL void routeDemandKernel( unsigned int n, const double * RESTRICT t,
+                              const double * RESTRICT vi, const double * RESTRICT v2,
+                              const double * RESTRICT vf, const double * RESTRICT t1,
+                              const double * RESTRICT t2, const double * RESTRICT t3,
+                              const double * RESTRICT t4, const double * RESTRICT accel1,
+                              const double * RESTRICT accel2, const double * RESTRICT p1,
+                              const double * RESTRICT p2, const double * RESTRICT p3,
+                              const double * RESTRICT a0, const double * RESTRICT endp,
+                              double * RESTRICT p, double * RESTRICT v )
+{
+    unsigned int k;
+
+    for (k = 0; k < n; k++)
+    {
+        /* Time into each phase, counted back from its end */
+        double u3 = t[k] + t4[k];
+        double u2 = u3 + t3[k];
+        double u1 = u2 + t2[k];
+
+        double vel3 = vf[k] + accel2[k] * u3;
+        double vel1 = v2[k] + accel1[k] * u1;
+
+        double pos4 = vf[k] * t[k];
+        double pos3 = p3[k] + 0.5 * (vel3 + vf[k]) * u3;
+        double pos2 = p2[k] + v2[k] * u2;
+        double pos1 = p1[k] + 0.5 * (vel1 + v2[k]) * u1;
+        double pos0 = p1[k] + (a0[k] + (u1 + t1[k]) * vi[k]);
+
+        /* Select the phase, starting with the earliest */
+        double vel = vi[k], pos = pos0;
+
+        vel = (u1 >= -t1[k]) ? vel1 : vel;
+        pos = (u1 >= -t1[k]) ? pos1 : pos;
+        vel = (u2 >= -t2[k]) ? v2[k] : vel;
+        pos = (u2 >= -t2[k]) ? pos2 : pos;
+        vel = (u3 >= -t3[k]) ? vel3 : vel;
+        pos = (u3 >= -t3[k]) ? pos3 : pos;
+        vel = (t[k] >= -t4[k]) ? vf[k] : vel;
+        pos = (t[k] >= -t4[k]) ? pos4 : pos;
+        v[k] = vel;
+        p[k] = pos + endp[k];
+    }
+}
+
+
+/*+                      r o u t e B a t c h S a v e P a t h
+  
+   Function Name: routeBatchSavePath
+  
+   Function: Copies a path of a batch for routeDemandKernel
+ 
+   Description:
+      This function copies path k of a batch into the arrays used by
+      routeDemandKernel, with the terms that routeDemand calculates from it,
+      calculated in the same way.
+ 
+   Call:
+      routeBatchSavePath( batch, k )
+  
+   Parameters:
+      ("<" input, "!" modified, "W" workspace, ">" output)
+
+      (!) batch    (ROUTE_BATCH_ID)  The batch.
+      (<) k        (unsigned int)    The path, r*numAxes + a for axis a of route r.
+
+*-
+
+   History:
+*/
+
+LOCAL void routeBatchSavePath( ROUTE_BATCH_ID batch, unsigned int k )
+{
+    path_t * path = &batch->path[k];
+
+    batch->vi[k] = path->vi;
+    batch->v2[k] = path->v2;
+    batch->vf[k] = path->vf;
+    batch->t1[k] = path->t1;
+    batch->t2[k] = path->t2;
+    batch->t3[k] = path->t3;
+    batch->t4[k] = path->t4;
+    if (path->t1 != 0) batch->accel1[k] = (path->v2 - path->vi) / path->t1;
+    else batch->accel1[k] = 0;
+    if (path->t3 != 0) batch->accel2[k] = (path->vf - path->v2) / path->t3;
+    else batch->accel2[k] = 0;
+    batch->p3[k] = -path->vf * path->t4;
+    batch->p2[k] = batch->p3[k] - 0.5 * (path->v2 + path->vf) * path->t3;
+    batch->p1[k] = batch->p2[k] - path->v2 * path->t2;
+    batch->a0[k] = 0.5 * (path->vi + path->v2) * path->t2;
+}
+
+
 /*+                      r o u t e F i n d W h i c h V 2 S q r t
  
    Function Name: routeFindWhichV2Sqrt
@@ -615,24 +798,68 @@ LOCAL route_status_t routeFindPathWithVmax(path_t * path, double Amax, double Vm
 */
 
 ROUTE_ID routeNew( route_demand_t * demand, route_pars_t * params )
+{
+    ROUTE_ID route = NULL;
+    route_t * storage = (route_t *) calloc( sizeof(route_t),1);
+
+    if (storage != NULL && (route = routeInit( storage, demand, params )) == NULL) free( storage );
+    return route;
+}
+
+
+/*+                      r o u t e I n i t
+  
+   Function Name: routeInit
+  
+   Function: Initialises the routing mechanism in caller supplied storage
+ 
+   Description:
+      This function initialises the internal data structures used by the
+      routing algorithm in storage provided by the caller, for example a
+      route_t embedded in an axis structure.  A route created like this must
+      not be passed to routeDelete.
+ 
+   Call:
+      route = routeInit( storage, demand, params )
+  
+   Parameters:
+      ("<" input, "!" modified, "W" workspace, ">" output)
+
+      (>) storage   (route_t *)        Storage for the route.
+      (<) demand    (route_demand_t *) The inital demand for the routing system.
+      (<) params    (route_pars_t *)   The initial parameters for routing.
+
+   Returns:
+      route     (ROUTE_ID)   storage, or NULL if the parameters are bad.
+
+*-
+
+   History:
+*/
+
+ROUTE_ID routeInit( route_t * storage, route_demand_t * demand, route_pars_t * params )
 {
     ROUTE_ID route = NULL;
     unsigned int i, ok;
 
     /* Check input parameters */
-    ok = (params != NULL && demand != NULL && params->Tsync >= 0);
+    ok = (storage != NULL && params != NULL && demand != NULL && params->Tsync >= 0 &&
+          params->numRoutedAxes <= NUM_AXES);
 
-    for (i=0; i<params->numRoutedAxes && ok; i++)
+    for (i=0; ok && i<params->numRoutedAxes; i++)
     {
         int j = params->routedAxisList[i] - 1;
-        ok = (params->axis[j].Amax > 0 && 
+        ok = (j >= 0 && j < NUM_AXES &&
+              params->axis[j].Amax > 0 && 
               params->axis[j].Vmax > 0 && 
               params->axis[j].Vmax > fabs(demand->axis[j].v) );
     }
 
-    /* If input parameters are OK, malloc and initialize structure */
-    if ( ok && ((route = (route_t *) calloc( sizeof(route_t),1)) != NULL) )
+    /* If input parameters are OK, initialize structure */
+    if ( ok )
     {
+        route = storage;
+        memset( route, 0, sizeof(route_t) );
         route->pars = *params;
         route->endp = *demand;
         route->demand = *demand;
@@ -705,8 +932,8 @@ route_status_t routeFind( ROUTE_ID route, route_reroute_t reroute, route_demand_
 {
     route_status_t status = ROUTE__OK;
     route_status_t ret_status = ROUTE__OK;
-    unsigned int long_path, short_path, i;
-    int old_path_ok;
+    route_view_t view;
+    unsigned int i;
 
     /* If no axes are routed, copy endp into nextp, and return */
     if (route->pars.numRoutedAxes == 0)
@@ -719,52 +946,138 @@ route_status_t routeFind( ROUTE_ID route, route_reroute_t reroute, route_demand_
         return ret_status;
     }
 
+    view.numRoutedAxes = route->pars.numRoutedAxes;
+    view.routedAxisList = route->pars.routedAxisList;
+    view.axis = route->pars.axis;
+    view.Tsync = route->pars.Tsync;
+    view.Tcoast = route->pars.Tcoast;
+    view.path = route->path;
+    view.stride = sizeof(route_axis_demand_t) / sizeof(double);
+    view.demandT = &route->demand.T;
+    view.demandP = &route->demand.axis[0].p;
+    view.demandV = &route->demand.axis[0].v;
+    view.lastEndT = route->endp.T;
+    view.lastEndP = &route->endp.axis[0].p;
+    view.lastEndV = &route->endp.axis[0].v;
+    view.endP = &endp->axis[0].p;
+    view.endV = &endp->axis[0].v;
+    status = routeFindPaths( &view, reroute, &endp->T, nextp->T, &ret_status );
+    if (status != ROUTE__OK) return status;
+
+    /* Now all the paths are valid - calculate the demand position at the next time */
+    for (i=0; i< route->pars.numRoutedAxes; i++)
+    {
+        int j = route->pars.routedAxisList[i] - 1;
+        status = routeDemand(&route->path[j],
+                             (nextp->T - endp->T),
+                             &(nextp->axis[j]) );
+        nextp->axis[j].p += endp->axis[j].p;
+        if (status != ROUTE__OK) return status;
+    }
+
+    /* Save the previous demands and endpoints */
+    route->demand = *nextp;
+    route->endp = *endp;
+
+    return ret_status;
+}
+
+
+/*+                      r o u t e F i n d P a t h s
+  
+   Function Name: routeFindPaths
+  
+   Function: Recalculates the paths of a route when its endpoint changes
+ 
+   Description:
+      This is the path finding part of routeFind, shared with routeBatchFind.
+      It works on a view of the route, so that it does not depend on how the
+      route is stored, and leaves the paths valid for the demand at nextT.
+ 
+   Call:
+      status = routeFindPaths( &view, reroute, &endT, nextT, &path_status )
+  
+   Parameters:
+      ("<" input, "!" modified, "W" workspace, ">" output)
+
+      (!) view        (route_view_t *)   The route.  The paths, and the last demand if
+                                         reroute is ROUTE_NO_NEW_ROUTE, are modified and
+                                         recalculated is set.
+      (<) reroute     (int)              As for routeFind.
+      (!) endT        (double *)         Time of the endpoint, modified as for routeFind.
+      (<) nextT       (double)           Time of the next demand.
+      (>) path_status (route_status_t *) Set to ROUTE__NEGSQRT or ROUTE__NEGTIME if a
+                                         path could only be approximated.
+
+   Returns:
+      status (route_status_t)  ROUTE__OK, or the error that stops routing.
+
+   Author: Nick Rees
+
+*-
+
+   History:
+      Split out of routeFind.
+*/
+
+LOCAL route_status_t routeFindPaths( route_view_t * view, route_reroute_t reroute, double * endT,
+                                     double nextT, route_status_t * ret_status )
+{
+    route_status_t status = ROUTE__OK;
+    unsigned int long_path, short_path, i;
+    unsigned int s = view->stride;
+    int old_path_ok;
+
+    view->recalculated = 0;
+
     /* If we don't want routing, set the old demand to be a coast from the current endpoint */
     if (reroute == ROUTE_NO_NEW_ROUTE)
     {
-        for (i = 0; i < route->pars.numRoutedAxes; i++ )
+        for (i = 0; i < view->numRoutedAxes; i++ )
         {
-            int j = route->pars.routedAxisList[i] - 1;
-            route->demand.axis[j].v = endp->axis[j].v;
-            route->demand.axis[j].p = endp->axis[j].p - (nextp->T - route->demand.T)*endp->axis[j].v;
+            int j = VIEW_AXIS(view, i);
+            view->demandV[j*s] = view->endV[j*s];
+            view->demandP[j*s] = view->endP[j*s] - (nextT - *view->demandT)*view->endV[j*s];
         }
     }
 
     /* First check whether the previous path is OK to use */
-    old_path_ok = (reroute == ROUTE_CALC_ROUTE) && IS_ZERO( (endp->T - route->endp.T), endp->T);
-    for ( i = 0; i < route->pars.numRoutedAxes && old_path_ok; i++ )
+    old_path_ok = (reroute == ROUTE_CALC_ROUTE) && IS_ZERO( (*endT - view->lastEndT), *endT);
+    for ( i = 0; i < view->numRoutedAxes && old_path_ok; i++ )
     {
-        int j = route->pars.routedAxisList[i] - 1;
-        old_path_ok = (IS_ZERO( (endp->axis[j].p - route->endp.axis[j].p), 40.0) &&
-                       (fabs(endp->axis[j].v - route->endp.axis[j].v) < (route->pars.axis[j].Vmax*1.0e-10)));
+        int j = VIEW_AXIS(view, i);
+        old_path_ok = (IS_ZERO( (view->endP[j*s] - view->lastEndP[j*s]), 40.0) &&
+                       (fabs(view->endV[j*s] - view->lastEndV[j*s]) < (view->axis[j].Vmax*1.0e-10)));
 /*         old_path_ok = (IS_ZERO( (endp->axis[j].p - route->endp.axis[j].p), 6.0) && */
 /*                        IS_ZERO( (endp->axis[j].v - route->endp.axis[j].v), route->pars.axis[j].Vmax)); */
     }
 
     if (!old_path_ok)
     {
+        view->recalculated = 1;
+
         /* Initialise the Path structures */
-        for (i = 0; i < route->pars.numRoutedAxes; i++ )
+        for (i = 0; i < view->numRoutedAxes; i++ )
         {
-            int j = route->pars.routedAxisList[i] - 1;
-            route->path[j].dist = endp->axis[j].p - route->demand.axis[j].p;
-            route->path[j].vi = route->demand.axis[j].v;
-            route->path[j].vf = endp->axis[j].v;
-            route->path[j].t2 = 0.0;
-            route->path[j].t4 = route->pars.Tcoast;
-            route->path[j].T  = endp->T - route->demand.T;
+            int j = VIEW_AXIS(view, i);
+            view->path[j].dist = view->endP[j*s] - view->demandP[j*s];
+            view->path[j].vi = view->demandV[j*s];
+            view->path[j].vf = view->endV[j*s];
+            view->path[j].t2 = 0.0;
+            view->path[j].t4 = view->Tcoast;
+            view->path[j].T  = *endT - *view->demandT;
         }
 
         /* Calculate whether we expect to complete this route in the next coast period */
-        short_path = (reroute != ROUTE_NEW_ROUTE) && (nextp->T + route->pars.Tcoast >= endp->T);
+        short_path = (reroute != ROUTE_NEW_ROUTE) && (nextT + view->Tcoast >= *endT);
         if (short_path)
         {
-            for (i = 0; ((i < route->pars.numRoutedAxes) && (status == ROUTE__OK)); i++ )
+            for (i = 0; ((i < view->numRoutedAxes) && (status == ROUTE__OK)); i++ )
             {
-                int j = route->pars.routedAxisList[i] - 1;
-                status = routeFindPathWithVmax(&route->path[j],
-                                               route->pars.axis[j].Amax,
-                                               route->pars.axis[j].Vmax,
+                int j = VIEW_AXIS(view, i);
+                status = routeFindPathWithVmax(&view->path[j],
+                                               view->axis[j].Amax,
+                                               view->axis[j].Vmax,
                                                T4 );
             }
         }
@@ -774,13 +1087,13 @@ route_status_t routeFind( ROUTE_ID route, route_reroute_t reroute, route_demand_
             /* Either we didn't find a route using the above or the time is longer */
 
             long_path = 0;
-            for (i = 0; i < route->pars.numRoutedAxes; i++ )
+            for (i = 0; i < view->numRoutedAxes; i++ )
             {
-                int j = route->pars.routedAxisList[i] - 1;
-                route->path[j].t4 = route->pars.Tcoast;
-                status = routeFindPathWithVmax(&route->path[j],
-                                               route->pars.axis[j].Amax,
-                                               route->pars.axis[j].Vmax,
+                int j = VIEW_AXIS(view, i);
+                view->path[j].t4 = view->Tcoast;
+                status = routeFindPathWithVmax(&view->path[j],
+                                               view->axis[j].Amax,
+                                               view->axis[j].Vmax,
                                                T );
                 switch (status)
                 {
@@ -792,61 +1105,429 @@ route_status_t routeFind( ROUTE_ID route, route_reroute_t reroute, route_demand_
                     return status;
                 }
 
-                if (route->path[j].T > route->path[long_path].T) long_path = j;
+                if (view->path[j].T > view->path[long_path].T) long_path = j;
             }
 
             /* Set the time for the path - synchronising it to an integral 
                number of Tsync units, if required */
-            if (route->pars.Tsync > 0)
+            if (view->Tsync > 0)
             {
-                endp->T = ceil((route->demand.T + route->path[long_path].T) / 
-                               route->pars.Tsync) * route->pars.Tsync;
-                route->path[long_path].T = endp->T - route->demand.T;
+                *endT = ceil((*view->demandT + view->path[long_path].T) / 
+                             view->Tsync) * view->Tsync;
+                view->path[long_path].T = *endT - *view->demandT;
             }
             else
             {
-                endp->T = route->demand.T + route->path[long_path].T;
+                *endT = *view->demandT + view->path[long_path].T;
             }
 
             /* Recalculate the paths for the new total path time. */
-            for (i = 0; i < route->pars.numRoutedAxes; i++ )
+            for (i = 0; i < view->numRoutedAxes; i++ )
             {
-                int j = route->pars.routedAxisList[i] - 1;
-                route->path[j].T = route->path[long_path].T;
+                int j = VIEW_AXIS(view, i);
+                view->path[j].T = view->path[long_path].T;
 
                 /* If we are synchronising to an integral number of tic's all
                    paths have to be recalculated, otherwise all except the
                    longest path needs recaculating */
-                if ( route->pars.Tsync > 0 || j != long_path )
+                if ( view->Tsync > 0 || j != (int) long_path )
                 {
-                    status = routeFindPath(&route->path[j],
-                                           route->pars.axis[j].Amax,
+                    status = routeFindPath(&view->path[j],
+                                           view->axis[j].Amax,
                                            T2 | V2 );
                 }
 
-                if (status != ROUTE__OK) ret_status = status;
+                if (status != ROUTE__OK) *ret_status = status;
             }
         }
     }
 
-    /* Now all the paths are valid - calculate the demand position at the next time */
-    for (i=0; i< route->pars.numRoutedAxes; i++)
+    return ROUTE__OK;
+}
+
+/*+                      r o u t e B a t c h N e w
+  
+   Function Name: routeBatchNew
+  
+   Function: Initialises a batch of routes
+ 
+   Description:
+      This function mallocs and initialises a batch of numRoutes routes of
+      numAxes axes each, all of them routed, for routeBatchFind.  The number of
+      axes is not limited by ROUTE_MAX_AXES.  Positions, velocities and limits are
+      passed as arrays with element r*numAxes + a for axis a of route r.  No
+      memory is allocated after this call.
+ 
+   Call:
+      batch = routeBatchNew( numRoutes, numAxes, Tsync, Tcoast, axis, T, p, v )
+  
+   Parameters:
+      ("<" input, "!" modified, "W" workspace, ">" output)
+
+      (<) numRoutes (unsigned int)        Number of routes.
+      (<) numAxes   (unsigned int)        Number of axes of each route.
+      (<) Tsync     (double)              As in route_pars_t, for all routes.
+      (<) Tcoast    (double)              As in route_pars_t, for all routes.
+      (<) axis      (route_axis_pars_t *) Limits of each axis of each route.
+      (<) T         (double)              Time of the initial demands.
+      (<) p         (double *)            Initial demand position of each axis.
+      (<) v         (double *)            Initial demand velocity of each axis.
+
+   Returns:
+      batch     (ROUTE_BATCH_ID)  The batch, or NULL if the parameters are bad or
+                                  there is no space.
+
+*-
+
+   History:
+*/
+
+ROUTE_BATCH_ID routeBatchNew( unsigned int numRoutes, unsigned int numAxes, double Tsync, double Tcoast,
+                              const route_axis_pars_t * axis, double T, const double * p, const double * v )
+{
+    ROUTE_BATCH_ID batch;
+    unsigned int n = numRoutes * numAxes;
+    unsigned int r;
+
+    if (numRoutes == 0 || numAxes == 0 || Tsync < 0 || axis == NULL || p == NULL || v == NULL) return NULL;
+
+    batch = (ROUTE_BATCH_ID) calloc( 1, sizeof(struct route_batch_str) );
+    if (batch == NULL) return NULL;
+    batch->numRoutes = numRoutes;
+    batch->numAxes = numAxes;
+    batch->n = n;
+    batch->Tsync = Tsync;
+    batch->Tcoast = Tcoast;
+    batch->axis = (route_axis_pars_t *) calloc( n, sizeof(route_axis_pars_t) );
+    batch->path = (path_t *) calloc( n, sizeof(path_t) );
+    batch->vi = (double *) calloc( n, sizeof(double) );
+    batch->v2 = (double *) calloc( n, sizeof(double) );
+    batch->vf = (double *) calloc( n, sizeof(double) );
+    batch->t1 = (double *) calloc( n, sizeof(double) );
+    batch->t2 = (double *) calloc( n, sizeof(double) );
+    batch->t3 = (double *) calloc( n, sizeof(double) );
+    batch->t4 = (double *) calloc( n, sizeof(double) );
+    batch->accel1 = (double *) calloc( n, sizeof(double) );
+    batch->accel2 = (double *) calloc( n, sizeof(double) );
+    batch->p1 = (double *) calloc( n, sizeof(double) );
+    batch->p2 = (double *) calloc( n, sizeof(double) );
+    batch->p3 = (double *) calloc( n, sizeof(double) );
+    batch->a0 = (double *) calloc( n, sizeof(double) );
+    batch->demandT = (double *) calloc( numRoutes, sizeof(double) );
+    batch->demandP = (double *) calloc( n, sizeof(double) );
+    batch->demandV = (double *) calloc( n, sizeof(double) );
+    batch->lastEndT = (double *) calloc( numRoutes, sizeof(double) );
+    batch->lastEndP = (double *) calloc( n, sizeof(double) );
+    batch->lastEndV = (double *) calloc( n, sizeof(double) );
+    batch->t = (double *) calloc( n, sizeof(double) );
+    batch->failed = (int *) calloc( numRoutes, sizeof(int) );
+    if (batch->axis == NULL || batch->path == NULL || batch->vi == NULL || batch->v2 == NULL ||
+        batch->vf == NULL || batch->t1 == NULL || batch->t2 == NULL || batch->t3 == NULL ||
+        batch->t4 == NULL || batch->accel1 == NULL || batch->accel2 == NULL ||
+        batch->p1 == NULL || batch->p2 == NULL || batch->p3 == NULL ||
+        batch->a0 == NULL || batch->demandT == NULL || batch->demandP == NULL ||
+        batch->demandV == NULL || batch->lastEndT == NULL || batch->lastEndP == NULL ||
+        batch->lastEndV == NULL || batch->t == NULL || batch->failed == NULL)
     {
-        int j = route->pars.routedAxisList[i] - 1;
-        status = routeDemand(&route->path[j],
-                             (nextp->T - endp->T),
-                             &(nextp->axis[j]) );
-        nextp->axis[j].p += endp->axis[j].p;
-        if (status != ROUTE__OK) return status;
+        routeBatchDelete( batch );
+        return NULL;
     }
 
-    /* Save the previous demands and endpoints */
-    route->demand = *nextp;
-    route->endp = *endp;
+    for (r = 0; r < numRoutes; r++)
+    {
+        if (routeBatchSetParams( batch, r, &axis[r*numAxes] ) != ROUTE__OK ||
+            routeBatchSetDemand( batch, r, T, &p[r*numAxes], &v[r*numAxes] ) != ROUTE__OK)
+        {
+            routeBatchDelete( batch );
+            return NULL;
+        }
+    }
+    return batch;
+}
 
-    return ret_status;
+
+/*+                      r o u t e B a t c h S e t D e m a n d
+  
+   Function Name: routeBatchSetDemand
+  
+   Function: Sets the current demand of one route of a batch
+ 
+   Description:
+      This function does what routeSetDemand does for route r of a batch.
+ 
+   Call:
+      status = routeBatchSetDemand( batch, r, T, p, v )
+  
+   Parameters:
+      ("<" input, "!" modified, "W" workspace, ">" output)
+
+      (!) batch     (ROUTE_BATCH_ID)  The batch.
+      (<) r         (unsigned int)    The route.
+      (<) T         (double)          Time of the demand.
+      (<) p         (double *)        Position of each axis of the route.
+      (<) v         (double *)        Velocity of each axis of the route.
+
+   Returns:
+      status (route_status_t)  ROUTE__BADPARAM if a velocity is above its limit,
+                               ROUTE__BADROUTE if r is not a route of the batch,
+                               otherwise ROUTE__OK.
+
+*-
+
+   History:
+*/
+
+route_status_t routeBatchSetDemand( ROUTE_BATCH_ID batch, unsigned int r, double T,
+                                    const double * p, const double * v )
+{
+    unsigned int a, k;
+
+    if (batch == NULL || r >= batch->numRoutes) return ROUTE__BADROUTE;
+    for (a = 0; a < batch->numAxes; a++)
+    {
+        if (batch->axis[r*batch->numAxes + a].Vmax <= fabs(v[a])) return ROUTE__BADPARAM;
+    }
+
+    batch->demandT[r] = T;
+    batch->lastEndT[r] = T;
+    for (a = 0; a < batch->numAxes; a++)
+    {
+        k = r*batch->numAxes + a;
+        batch->demandP[k] = batch->lastEndP[k] = p[a];
+        batch->demandV[k] = batch->lastEndV[k] = v[a];
+        memset( &batch->path[k], 0, sizeof(path_t) );
+        batch->path[k].vi = batch->path[k].v2 = batch->path[k].vf = v[a];
+        routeBatchSavePath( batch, k );
+    }
+    return ROUTE__OK;
+}
+
+
+/*+                      r o u t e B a t c h S e t P a r a m s
+  
+   Function Name: routeBatchSetParams
+  
+   Function: Sets the limits of one route of a batch
+ 
+   Description:
+      This function sets the maximum acceleration and velocity of each axis
+      of route r of a batch.
+ 
+   Call:
+      status = routeBatchSetParams( batch, r, axis )
+  
+   Parameters:
+      ("<" input, "!" modified, "W" workspace, ">" output)
+
+      (!) batch     (ROUTE_BATCH_ID)       The batch.
+      (<) r         (unsigned int)         The route.
+      (<) axis      (route_axis_pars_t *)  Limits of each axis of the route.
+
+   Returns:
+      status (route_status_t)  ROUTE__BADPARAM if a limit is not positive,
+                               ROUTE__BADROUTE if r is not a route of the batch,
+                               otherwise ROUTE__OK.
+
+*-
+
+   History:
+*/
+
+route_status_t routeBatchSetParams( ROUTE_BATCH_ID batch, unsigned int r, const route_axis_pars_t * axis )
+{
+    unsigned int a;
+
+    if (batch == NULL || r >= batch->numRoutes) return ROUTE__BADROUTE;
+    for (a = 0; a < batch->numAxes; a++)
+    {
+        if (axis[a].Amax <= 0 || axis[a].Vmax <= 0) return ROUTE__BADPARAM;
+    }
+    memcpy( &batch->axis[r*batch->numAxes], axis, batch->numAxes * sizeof(route_axis_pars_t) );
+    return ROUTE__OK;
+}
+
+
+/*+                      r o u t e B a t c h F i n d
+  
+   Function Name: routeBatchFind
+  
+   Function: Finds the next demand of every route of a batch
+ 
+   Description:
+      This function does what routeFind does, for every route of a batch.
+      The paths are found route by route, and only when an endpoint changes;
+      their members are kept as separate arrays, so that the demands at the
+      next times, which every call needs, are evaluated for all axes of all
+      routes in one vectorized loop by routeDemandKernel.  Positions and
+      velocities are arrays with element r*numAxes + a for axis a of route r.
+      No memory is allocated.
+ 
+   Call:
+      status = routeBatchFind( batch, reroute, endT, endP, endV, nextT, nextP, nextV, statuses )
+  
+   Parameters:
+      ("<" input, "!" modified, "W" workspace, ">" output)
+
+      (!) batch     (ROUTE_BATCH_ID)     The batch.
+      (<) reroute   (route_reroute_t *)  As for routeFind, for each route.
+      (!) endT      (double *)           Time of the endpoint of each route, modified
+                                         as for routeFind.
+      (<) endP      (double *)           Endpoint position of each axis.
+      (<) endV      (double *)           Endpoint velocity of each axis.
+      (<) nextT     (double *)           Time of the next demand of each route.
+      (>) nextP     (double *)           Demand position of each axis at nextT.
+      (>) nextV     (double *)           Demand velocity of each axis at nextT.
+      (>) statuses  (route_status_t *)   The routeFind status of each route.  The
+                                         demands of a route whose status is an error
+                                         are those of the last call.
+
+   Returns:
+      status (route_status_t)  The first status in statuses that is not ROUTE__OK,
+                               otherwise ROUTE__OK.
+
+*-
+
+   History:
+*/
+
+route_status_t routeBatchFind( ROUTE_BATCH_ID batch, const route_reroute_t * reroute,
+                               double * endT, const double * endP, const double * endV,
+                               const double * nextT, double * nextP, double * nextV,
+                               route_status_t * statuses )
+{
+    unsigned int numAxes = batch->numAxes;
+    unsigned int r, a, k;
+    unsigned int numFailed = 0;
+    route_status_t found;
+    route_view_t view;
+
+    view.numRoutedAxes = numAxes;
+    view.routedAxisList = NULL;
+    view.Tsync = batch->Tsync;
+    view.Tcoast = batch->Tcoast;
+    view.stride = 1;
+
+    for (r = 0; r < batch->numRoutes; r++)
+    {
+        k = r * numAxes;
+        view.axis = &batch->axis[k];
+        view.path = &batch->path[k];
+        view.demandT = &batch->demandT[r];
+        view.demandP = &batch->demandP[k];
+        view.demandV = &batch->demandV[k];
+        view.lastEndT = batch->lastEndT[r];
+        view.lastEndP = &batch->lastEndP[k];
+        view.lastEndV = &batch->lastEndV[k];
+        view.endP = &endP[k];
+        view.endV = &endV[k];
+
+        statuses[r] = ROUTE__OK;
+        found = routeFindPaths( &view, reroute[r], &endT[r], nextT[r], &statuses[r] );
+        batch->failed[r] = (found != ROUTE__OK);
+        if (batch->failed[r]) statuses[r] = found;
+
+        if (view.recalculated)
+            for (a = 0; a < numAxes; a++) routeBatchSavePath( batch, k+a );
+        for (a = 0; a < numAxes; a++) batch->t[k+a] = nextT[r] - endT[r];
+    }
+
+    routeDemandKernel( batch->n, batch->t, batch->vi, batch->v2, batch->vf,
+                       batch->t1, batch->t2, batch->t3, batch->t4, batch->accel1, batch->accel2,
+                       batch->p1, batch->p2, batch->p3, batch->a0, endP, nextP, nextV );
+
+    /* Save the previous demands and endpoints, except of the routes that failed,
+       whose demands are unchanged */
+    for (r = 0; r < batch->numRoutes; r++)
+    {
+        k = r * numAxes;
+        if (batch->failed[r])
+        {
+            numFailed++;
+            memcpy( &nextP[k], &batch->demandP[k], numAxes * sizeof(double) );
+            memcpy( &nextV[k], &batch->demandV[k], numAxes * sizeof(double) );
+        }
+        else
+        {
+            batch->demandT[r] = nextT[r];
+            batch->lastEndT[r] = endT[r];
+        }
+    }
+    memcpy( batch->demandP, nextP, batch->n * sizeof(double) );
+    memcpy( batch->demandV, nextV, batch->n * sizeof(double) );
+    if (numFailed == 0)
+    {
+        memcpy( batch->lastEndP, endP, batch->n * sizeof(double) );
+        memcpy( batch->lastEndV, endV, batch->n * sizeof(double) );
+    }
+    else
+    {
+        for (r = 0; r < batch->numRoutes; r++)
+        {
+            if (batch->failed[r]) continue;
+            k = r * numAxes;
+            memcpy( &batch->lastEndP[k], &endP[k], numAxes * sizeof(double) );
+            memcpy( &batch->lastEndV[k], &endV[k], numAxes * sizeof(double) );
+        }
+    }
+
+    for (r = 0; r < batch->numRoutes; r++)
+        if (statuses[r] != ROUTE__OK) return statuses[r];
+    return ROUTE__OK;
+}
+
+
+/*+                      r o u t e B a t c h D e l e t e
+  
+   Function Name: routeBatchDelete
+  
+   Function: Deletes a batch of routes
+ 
+   Description:
+      This function frees a batch created by routeBatchNew.
+ 
+   Call:
+      (void) routeBatchDelete( batch )
+  
+   Parameters:
+      ("<" input, "!" modified, "W" workspace, ">" output)
+
+      (<) batch     (ROUTE_BATCH_ID)   The batch to be deleted.
+
+*-
+
+   History:
+*/
+
+void routeBatchDelete( ROUTE_BATCH_ID batch )
+{
+    if (batch == NULL) return;
+    free( batch->axis );
+    free( batch->path );
+    free( batch->vi );
+    free( batch->v2 );
+    free( batch->vf );
+    free( batch->t1 );
+    free( batch->t2 );
+    free( batch->t3 );
+    free( batch->t4 );
+    free( batch->accel1 );
+    free( batch->accel2 );
+    free( batch->p1 );
+    free( batch->p2 );
+    free( batch->p3 );
+    free( batch->a0 );
+    free( batch->demandT );
+    free( batch->demandP );
+    free( batch->demandV );
+    free( batch->lastEndT );
+    free( batch->lastEndP );
+    free( batch->lastEndV );
+    free( batch->t );
+    free( batch->failed );
+    free( batch );
 }
 
+
 /*+                      r o u t e D e l e t e
   
    Function Name: routeDelete
@@ -1055,222 +1736,9 @@ route_status_t routeGetNumRoutedAxes( ROUTE_ID route, unsigned int * number )
 
 
 
-/* Test routines */
-
-#ifdef TEST_FIND_PATH
-
-#include <stdio.h>
-
-int main( int * argc, char * argv[] )
-{
-    int     option = 1;
-    double  value=0.0, distance;
-    path_t path = {0,0,0,0,0,0,0,0,0};
-    double Amax = 0.0;
-    double Vmax = 0.0;
-    route_status_t status = 0;
-    int unknown1 = 1;
-    int unknown2 = 2;
-    int unknowns;
-    char line[128];
-
-    while ( option != 0 )
-    {
-        printf("\n \
-                Choose from: \n \
-                    0 - Exit \n \
-                    1 - Set Amax (%f) \n \
-                    2 - Set Vmax (%f) \n \
-                    3 - Set dist (%f) \n \
-                    4 - Set vi   (%f) \n \
-                    5 - Set vf   (%f) \n \
-                    6 - Set v2   (%f) \n \
-                    7 - Set t1   (%f) \n \
-                    8 - Set t2   (%f) \n \
-                    9 - Set t3   (%f) \n \
-                   10 - Set t4   (%f) \n \
-                   11 - Set T    (%f) \n \
-                   12 - Set unknown 1 (1 = v2, 2=T, 3=t2, 4=t4) (%d) \n \
-                   13 - Set unknown 2 (1 = v2, 2=T, 3=t2, 4=t4) (%d) \n \
-                   14 - Enter all values at once \n \
- \n \
-               Enter option : ",
-               Amax,
-               Vmax,
-               path.dist,
-               path.vi,
-               path.vf,
-               path.v2,
-               path.t1,
-               path.t2,
-               path.t3,
-               path.t4,
-               path.T,
-               unknown1, unknown2 );
-
-        while ( gets( line ) == NULL || line[0] == '#' || (sscanf( line, "%d", &option ) != 1));
-
-        if (option > 0 && option < 14)
-        {
-            printf( "\n                Enter value  : " );
-            while ( gets( line ) == NULL || line[0] == '#' || (sscanf( line, "%lf", &value ) != 1));
-
-            switch (option)
-            {
-            case 1: Amax = value; break;
-            case 2: Vmax = value; break;
-            case 3: path.dist = value; break;
-            case 4: path.vi = value; break;
-            case 5: path.vf = value; break;
-            case 6: path.v2 = value; break;
-            case 7: path.t1 = value; break;
-            case 8: path.t2 = value; break;
-            case 9: path.t3 = value; break;
-            case 10: path.t4 = value; break;
-            case 11: path.T = value; break;
-            case 12: unknown1 = (int) value; break;
-            case 13: unknown2 = (int) value; break;
-            default: break;
-            }
-        }
-        else if (option == 14)
-        {
-            while ( gets( line ) == NULL || line[0] == '#' ||
-                    (sscanf( line, "%lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %d %d",
-                             &Amax, &Vmax, &path.dist,
-                             &path.vi, &path.vf, &path.v2,
-                             &path.t1, &path.t2, &path.t3, &path.t4, &path.T,
-                             &unknown1, &unknown2 ) != 13 ));
-        }
-
-        unknowns =(0x1 << (int)(unknown1-1)) | (0x1 << (int)(unknown2-1));
-        status = routeFindPath( &path, Amax, unknowns );
-        distance = (path.t1 * (path.vi+path.v2) / 2 +
-                    path.t2 * path.v2 +
-                    path.t3 * (path.v2+path.vf) / 2 +
-                    path.t4 * path.vf);
-
-        printf("\n" );
-        printf("                routeFindPath status = %d\n", (int) status );
-        printf("                distance       = %.12f\n", distance );
-        printf("                distance error = %.12f\n", distance - path.dist );
-    }
-
-    return 0;
-}
-
-#endif
-
-#ifdef TEST
-
-#include <stdio.h>
-
-#define DAS2R (3.141592654/(3600.0*180.0))
-
-route_demand_t route_list[] =
-{
-    0.0, -100*DAS2R, 10*DAS2R,  10.0*DAS2R, 0.0, -100*DAS2R, 10*DAS2R,
-    0.0, -100*DAS2R, 10*DAS2R,   0.0*DAS2R, 0.0, -100*DAS2R, 10*DAS2R,
-    0.0, -100*DAS2R, 10*DAS2R, -10.0*DAS2R, 0.0, -100*DAS2R, 10*DAS2R,
-    0.0, -180*3600*DAS2R, 10*DAS2R, -50*3600*DAS2R, 0.0,      -180*3600*DAS2R, 10*DAS2R,
-    0.0, -180*3600*DAS2R, 10*DAS2R, (-50*3600+10)*DAS2R, 0.0, -180*3600*DAS2R, 10*DAS2R, 
-    0.0, -180*3600*DAS2R, 10*DAS2R, (-50*3600+20)*DAS2R, 0.0, -180*3600*DAS2R, 10*DAS2R
-};
-
-#define NUM_DEMANDS (sizeof(route_list)/sizeof(route_demand_t))
-
-route_demand_t sky = { 0.0, 0*DAS2R, 10*DAS2R, 0.0*DAS2R, 0.0 };
-
-int routeTCSSim( int route_num, route_demand_t * demand, int slewing )
-{
-    route_demand_t * this_route = &route_list[route_num % NUM_DEMANDS];
-    int i;
-
-    if (slewing) this_route->T = demand->T;
-
-    for (i = 0; i < NUM_AXES; i++ )
-    {
-        demand->axis[i].p = (sky.axis[i].p + 
-                             sky.axis[i].v * demand->T +
-                             this_route->axis[i].p + 
-                             this_route->axis[i].v * (demand->T - this_route->T));
-        demand->axis[i].v = (sky.axis[i].v + this_route->axis[i].v);
-    }
-     
-    return 0;
-}
-
-int route_numbers[]  = {  0,  1,  2, 3, 4, 5 };
-double route_times[] = { 10, 10, 10, 60, 60, 60 };
-
-#define NUM_ROUTES  (sizeof(route_numbers)/sizeof(int))
-
-route_demand_t initial_demand = { 0.0, 0.0, 0.0, 0.0, 0.0 0.0, 0.0};
-route_pars_t initial_params =
-{
-    3,                 /* numRoutedAxes */
-    1,2,3,             /* routedAxisList */
-    0.05,              /* Tsync  */
-    1.0,              /* Tcoast */
-    0.12*3600.0*DAS2R, /* Amax   */
-    0.60*3600.0*DAS2R, /* Vmax   */
-    0.12*3600.0*DAS2R, /* Amax   */
-    0.60*3600.0*DAS2R, /* Vmax   */
-    0.12*3600.0*DAS2R, /* Amax   */
-    0.60*3600.0*DAS2R  /* Vmax   */
-};
-
-#define DELTA_T (0.05);
-
-#include "thi_route_if.h"
-
-int main( int argc, char * argv[] )
-{
-    ROUTE_ID route = routeNew( &initial_demand, &initial_params );
-    route_demand_t demand=initial_demand;
-    route_demand_t next_demand=initial_demand;
-    double last_route_start = initial_demand.T;
-    int i, slewing, status, tel_step;
-
-    for ( i = 0; i<NUM_ROUTES; i++ )
-    {
-        slewing = 1;
-        last_route_start = next_demand.T;
-        tel_step = 1;
-
-        while ( slewing || (next_demand.T < (last_route_start + route_times[i])))
-        {
-
-            routeTCSSim( route_numbers[i], &demand, slewing );
-            /* status = (int) routeFindFJO( route, tel_step, &demand, &next_demand ); */
-            status = (int) routeFind( route, tel_step, &demand, &next_demand ); 
-            tel_step = 0;
-
-            printf( "%g %g %g %g %g %g %g %g %g %g %d %d\n",
-                    next_demand.T,
-                    next_demand.axis[0].p ,next_demand.axis[0].v,
-                    next_demand.axis[1].p ,next_demand.axis[1].v,
-                    demand.T,
-                    demand.axis[0].p ,demand.axis[0].v,
-                    demand.axis[1].p ,demand.axis[1].v,
-                    slewing, status );
-
-            next_demand.T += DELTA_T;
-
-            if (slewing) last_route_start = demand.T;
-            slewing = (demand.T > next_demand.T);
-            if (!slewing) demand.T = next_demand.T;
-        }
-    }
-
-    return 0;
-}
-
-#endif
-
 void routePrint( ROUTE_ID route, route_reroute_t reroute, route_demand_t * endp, route_demand_t * nextp, FILE * logfile )
 {
-    int i;
+    unsigned int i;
 
     fprintf( logfile, "\nreroute %d\n", reroute);
     
@@ -1278,13 +1746,13 @@ void routePrint( ROUTE_ID route, route_reroute_t reroute, route_demand_t * endp,
     fprintf( logfile, "Tsync, Tcoast %f %f\n", route->pars.Tsync, route->pars.Tcoast );
     for (i = 0; i < route->pars.numRoutedAxes; i++ )
     {
-        fprintf( logfile, "Axis %d Amax, Vmax %f %f\n", i, route->pars.axis[i].Amax * DR2D, route->pars.axis[i].Vmax * DR2D);
+        fprintf( logfile, "Axis %u Amax, Vmax %f %f\n", i, route->pars.axis[i].Amax * DR2D, route->pars.axis[i].Vmax * DR2D);
     }
     
     fprintf( logfile, "\nroute path struct\n");
     for (i = 0; i < route->pars.numRoutedAxes; i++ )
     {
-        fprintf( logfile, "Axis %d dist %f vi %f vf %f v2 %f t1 %f t2 %f t3 %f t4 %f T %f \n", i,
+        fprintf( logfile, "Axis %u dist %f vi %f vf %f v2 %f t1 %f t2 %f t3 %f t4 %f T %f \n", i,
                  route->path[i].dist * DR2D, route->path[i].vi * DR2D, route->path[i].vf * DR2D, route->path[i].v2 * DR2D,
                  route->path[i].t1, route->path[i].t2, route->path[i].t3, route->path[i].t4, route->path[i].T );
     }
@@ -1293,28 +1761,28 @@ void routePrint( ROUTE_ID route, route_reroute_t reroute, route_demand_t * endp,
     fprintf( logfile, "T %f\n", route->demand.T );
     for (i = 0; i < route->pars.numRoutedAxes; i++ )
     {
-        fprintf( logfile, "Axis %d p, v %f %f\n", i, route->demand.axis[i].p * DR2D, route->demand.axis[i].v * DR2D );
+        fprintf( logfile, "Axis %u p, v %f %f\n", i, route->demand.axis[i].p * DR2D, route->demand.axis[i].v * DR2D );
     }
     
     fprintf( logfile, "\nroute endp struct\n");
     fprintf( logfile, "T %f\n", route->endp.T );
     for (i = 0; i < route->pars.numRoutedAxes; i++ )
     {
-        fprintf( logfile, "Axis %d p, v %f %f\n", i, route->endp.axis[i].p * DR2D, route->endp.axis[i].v * DR2D );
+        fprintf( logfile, "Axis %u p, v %f %f\n", i, route->endp.axis[i].p * DR2D, route->endp.axis[i].v * DR2D );
     }
     
     fprintf( logfile, "\nendp struct\n");
     fprintf( logfile, "T %f\n", endp->T );
     for (i = 0; i < route->pars.numRoutedAxes; i++ )
     {
-        fprintf( logfile, "Axis %d p, v %f %f\n", i, endp->axis[i].p * DR2D, endp->axis[i].v * DR2D );
+        fprintf( logfile, "Axis %u p, v %f %f\n", i, endp->axis[i].p * DR2D, endp->axis[i].v * DR2D );
     }
     
     fprintf( logfile, "\nnextp struct\n");
     fprintf( logfile, "T %f\n", nextp->T );
     for (i = 0; i < route->pars.numRoutedAxes; i++ )
     {
-        fprintf( logfile, "Axis %d p, v %f %f\n", i, nextp->axis[i].p * DR2D, nextp->axis[i].v * DR2D );
+        fprintf( logfile, "Axis %u p, v %f %f\n", i, nextp->axis[i].p * DR2D, nextp->axis[i].v * DR2D );
     }
 }
 
@@ -5,7 +5,12 @@
 extern "C" {
 #endif
 
-#define NUM_AXES 3
+/* Maximum number of axes in one route; the number routed is set at run time
+   by route_pars_t.numRoutedAxes.  Override with -DROUTE_MAX_AXES=n. */
+#ifndef ROUTE_MAX_AXES
+#define ROUTE_MAX_AXES 8
+#endif
+#define NUM_AXES ROUTE_MAX_AXES
 
 typedef enum
 {
@@ -50,9 +55,33 @@ typedef struct route_pars_str
     route_axis_pars_t axis[NUM_AXES];
 } route_pars_t;
 
+typedef struct route_path_str
+{
+    double dist;
+    double vi;
+    double vf;
+    double v2;
+    double t1;
+    double t2;
+    double t3;
+    double t4;
+    double T;
+} route_path_t;
+
+/* The complete state of one route.  It is public so that callers can embed it
+   and use routeInit() instead of routeNew(); treat the members as private. */
+typedef struct route_str
+{
+    route_pars_t   pars;
+    route_demand_t demand;
+    route_path_t path[NUM_AXES];
+    route_demand_t endp;
+} route_t;
+
 typedef struct route_str * ROUTE_ID;
 
 ROUTE_ID routeNew( route_demand_t * initialDemand, route_pars_t * initial_parameters );
+ROUTE_ID routeInit( route_t * storage, route_demand_t * initialDemand, route_pars_t * initial_parameters );
 route_status_t routeFind( ROUTE_ID, route_reroute_t, route_demand_t * end_demand, route_demand_t * next_demand );
 void routePrint( ROUTE_ID route, route_reroute_t reroute, route_demand_t * endp, route_demand_t * nextp, FILE * logfile );
 void routeDelete( ROUTE_ID );
@@ -62,6 +91,21 @@ route_status_t routeSetParams( ROUTE_ID, route_pars_t * parameters );
 route_status_t routeGetParams( ROUTE_ID, route_pars_t * parameters );
 route_status_t routeGetNumRoutedAxes( ROUTE_ID route, unsigned int * number );
 
+/* A batch of routes with all axes routed, solved together by routeBatchFind.
+   Positions, velocities and limits are arrays with element r*numAxes + a for
+   axis a of route r, and numAxes is not limited by ROUTE_MAX_AXES. */
+typedef struct route_batch_str * ROUTE_BATCH_ID;
+
+ROUTE_BATCH_ID routeBatchNew( unsigned int numRoutes, unsigned int numAxes, double Tsync, double Tcoast,
+                              const route_axis_pars_t * axis, double T, const double * p, const double * v );
+route_status_t routeBatchFind( ROUTE_BATCH_ID, const route_reroute_t * reroute,
+                               double * endT, const double * endP, const double * endV,
+                               const double * nextT, double * nextP, double * nextV,
+                               route_status_t * statuses );
+route_status_t routeBatchSetDemand( ROUTE_BATCH_ID, unsigned int route, double T, const double * p, const double * v );
+route_status_t routeBatchSetParams( ROUTE_BATCH_ID, unsigned int route, const route_axis_pars_t * axis );
+void routeBatchDelete( ROUTE_BATCH_ID );
+
 #ifdef __cplusplus
 }
 #endif
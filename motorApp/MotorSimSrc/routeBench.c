@@ -0,0 +1,244 @@
+/* routeBench.c
+ *
+ * Benchmark of the route library (route.c).
+ *
+ * The same demands are solved one route at a time with routeFind and all
+ * together with routeBatchFind, and the largest difference between the two
+ * results is reported.  Batches may have more than NUM_AXES axes, in which
+ * case only routeBatchFind is run.
+ *
+ * Every route is sent to a new target every 10 seconds.  In move mode the
+ * targets are fixed between changes, as for the motor simulator, and most
+ * updates only evaluate the current path.  In tracking mode the target moves
+ * at constant velocity and the path is solved again on every update.
+ *
+ * Usage: routeBench [nRoutes [nAxes [nTicks [tracking]]]]
+ *     nRoutes   Number of routes (default 100)
+ *     nAxes     Number of axes in each route (default 3)
+ *     nTicks    Number of 50 ms demand updates (default 10000)
+ *     tracking  0 for move mode, 1 for tracking mode (default 0)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <epicsTime.h>
+
+#include "route.h"
+
+#define DELTA_T     0.05
+#define NEW_TARGET  200     /* Ticks between target changes */
+
+/* Target of route r, axis j at time T after n target changes */
+static void benchTargetAxis(unsigned int r, unsigned int j, unsigned int n,
+                            double T, int tracking, double *p, double *v)
+{
+    double vel = tracking ? 0.01 * (1 + (r + j) % 5) : 0.0;
+    double offset = 2.0 * sin(0.7 * n + r + 1.3 * j);
+
+    *p = offset + vel * T;
+    *v = vel;
+}
+
+static void benchTarget(unsigned int r, unsigned int nAxes, unsigned int n,
+                        double T, int tracking, route_demand_t *demand)
+{
+    unsigned int j;
+
+    demand->T = T;
+    for (j = 0; j < nAxes; j++)
+        benchTargetAxis(r, j, n, T, tracking, &demand->axis[j].p, &demand->axis[j].v);
+}
+
+static double benchRun(unsigned int nRoutes, unsigned int nAxes, unsigned int nTicks,
+                       int tracking, route_demand_t *result)
+{
+    route_t *storage = calloc(nRoutes, sizeof(route_t));
+    ROUTE_ID *routes = calloc(nRoutes, sizeof(ROUTE_ID));
+    route_reroute_t *reroute = calloc(nRoutes, sizeof(route_reroute_t));
+    route_demand_t *endp = calloc(nRoutes, sizeof(route_demand_t));
+    route_status_t *status = calloc(nRoutes, sizeof(route_status_t));
+    route_pars_t pars;
+    epicsTimeStamp start, end;
+    unsigned int r, j, tick;
+    unsigned long numErrors = 0;
+
+    pars.numRoutedAxes = nAxes;
+    pars.Tsync = 0.0;
+    pars.Tcoast = 0.5;
+    for (j = 0; j < nAxes; j++)
+    {
+        pars.routedAxisList[j] = j + 1;
+        pars.axis[j].Amax = 0.5;
+        pars.axis[j].Vmax = 1.0;
+    }
+    for (r = 0; r < nRoutes; r++)
+    {
+        route_demand_t initial;
+
+        benchTarget(r, nAxes, 0, 0.0, tracking, &initial);
+        routes[r] = routeInit(&storage[r], &initial, &pars);
+        result[r] = initial;
+        reroute[r] = ROUTE_NEW_ROUTE;
+    }
+
+    epicsTimeGetCurrent(&start);
+    for (tick = 1; tick <= nTicks; tick++)
+    {
+        double T = tick * DELTA_T;
+
+        for (r = 0; r < nRoutes; r++)
+        {
+            if (tracking || tick % NEW_TARGET == 1)
+                benchTarget(r, nAxes, tick / NEW_TARGET, T, tracking, &endp[r]);
+            result[r].T = T;
+            if (tick % NEW_TARGET == 1) reroute[r] = ROUTE_NEW_ROUTE;
+        }
+        for (r = 0; r < nRoutes; r++)
+        {
+            status[r] = routeFind(routes[r], reroute[r], &endp[r], &result[r]);
+            if (status[r] != ROUTE__OK) numErrors++;
+            reroute[r] = ROUTE_CALC_ROUTE;
+        }
+    }
+    epicsTimeGetCurrent(&end);
+    if (numErrors)
+        printf("%lu route updates returned an error\n", numErrors);
+
+    free(storage);
+    free(routes);
+    free(reroute);
+    free(endp);
+    free(status);
+    return epicsTimeDiffInSeconds(&end, &start);
+}
+
+/* As benchRun, with routeBatchFind.  result has nRoutes*nAxes positions. */
+static double benchRunBatch(unsigned int nRoutes, unsigned int nAxes, unsigned int nTicks,
+                            int tracking, double *result)
+{
+    unsigned int n = nRoutes * nAxes;
+    route_axis_pars_t *axis = calloc(n, sizeof(route_axis_pars_t));
+    route_reroute_t *reroute = calloc(nRoutes, sizeof(route_reroute_t));
+    route_status_t *status = calloc(nRoutes, sizeof(route_status_t));
+    double *endT = calloc(nRoutes, sizeof(double));
+    double *nextT = calloc(nRoutes, sizeof(double));
+    double *endP = calloc(n, sizeof(double));
+    double *endV = calloc(n, sizeof(double));
+    double *nextV = calloc(n, sizeof(double));
+    ROUTE_BATCH_ID batch;
+    epicsTimeStamp start, end;
+    unsigned int r, j, k, tick;
+    unsigned long numErrors = 0;
+
+    for (r = 0; r < nRoutes; r++)
+    {
+        for (j = 0; j < nAxes; j++)
+        {
+            k = r * nAxes + j;
+            axis[k].Amax = 0.5;
+            axis[k].Vmax = 1.0;
+            benchTargetAxis(r, j, 0, 0.0, tracking, &result[k], &nextV[k]);
+        }
+        reroute[r] = ROUTE_NEW_ROUTE;
+    }
+    batch = routeBatchNew(nRoutes, nAxes, 0.0, 0.5, axis, 0.0, result, nextV);
+    if (batch == NULL)
+    {
+        printf("routeBatchNew failed\n");
+        exit(1);
+    }
+
+    epicsTimeGetCurrent(&start);
+    for (tick = 1; tick <= nTicks; tick++)
+    {
+        double T = tick * DELTA_T;
+
+        for (r = 0; r < nRoutes; r++)
+        {
+            if (tracking || tick % NEW_TARGET == 1)
+            {
+                endT[r] = T;
+                for (j = 0; j < nAxes; j++)
+                {
+                    k = r * nAxes + j;
+                    benchTargetAxis(r, j, tick / NEW_TARGET, T, tracking, &endP[k], &endV[k]);
+                }
+            }
+            nextT[r] = T;
+            if (tick % NEW_TARGET == 1) reroute[r] = ROUTE_NEW_ROUTE;
+        }
+        routeBatchFind(batch, reroute, endT, endP, endV, nextT, result, nextV, status);
+        for (r = 0; r < nRoutes; r++)
+        {
+            if (status[r] != ROUTE__OK) numErrors++;
+            reroute[r] = ROUTE_CALC_ROUTE;
+        }
+    }
+    epicsTimeGetCurrent(&end);
+    if (numErrors)
+        printf("%lu batch route updates returned an error\n", numErrors);
+
+    routeBatchDelete(batch);
+    free(axis);
+    free(reroute);
+    free(status);
+    free(endT);
+    free(nextT);
+    free(endP);
+    free(endV);
+    free(nextV);
+    return epicsTimeDiffInSeconds(&end, &start);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int nRoutes = 100;
+    unsigned int nAxes = 3;
+    unsigned int nTicks = 10000;
+    int tracking = 0;
+    route_demand_t *result;
+    double *batchResult;
+    double t, tBatch;
+
+    if (argc > 1) nRoutes = atoi(argv[1]);
+    if (argc > 2) nAxes = atoi(argv[2]);
+    if (argc > 3) nTicks = atoi(argv[3]);
+    if (argc > 4) tracking = atoi(argv[4]);
+    if (nRoutes < 1 || nAxes < 1 || nTicks < 1) {
+        printf("Usage: %s [nRoutes [nAxes [nTicks [tracking]]]]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%u routes, %u axes, %u ticks, %s\n", nRoutes, nAxes, nTicks,
+           tracking ? "tracking" : "moves");
+
+    batchResult = calloc(nRoutes * nAxes, sizeof(double));
+    tBatch = benchRunBatch(nRoutes, nAxes, nTicks, tracking, batchResult);
+    printf("routeBatchFind %f s, %f us per route update\n",
+           tBatch, 1.e6 * tBatch / ((double) nRoutes * nTicks));
+
+    if (nAxes <= NUM_AXES)
+    {
+        double maxDiff = 0.0;
+        unsigned int r, j;
+
+        result = calloc(nRoutes, sizeof(route_demand_t));
+        t = benchRun(nRoutes, nAxes, nTicks, tracking, result);
+        printf("routeFind %f s, %f us per route update\n",
+               t, 1.e6 * t / ((double) nRoutes * nTicks));
+
+        for (r = 0; r < nRoutes; r++)
+            for (j = 0; j < nAxes; j++)
+            {
+                double diff = fabs(result[r].axis[j].p - batchResult[r * nAxes + j]);
+                if (diff > maxDiff) maxDiff = diff;
+            }
+        printf("largest position difference %g\n", maxDiff);
+        free(result);
+    }
+
+    free(batchResult);
+    return 0;
+}
@@ -0,0 +1,408 @@
+#include <math.h>
+#include <stdio.h>     /* For definition of the NULL pointer! */
+#include <scurve.h>
+
+#define LOCAL static
+
+/* Number of bisections used to find the peak velocity of a move that starts
+   moving; enough to reach the resolution of a double */
+#define SCURVE_BISECTIONS 64
+
+/* Largest number of preliminary ramps before the final move of a plan */
+#define SCURVE_MAX_RAMPS 3
+
+
+/*+                      s c u r v e R a m p P h a s e s
+
+   Function Name: scurveRampPhases
+
+   Function: Returns the phase durations of a jerk limited change of velocity
+
+   Description:
+      The time optimal change of velocity by dv ramps the acceleration up at
+      the maximum jerk for tj, holds it for ta and ramps it down again for tj.
+      If the maximum acceleration is not reached ta is zero.
+
+   Call:
+      scurveRampPhases( dv, amax, jmax, &tj, &ta )
+
+*-
+*/
+
+LOCAL void scurveRampPhases( double dv, double amax, double jmax, double * tj, double * ta )
+{
+    dv = fabs( dv );
+    if (dv * jmax >= amax * amax)
+    {
+        *tj = amax / jmax;
+        *ta = dv / amax - *tj;
+    }
+    else
+    {
+        *tj = sqrt( dv / jmax );
+        *ta = 0.0;
+    }
+}
+
+
+/*+                      s c u r v e R a m p T i m e
+
+   Function Name: scurveRampTime
+
+   Function: Returns the time to change velocity by dv
+
+   Description:
+      This function returns the shortest time in which the velocity can change
+      by dv, starting and ending with zero acceleration, without exceeding the
+      maximum acceleration and jerk.  Profile builders can use it to check that
+      acceleration elements are long enough for an axis.
+
+   Call:
+      time = scurveRampTime( dv, amax, jmax )
+
+   Parameters:
+      ("<" input, "!" modified, "W" workspace, ">" output)
+
+      (<) dv       (double)  Change of velocity.
+      (<) amax     (double)  Maximum acceleration, > 0.
+      (<) jmax     (double)  Maximum jerk, > 0.
+
+   Returns:
+      time (double)  Duration of the change of velocity.
+
+*-
+*/
+
+double scurveRampTime( double dv, double amax, double jmax )
+{
+    double tj, ta;
+
+    scurveRampPhases( dv, amax, jmax, &tj, &ta );
+    return 2.0 * tj + ta;
+}
+
+
+/* Adds a constant jerk segment to the end of a plan, starting with acceleration a */
+LOCAL void scurveAppend( scurve_t * plan, double duration, double a, double j )
+{
+    scurve_segment_t * seg;
+
+    if (duration <= 0.0 || plan->numSegments >= SCURVE_MAX_SEGMENTS) return;
+
+    seg = &plan->seg[plan->numSegments++];
+    seg->t0 = plan->T;
+    seg->p = plan->pEnd;
+    seg->v = plan->vEnd;
+    seg->a = a;
+    seg->j = j;
+
+    plan->T += duration;
+    plan->pEnd += duration * (seg->v + duration * (a / 2.0 + duration * j / 6.0));
+    plan->vEnd += duration * (a + duration * j / 2.0);
+}
+
+
+/* Adds a time optimal change of velocity to v1 to the end of a plan */
+LOCAL void scurveRamp( scurve_t * plan, double v1, double amax, double jmax )
+{
+    double v0 = plan->vEnd;
+    double p0 = plan->pEnd;
+    double s = (v1 >= v0) ? 1.0 : -1.0;
+    double tj, ta;
+
+    scurveRampPhases( v1 - v0, amax, jmax, &tj, &ta );
+    scurveAppend( plan, tj, 0.0, s * jmax );
+    scurveAppend( plan, ta, s * jmax * tj, 0.0 );
+    scurveAppend( plan, tj, s * jmax * tj, -s * jmax );
+
+    /* The ramp is symmetric, so the average velocity is exact */
+    plan->pEnd = p0 + (v0 + v1) / 2.0 * (2.0 * tj + ta);
+    plan->vEnd = v1;
+    if (fabs( v1 ) > plan->vPeak) plan->vPeak = fabs( v1 );
+}
+
+
+/* Distance covered ramping from u to vp and then to rest */
+LOCAL double scurveRampDistance( double u, double vp, double amax, double jmax )
+{
+    return (u + vp) / 2.0 * scurveRampTime( vp - u, amax, jmax ) +
+           vp / 2.0 * scurveRampTime( vp, amax, jmax );
+}
+
+
+/*+                      s c u r v e P e a k
+
+   Function Name: scurvePeak
+
+   Function: Returns the peak velocity and coast time of a move
+
+   Description:
+      A move of distance d >= 0, starting at velocity 0 <= u <= vmax, ramps to
+      the peak velocity vp, coasts for tv and ramps to rest.  If vmax is not
+      reached tv is zero and vp solves the distance equation.  From rest this
+      is closed form; otherwise the distance increases with vp and it is found
+      by bisection.  The caller ensures the move can stop within d.
+
+*-
+*/
+
+LOCAL void scurvePeak( double u, double d, double vmax, double amax, double jmax,
+                       double * vp, double * tv )
+{
+    double dmax = scurveRampDistance( u, vmax, amax, jmax );
+    double lo, hi, mid;
+    int i;
+
+    *tv = 0.0;
+    if (dmax <= d)
+    {
+        *vp = vmax;
+        *tv = (d - dmax) / vmax;
+    }
+    else if (u == 0.0)
+    {
+        /* d = vp * scurveRampTime(vp), which is quadratic in vp if amax is reached */
+        if (d >= 2.0 * amax * amax * amax / (jmax * jmax))
+        {
+            double b = amax * amax / jmax;
+            *vp = (-b + sqrt( b * b + 4.0 * amax * d )) / 2.0;
+        }
+        else
+        {
+            *vp = cbrt( d * d * jmax / 4.0 );
+        }
+    }
+    else
+    {
+        lo = u;
+        hi = vmax;
+        for (i = 0; i < SCURVE_BISECTIONS; i++)
+        {
+            mid = (lo + hi) / 2.0;
+            if (scurveRampDistance( u, mid, amax, jmax ) > d) hi = mid;
+            else lo = mid;
+        }
+        *vp = lo;
+    }
+}
+
+
+/*+                      s c u r v e P l a n
+
+   Function Name: scurvePlan
+
+   Function: Plans a jerk limited move to a position
+
+   Description:
+      This function plans the time optimal move from position p0 and velocity
+      v0 to rest at position p1, without exceeding the maximum velocity,
+      acceleration and jerk.  The acceleration is taken to be zero at the start.
+      A move from rest is the usual seven segment S-curve.  If the axis is
+      moving away from p1, or too fast to stop before it, it first ramps to
+      rest; if it is moving faster than vmax it first slows to vmax.
+
+   Call:
+      status = scurvePlan( plan, p0, v0, p1, vmax, amax, jmax )
+
+   Parameters:
+      ("<" input, "!" modified, "W" workspace, ">" output)
+
+      (>) plan     (scurve_t *)  The plan, to be evaluated by scurveEval.
+      (<) p0       (double)      Start position.
+      (<) v0       (double)      Start velocity.
+      (<) p1       (double)      End position.
+      (<) vmax     (double)      Maximum velocity, > 0.
+      (<) amax     (double)      Maximum acceleration, > 0.
+      (<) jmax     (double)      Maximum jerk, > 0.
+
+   Returns:
+      status (scurve_status_t)  SCURVE__OK, or SCURVE__BADPARAM if a limit is not
+                                positive.
+
+*-
+*/
+
+scurve_status_t scurvePlan( scurve_t * plan, double p0, double v0, double p1,
+                            double vmax, double amax, double jmax )
+{
+    double d, s, u, vp, tv;
+    int i;
+
+    if (plan == NULL || !(vmax > 0.0) || !(amax > 0.0) || !(jmax > 0.0)) return SCURVE__BADPARAM;
+
+    plan->numSegments = 0;
+    plan->T = 0.0;
+    plan->pEnd = p0;
+    plan->vEnd = v0;
+    plan->vPeak = fabs( v0 );
+
+    for (i = 0; i < SCURVE_MAX_RAMPS; i++)
+    {
+        d = p1 - plan->pEnd;
+        s = (d >= 0.0) ? 1.0 : -1.0;
+        u = s * plan->vEnd;
+
+        if (u < 0.0 || u / 2.0 * scurveRampTime( u, amax, jmax ) > s * d)
+            scurveRamp( plan, 0.0, amax, jmax );
+        else if (u > vmax)
+            scurveRamp( plan, s * vmax, amax, jmax );
+        else
+            break;
+    }
+
+    d = p1 - plan->pEnd;
+    s = (d >= 0.0) ? 1.0 : -1.0;
+    u = s * plan->vEnd;
+    if (u < 0.0) u = 0.0;
+    if (u > vmax) u = vmax;
+
+    scurvePeak( u, s * d, vmax, amax, jmax, &vp, &tv );
+    scurveRamp( plan, s * vp, amax, jmax );
+    scurveAppend( plan, tv, 0.0, 0.0 );
+    scurveRamp( plan, 0.0, amax, jmax );
+
+    plan->pEnd = p1;
+    plan->vEnd = 0.0;
+    return SCURVE__OK;
+}
+
+
+/*+                      s c u r v e V e l o c i t y
+
+   Function Name: scurveVelocity
+
+   Function: Plans a jerk limited change of velocity
+
+   Description:
+      This function plans the time optimal change from velocity v0 at position
+      p0 to velocity v1.  The axis keeps moving at v1 after the end of the plan.
+
+   Call:
+      status = scurveVelocity( plan, p0, v0, v1, amax, jmax )
+
+   Parameters:
+      ("<" input, "!" modified, "W" workspace, ">" output)
+
+      (>) plan     (scurve_t *)  The plan, to be evaluated by scurveEval.
+      (<) p0       (double)      Start position.
+      (<) v0       (double)      Start velocity.
+      (<) v1       (double)      End velocity.
+      (<) amax     (double)      Maximum acceleration, > 0.
+      (<) jmax     (double)      Maximum jerk, > 0.
+
+   Returns:
+      status (scurve_status_t)  SCURVE__OK, or SCURVE__BADPARAM if a limit is not
+                                positive.
+
+*-
+*/
+
+scurve_status_t scurveVelocity( scurve_t * plan, double p0, double v0, double v1,
+                                double amax, double jmax )
+{
+    if (plan == NULL || !(amax > 0.0) || !(jmax > 0.0)) return SCURVE__BADPARAM;
+
+    plan->numSegments = 0;
+    plan->T = 0.0;
+    plan->pEnd = p0;
+    plan->vEnd = v0;
+    plan->vPeak = fabs( v0 );
+    scurveRamp( plan, v1, amax, jmax );
+    return SCURVE__OK;
+}
+
+
+/*+                      s c u r v e E v a l
+
+   Function Name: scurveEval
+
+   Function: Returns the demand of a plan at a given time
+
+   Description:
+      This function returns the position, velocity and acceleration at time t
+      from the start of the plan.  After the end of the plan the axis moves at
+      the end velocity.  Any of the outputs may be NULL.
+
+   Call:
+      scurveEval( plan, t, &p, &v, &a )
+
+   Parameters:
+      ("<" input, "!" modified, "W" workspace, ">" output)
+
+      (<) plan     (scurve_t *)  Plan from scurvePlan or scurveVelocity.
+      (<) t        (double)      Time from the start of the plan.
+      (>) p        (double *)    Position at time t.
+      (>) v        (double *)    Velocity at time t.
+      (>) a        (double *)    Acceleration at time t.
+
+*-
+*/
+
+void scurveEval( const scurve_t * plan, double t, double * p, double * v, double * a )
+{
+    const scurve_segment_t * seg;
+    double dt;
+    int i;
+
+    if (t >= plan->T || plan->numSegments == 0)
+    {
+        dt = (t > plan->T) ? t - plan->T : 0.0;
+        if (p) *p = plan->pEnd + plan->vEnd * dt;
+        if (v) *v = plan->vEnd;
+        if (a) *a = 0.0;
+        return;
+    }
+
+    for (i = plan->numSegments - 1; i > 0 && plan->seg[i].t0 > t; i--);
+    seg = &plan->seg[i];
+    dt = (t > seg->t0) ? t - seg->t0 : 0.0;
+
+    if (p) *p = seg->p + dt * (seg->v + dt * (seg->a / 2.0 + dt * seg->j / 6.0));
+    if (v) *v = seg->v + dt * (seg->a + dt * seg->j / 2.0);
+    if (a) *a = seg->a + dt * seg->j;
+}
+
+
+/*+                      s c u r v e M o v e T i m e
+
+   Function Name: scurveMoveTime
+
+   Function: Predicts the duration and peak velocity of a move
+
+   Description:
+      This function returns, in closed form, the duration and peak velocity of
+      the time optimal jerk limited move from rest to rest over a distance.
+      It is the same move that scurvePlan would plan, without building it.
+
+   Call:
+      status = scurveMoveTime( distance, vmax, amax, jmax, &time, &vpeak )
+
+   Parameters:
+      ("<" input, "!" modified, "W" workspace, ">" output)
+
+      (<) distance (double)    Distance to move.
+      (<) vmax     (double)    Maximum velocity, > 0.
+      (<) amax     (double)    Maximum acceleration, > 0.
+      (<) jmax     (double)    Maximum jerk, > 0.
+      (>) time     (double *)  Duration of the move.
+      (>) vpeak    (double *)  Largest speed reached, may be NULL.
+
+   Returns:
+      status (scurve_status_t)  SCURVE__OK, or SCURVE__BADPARAM if a limit is not
+                                positive.
+
+*-
+*/
+
+scurve_status_t scurveMoveTime( double distance, double vmax, double amax, double jmax,
+                                double * time, double * vpeak )
+{
+    double vp, tv;
+
+    if (time == NULL || !(vmax > 0.0) || !(amax > 0.0) || !(jmax > 0.0)) return SCURVE__BADPARAM;
+
+    scurvePeak( 0.0, fabs( distance ), vmax, amax, jmax, &vp, &tv );
+    *time = 2.0 * scurveRampTime( vp, amax, jmax ) + tv;
+    if (vpeak) *vpeak = vp;
+    return SCURVE__OK;
+}
@@ -0,0 +1,50 @@
+#ifndef __INCscurveh
+#define __INCscurveh
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest number of constant-jerk segments in a plan: a ramp away from a bad
+   initial velocity, a stop, and a seven segment move */
+#define SCURVE_MAX_SEGMENTS 16
+
+typedef enum
+{
+    SCURVE__OK = 0,
+    SCURVE__BADPARAM = 1
+} scurve_status_t;
+
+typedef struct scurve_segment_str
+{
+    double t0;                        /* Time of the start of the segment         */
+    double p;                         /* Position at t0                           */
+    double v;                         /* Velocity at t0                           */
+    double a;                         /* Acceleration at t0                       */
+    double j;                         /* Jerk for the whole segment               */
+} scurve_segment_t;
+
+typedef struct scurve_str
+{
+    unsigned int numSegments;         /* Number of segments in the plan           */
+    double T;                         /* Duration of the plan                     */
+    double pEnd;                      /* Position at T                            */
+    double vEnd;                      /* Velocity at T, kept after the plan ends  */
+    double vPeak;                     /* Largest speed reached                    */
+    scurve_segment_t seg[SCURVE_MAX_SEGMENTS];
+} scurve_t;
+
+scurve_status_t scurvePlan( scurve_t * plan, double p0, double v0, double p1,
+                            double vmax, double amax, double jmax );
+scurve_status_t scurveVelocity( scurve_t * plan, double p0, double v0, double v1,
+                                double amax, double jmax );
+void scurveEval( const scurve_t * plan, double t, double * p, double * v, double * a );
+scurve_status_t scurveMoveTime( double distance, double vmax, double amax, double jmax,
+                                double * time, double * vpeak );
+double scurveRampTime( double dv, double amax, double jmax );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCscurveh */
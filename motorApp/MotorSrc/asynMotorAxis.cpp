@@ -9,6 +9,8 @@
 #include <string.h>
 
 #include <epicsThread.h>
+#include <epicsTime.h>
+#include <epicsTimer.h>
 
 #include <asynPortDriver.h>
 #define epicsExportSharedSymbols
@@ -17,6 +19,8 @@
 #include "asynMotorController.h"
 
 static const char *driverName = "asynMotorAxis";
+static void asynMotorPowerOnMoveC(void *pPvt);
+static void asynMotorPowerOffC(void *pPvt);
 
 
 /** Creates a new asynMotorAxis object.
@@ -57,6 +61,11 @@ asynMotorAxis::asynMotorAxis(class asynMotorController *pC, int axisNo)
   disableFlag_ = 0;
   lastEndOfMoveTime_ = 0;
 
+  powerOnMoveFunction_ = -1;
+  powerOnMoveValue_ = 0.;
+  powerOnMoveTimer_ = epicsTimerQueueCreateTimer(pC->timerQueue_, asynMotorPowerOnMoveC, this);
+  powerOffTimer_ = epicsTimerQueueCreateTimer(pC->timerQueue_, asynMotorPowerOffC, this);
+
   // Create the asynUser, connect to this axis
   pasynUser_ = pasynManager->createAsynUser(NULL, NULL);
   pasynManager->connectDevice(pasynUser_, pC->portName, axisNo);
@@ -437,7 +446,10 @@ asynStatus asynMotorAxis::readbackProfile()
 
 /****************************************************************************/
 /* The following functions are used by the automatic drive power control in the 
-   base class poller in the asynMotorController class.*/
+   base class poller in the asynMotorController class.
+   disableFlag_ is set while the power off timer is armed.  Timers are disarmed by 
+   clearing the flag rather than by epicsTimerCancel(), which can wait for a running 
+   callback that is itself waiting for the lock.*/
 
 /**
  * Read the flag that indicates if the last poll was moving.
@@ -488,6 +500,118 @@ void asynMotorAxis::setLastEndOfMoveTime(double time)
   lastEndOfMoveTime_ = time;
 }
 
+/**
+ * Start a move after the drive has had time to power on.
+ * The move is started by asynMotorController::startMove() from the controller's
+ * timer queue, so the lock is not held during the delay.  If a move is already
+ * waiting it is replaced by this one, without restarting the delay.
+ * Must be called with the lock held.
+ * \param[in] function One of motorMoveRel_, motorMoveAbs_, motorMoveVel_, or motorHome_.
+ * \param[in] value The value written to function.
+ * \param[in] delay The power on delay in seconds.
+ */
+asynStatus asynMotorAxis::startPowerOnMove(int function, double value, double delay)
+{
+  bool pending = powerOnMovePending();
+
+  powerOnMoveFunction_ = function;
+  powerOnMoveValue_ = value;
+  /* Don't let the poller power off the drive while the move is waiting */
+  setDisableFlag(0);
+  setIntegerParam(pC_->motorStatusDone_, 0);
+  callParamCallbacks();
+  if (!pending) epicsTimerStartDelay(powerOnMoveTimer_, delay);
+  pC_->wakeupPoller();
+  return asynSuccess;
+}
+
+/**
+ * Cancel a move that is waiting for the drive to power on.
+ * The timer is left to expire, because cancelling it could wait for the callback,
+ * which needs the lock.  The drive is powered off as if a move had just ended.
+ * Must be called with the lock held.
+ */
+void asynMotorAxis::cancelPowerOnMove()
+{
+  double autoPowerOffDelay = 0.0;
+
+  if (!powerOnMovePending()) return;
+  powerOnMoveFunction_ = -1;
+  pC_->getDoubleParam(axisNo_, pC_->motorPowerOffDelay_, &autoPowerOffDelay);
+  startPowerOffTimer(autoPowerOffDelay);
+  pC_->wakeupPoller();
+}
+
+/**
+ * Returns true if a move is waiting for the drive to power on.
+ */
+bool asynMotorAxis::powerOnMovePending()
+{
+  return (powerOnMoveFunction_ >= 0);
+}
+
+/**
+ * Called from the controller's timer queue when the power on delay has expired.
+ * Starts the waiting move, unless it was cancelled by a stop.
+ */
+void asynMotorAxis::powerOnMoveCallback()
+{
+  int function;
+
+  pC_->lock();
+  if (powerOnMovePending()) {
+    function = powerOnMoveFunction_;
+    powerOnMoveFunction_ = -1;
+    pC_->startMove(this, function, powerOnMoveValue_);
+  }
+  pC_->unlock();
+}
+
+static void asynMotorPowerOnMoveC(void *pPvt)
+{
+  asynMotorAxis *pAxis = (asynMotorAxis*)pPvt;
+  pAxis->powerOnMoveCallback();
+}
+
+/**
+ * Arm the timer that powers off the drive at the end of a move.
+ * Must be called with the lock held.
+ * \param[in] delay The power off delay in seconds.
+ */
+void asynMotorAxis::startPowerOffTimer(double delay)
+{
+  epicsTimeStamp nowTime;
+
+  epicsTimeGetCurrent(&nowTime);
+  setLastEndOfMoveTime(nowTime.secPastEpoch + (nowTime.nsec / 1.e9));
+  setDisableFlag(1);
+  epicsTimerStartDelay(powerOffTimer_, delay);
+}
+
+/**
+ * Called from the controller's timer queue when the power off delay has expired.
+ * Powers off the drive, unless a new move has started or auto power control has
+ * been disabled since the timer was armed.
+ */
+void asynMotorAxis::powerOffCallback()
+{
+  int autoPower = 0;
+
+  pC_->lock();
+  pC_->getIntegerParam(axisNo_, pC_->motorPowerAutoOnOff_, &autoPower);
+  if ((getDisableFlag() == 1) && (getWasMovingFlag() == 0) && (autoPower == 1)) {
+    setClosedLoop(0);
+    setDisableFlag(0);
+  }
+  pC_->unlock();
+}
+
+static void asynMotorPowerOffC(void *pPvt)
+{
+  asynMotorAxis *pAxis = (asynMotorAxis*)pPvt;
+  pAxis->powerOffCallback();
+}
+
 
 /********************************************************************/
 
@@ -63,6 +63,13 @@ class epicsShareClass asynMotorAxis {
   double getLastEndOfMoveTime();
   void setLastEndOfMoveTime(double time);
 
+  asynStatus startPowerOnMove(int function, double value, double delay);
+  void cancelPowerOnMove();
+  bool powerOnMovePending();
+  void powerOnMoveCallback();  // This should be private but is called from C function
+  void startPowerOffTimer(double delay);
+  void powerOffCallback();     // This should be private but is called from C function
+
   protected:
   class asynMotorController *pC_;    /**< Pointer to the asynMotorController to which this axis belongs.
                                       *   Abbreviated because it is used very frequently */
@@ -81,6 +88,10 @@ class epicsShareClass asynMotorAxis {
   int wasMovingFlag_;
   int disableFlag_;
   double lastEndOfMoveTime_;
+  int powerOnMoveFunction_;          /**< Move function waiting for the drive to power on, -1 if none */
+  double powerOnMoveValue_;          /**< Value written to powerOnMoveFunction_ */
+  epicsTimerId powerOnMoveTimer_;    /**< Timer that starts the move after the power on delay */
+  epicsTimerId powerOffTimer_;       /**< Timer that powers off the drive after the power off delay */
   
   friend class asynMotorController;
 };
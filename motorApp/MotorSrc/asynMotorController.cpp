@@ -136,6 +136,10 @@ asynMotorController::asynMotorController(const char *portName, int numAxes, int
 
   moveToHomeAxis_ = 0;
 
+  timerQueue_ = epicsTimerQueueAllocate(0, epicsThreadPriorityMedium);
+
+  pTrace_ = motorTraceCreate(portName, motorTraceSize);
+
   asynPrint(this->pasynUserSelf, ASYN_TRACE_FLOW,
     "%s:%s: constructor complete\n",
     driverName, functionName);
@@ -194,6 +198,8 @@ asynStatus asynMotorController::writeInt32(asynUser *pasynUser, epicsInt32 value
 
   if (function == motorStop_) {
     double accel;
+    /* Cancel a move that is waiting for the drive to power on */
+    pAxis->cancelPowerOnMove();
     getDoubleParam(axis, motorAccel_, &accel);
     status = pAxis->stop(accel);
   
@@ -247,8 +253,9 @@ asynStatus asynMotorController::writeInt32(asynUser *pasynUser, epicsInt32 value
 /** Called when asyn clients call pasynFloat64->write().
   * Extracts the function and axis number from pasynUser.
   * Sets the value in the parameter library.
-  * If the function is motorMoveRel_, motorMoveAbs_, motorMoveVel_, motorHome_, or motorPosition_,
-  * then it calls pAxis->move(), pAxis->moveVelocity(), pAxis->home(), or pAxis->setPosition().
+  * If the function is motorMoveRel_, motorMoveAbs_, motorMoveVel_, or motorHome_ then it calls startMove(),
+  * or, if automatic power on is enabled with a non-zero delay, pAxis->startPowerOnMove().
+  * If the function is motorPosition_ then it calls pAxis->setPosition().
   * Calls any registered callbacks for this pasynUser->reason and address.  
   * Motor drivers will reimplement this function if they support 
   * controller-specific parameters on the asynFloat64 interface.  They should call this
@@ -258,10 +265,8 @@ asynStatus asynMotorController::writeInt32(asynUser *pasynUser, epicsInt32 value
 asynStatus asynMotorController::writeFloat64(asynUser *pasynUser, epicsFloat64 value)
 {
   int function = pasynUser->reason;
-  double baseVelocity, velocity, acceleration;
   asynMotorAxis *pAxis;
   int axis;
-  int forwards;
   int autoPower = 0;
   double autoPowerOnDelay = 0.0;
   asynStatus status = asynError;
@@ -277,70 +282,21 @@ asynStatus asynMotorController::writeFloat64(asynUser *pasynUser, epicsFloat64 v
   /* Set the parameter and readback in the parameter library. */
   status = pAxis->setDoubleParam(function, value);
 
-  if (function == motorMoveRel_) {
-    if (autoPower == 1) {
-      status = pAxis->setClosedLoop(true);
-      epicsThreadSleep(autoPowerOnDelay);
-    }
-    getDoubleParam(axis, motorVelBase_, &baseVelocity);
-    getDoubleParam(axis, motorVelocity_, &velocity);
-    getDoubleParam(axis, motorAccel_, &acceleration);
-    status = pAxis->move(value, 1, baseVelocity, velocity, acceleration);
-    pAxis->setIntegerParam(motorStatusDone_, 0);
-    pAxis->callParamCallbacks();
-    wakeupPoller();
-    asynPrint(pasynUser, ASYN_TRACE_FLOW, 
-      "%s:%s: Set driver %s, axis %d move relative by %f, base velocity=%f, velocity=%f, acceleration=%f\n",
-      driverName, functionName, portName, pAxis->axisNo_, value, baseVelocity, velocity, acceleration );
-  
-  } else if (function == motorMoveAbs_) {
-    if (autoPower == 1) {
-      status = pAxis->setClosedLoop(true);
-      epicsThreadSleep(autoPowerOnDelay);
-    }
-    getDoubleParam(axis, motorVelBase_, &baseVelocity);
-    getDoubleParam(axis, motorVelocity_, &velocity);
-    getDoubleParam(axis, motorAccel_, &acceleration);
-    status = pAxis->move(value, 0, baseVelocity, velocity, acceleration);
-    pAxis->setIntegerParam(motorStatusDone_, 0);
-    pAxis->callParamCallbacks();
-    wakeupPoller();
-    asynPrint(pasynUser, ASYN_TRACE_FLOW, 
-      "%s:%s: Set driver %s, axis %d move absolute to %f, base velocity=%f, velocity=%f, acceleration=%f\n",
-      driverName, functionName, portName, pAxis->axisNo_, value, baseVelocity, velocity, acceleration );
-
-  } else if (function == motorMoveVel_) {
+  if ((function == motorMoveRel_) || (function == motorMoveAbs_) ||
+      (function == motorMoveVel_) || (function == motorHome_)) {
     if (autoPower == 1) {
       status = pAxis->setClosedLoop(true);
-      epicsThreadSleep(autoPowerOnDelay);
     }
-    getDoubleParam(axis, motorVelBase_, &baseVelocity);
-    getDoubleParam(axis, motorAccel_, &acceleration);
-    status = pAxis->moveVelocity(baseVelocity, value, acceleration);
-    pAxis->setIntegerParam(motorStatusDone_, 0);
-    pAxis->callParamCallbacks();
-    wakeupPoller();
-    asynPrint(pasynUser, ASYN_TRACE_FLOW, 
-      "%s:%s: Set port %s, axis %d move with velocity of %f, acceleration=%f\n",
-      driverName, functionName, portName, pAxis->axisNo_, value, acceleration);
-
-  // Note, the motorHome command happens on the asynFloat64 interface, even though the value (direction) is really integer 
-  } else if (function == motorHome_) {
-    if (autoPower == 1) {
-      status = pAxis->setClosedLoop(true);
-      epicsThreadSleep(autoPowerOnDelay);
+    if ((autoPower == 1) && (autoPowerOnDelay > 0.0)) {
+      /* Start the move from the timer queue once the drive has powered on, 
+       * rather than holding the lock for the delay */
+      status = pAxis->startPowerOnMove(function, value, autoPowerOnDelay);
+      asynPrint(pasynUser, ASYN_TRACE_FLOW, 
+        "%s:%s: Set driver %s, axis %d function %d deferred for %f seconds for power on\n",
+        driverName, functionName, portName, pAxis->axisNo_, function, autoPowerOnDelay);
+    } else {
+      status = startMove(pAxis, function, value);
     }
-    getDoubleParam(axis, motorVelBase_, &baseVelocity);
-    getDoubleParam(axis, motorVelocity_, &velocity);
-    getDoubleParam(axis, motorAccel_, &acceleration);
-    forwards = (value == 0) ? 0 : 1;
-    status = pAxis->home(baseVelocity, velocity, acceleration, forwards);
-    pAxis->setIntegerParam(motorStatusDone_, 0);
-    pAxis->callParamCallbacks();
-    wakeupPoller();
-    asynPrint(pasynUser, ASYN_TRACE_FLOW, 
-      "%s:%s: Set driver %s, axis %d to home %s, base velocity=%f, velocity=%f, acceleration=%f\n",
-      driverName, functionName, portName, pAxis->axisNo_, (forwards?"FORWARDS":"REVERSE"), baseVelocity, velocity, acceleration);
 
   } else if (function == motorPosition_) {
     status = pAxis->setPosition(value);
@@ -529,6 +485,58 @@ asynStatus asynMotorController::setDeferredMoves(bool deferMoves)
   return asynSuccess;
 }
 
+/** Starts a move on an axis.
+  * Called from writeFloat64(), or from the timer queue when the move was waiting for the drive to power on.
+  * Must be called with the lock held.
+  * \param[in] pAxis The axis to move.
+  * \param[in] function One of motorMoveRel_, motorMoveAbs_, motorMoveVel_, or motorHome_.
+  * \param[in] value The value written to function: the position, velocity, or home direction. */
+asynStatus asynMotorController::startMove(asynMotorAxis *pAxis, int function, double value)
+{
+  double baseVelocity, velocity, acceleration;
+  int axis = pAxis->axisNo_;
+  int forwards;
+  asynStatus status = asynError;
+  static const char *functionName = "startMove";
+
+  getDoubleParam(axis, motorVelBase_, &baseVelocity);
+  getDoubleParam(axis, motorVelocity_, &velocity);
+  getDoubleParam(axis, motorAccel_, &acceleration);
+
+  if (function == motorMoveRel_) {
+    status = pAxis->move(value, 1, baseVelocity, velocity, acceleration);
+    asynPrint(pAxis->pasynUser_, ASYN_TRACE_FLOW, 
+      "%s:%s: Set driver %s, axis %d move relative by %f, base velocity=%f, velocity=%f, acceleration=%f\n",
+      driverName, functionName, portName, axis, value, baseVelocity, velocity, acceleration );
+
+  } else if (function == motorMoveAbs_) {
+    status = pAxis->move(value, 0, baseVelocity, velocity, acceleration);
+    asynPrint(pAxis->pasynUser_, ASYN_TRACE_FLOW, 
+      "%s:%s: Set driver %s, axis %d move absolute to %f, base velocity=%f, velocity=%f, acceleration=%f\n",
+      driverName, functionName, portName, axis, value, baseVelocity, velocity, acceleration );
+
+  } else if (function == motorMoveVel_) {
+    status = pAxis->moveVelocity(baseVelocity, value, acceleration);
+    asynPrint(pAxis->pasynUser_, ASYN_TRACE_FLOW, 
+      "%s:%s: Set port %s, axis %d move with velocity of %f, acceleration=%f\n",
+      driverName, functionName, portName, axis, value, acceleration);
+
+  // Note, the motorHome command happens on the asynFloat64 interface, even though the value (direction) is really integer 
+  } else if (function == motorHome_) {
+    forwards = (value == 0) ? 0 : 1;
+    status = pAxis->home(baseVelocity, velocity, acceleration, forwards);
+    asynPrint(pAxis->pasynUser_, ASYN_TRACE_FLOW, 
+      "%s:%s: Set driver %s, axis %d to home %s, base velocity=%f, velocity=%f, acceleration=%f\n",
+      driverName, functionName, portName, axis, (forwards?"FORWARDS":"REVERSE"), baseVelocity, velocity, acceleration);
+  }
+  /* Don't let a pending auto power off disable the drive during the move */
+  pAxis->setDisableFlag(0);
+  pAxis->setIntegerParam(motorStatusDone_, 0);
+  pAxis->callParamCallbacks();
+  wakeupPoller();
+  return status;
+}
+
 /** Returns a pointer to an asynMotorAxis object.
   * Returns NULL if the axis number is invalid.
   * Derived classes will reimplement this function to return a pointer to the derived
@@ -596,6 +604,8 @@ static void asynMotorPollerC(void *drvPvt)
   * any axis is moving.  It will immediately do a poll when asynMotorController::wakeupPoller() is
   * called, and will then do forcedFastPolls_ loops at the movingPollPeriod, before reverting back
   * to the idlePollPeriod_ if no axes are moving. It takes the lock on the port driver when it is polling.
+  * When it sees the end of a move on an axis with automatic power control enabled it starts the
+  * axis power off timer, which runs on the controller timer queue.
   */
 void asynMotorController::asynMotorPoller()
 {
@@ -604,8 +614,6 @@ void asynMotorController::asynMotorPoller()
   int forcedFastPolls=0;
   bool anyMoving;
   bool moving;
-  epicsTimeStamp nowTime;
-  double nowTimeSecs = 0.0;
   asynMotorAxis *pAxis;
   int autoPower = 0;
   double autoPowerOffDelay = 0.0;
@@ -636,37 +644,29 @@ void asynMotorController::asynMotorPoller()
     for (i=0; i<numAxes_; i++) {
       pAxis=getAxis(i);
       if (!pAxis) continue;
-      
-      getIntegerParam(i, motorPowerAutoOnOff_, &autoPower);
-      getDoubleParam(i, motorPowerOffDelay_, &autoPowerOffDelay);
+
+      /* Don't poll an axis whose move is waiting for the drive to power on,
+       * or the idle status would tell the record that the move is done */
+      if (pAxis->powerOnMovePending()) {
+        anyMoving = true;
+        continue;
+      }
       
       pAxis->poll(&moving);
       if (moving) {
-	anyMoving = true;
-	pAxis->setWasMovingFlag(1);
-      } else {
-	if ((pAxis->getWasMovingFlag() == 1) && (autoPower == 1)) {
-	  pAxis->setDisableFlag(1);
-          pAxis->setWasMovingFlag(0);
-          epicsTimeGetCurrent(&nowTime);
-          pAxis->setLastEndOfMoveTime(nowTime.secPastEpoch + (nowTime.nsec / 1.e9));
-	}
-      }
-
-      //Auto power off drive, if:
-      //  We have detected an end of move
-      //  We are not moving again
-      //  Auto power off is enabled
-      //  Auto power off delay timer has expired
-      if ((!moving) && (autoPower == 1) && (pAxis->getDisableFlag() == 1)) {
-	epicsTimeGetCurrent(&nowTime);
-	nowTimeSecs = nowTime.secPastEpoch + (nowTime.nsec / 1.e9);
-	if ((nowTimeSecs - pAxis->getLastEndOfMoveTime()) >= autoPowerOffDelay) {
-	  pAxis->setClosedLoop(0);
-	  pAxis->setDisableFlag(0);
-	}
+        anyMoving = true;
+        /* A new move cancels a pending auto power off */
+        pAxis->setDisableFlag(0);
+        pAxis->setWasMovingFlag(1);
+      } else if (pAxis->getWasMovingFlag() == 1) {
+        /* End of move, start the auto power off timer if enabled */
+        pAxis->setWasMovingFlag(0);
+        getIntegerParam(i, motorPowerAutoOnOff_, &autoPower);
+        if (autoPower == 1) {
+          getDoubleParam(i, motorPowerOffDelay_, &autoPowerOffDelay);
+          pAxis->startPowerOffTimer(autoPowerOffDelay);
+        }
       }
-
     }
     if (forcedFastPolls > 0) {
       timeout = movingPollPeriod_;
@@ -742,10 +742,13 @@ asynStatus asynMotorController::writeController(const char *output, double timeo
 {
   size_t nwrite;
   asynStatus status;
+  epicsTimeStamp sendTime;
   // const char *functionName="writeController";
   
+  if (pTrace_) epicsTimeGetCurrent(&sendTime);
   status = pasynOctetSyncIO->write(pasynUserController_, output,
                                    strlen(output), timeout, &nwrite);
+  if (pTrace_) motorTraceRecord(pTrace_, output, &sendTime, 0, status);
                                   
   return status ;
 }
@@ -771,15 +774,118 @@ asynStatus asynMotorController::writeReadController(const char *output, char *in
   size_t nwrite;
   asynStatus status;
   int eomReason;
+  epicsTimeStamp sendTime;
   // const char *functionName="writeReadController";
   
+  if (pTrace_) epicsTimeGetCurrent(&sendTime);
   status = pasynOctetSyncIO->writeRead(pasynUserController_, output,
                                        strlen(output), input, maxChars, timeout,
                                        &nwrite, nread, &eomReason);
+  if (pTrace_) motorTraceRecord(pTrace_, output, &sendTime, *nread, status);
                         
   return status;
 }
 
+/** Sends a batch of commands to the controller without waiting for each reply before sending
+  * the next one, and matches the replies to the commands in order.
+  * Up to maxPending commands are sent back to back; a new command is sent each time a reply has
+  * been read.  This removes the round trip per query on serial and TCP links for controllers
+  * that buffer their input and answer commands in the order received.
+  * A command that fails to be written fails on its own.  If a reply times out or overflows its
+  * buffer the replies still in flight can no longer be matched to their commands, so the batch
+  * is aborted: the input is flushed, every command after the failed one fails with asynError and
+  * the commands not yet sent are dropped.  The input is also flushed before the batch is sent, which discards late
+  * replies left over from an aborted batch.
+  * The batch is not atomic on the IO port, so controllers that share their IO port with other
+  * drivers should keep using writeReadController().
+  * \param[in,out] transactions Array of commands; the responseLen and status fields are set.
+  * \param[in] numTransactions Number of elements in transactions.
+  * \param[in] maxPending Maximum number of replies outstanding; 1 is the same as calling
+  *            writeReadController() for each command.
+  * \return asynSuccess if every command succeeded, otherwise the status of the first that failed. */
+asynStatus asynMotorController::writeReadControllerPipelined(asynMotorTransaction *transactions,
+                                                             int numTransactions, int maxPending)
+{
+  asynMotorTransaction *pT;
+  int next = 0;   /* Next command to send */
+  int done = 0;   /* Oldest command whose reply has not been read */
+  int i;
+  size_t nwrite;
+  int eomReason;
+  char portEos[MAX_CONTROLLER_EOS_SIZE];
+  int portEosLen = 0;
+  double timeout;
+  asynStatus status;
+  asynStatus firstStatus = asynSuccess;
+  static const char *functionName = "writeReadControllerPipelined";
+
+  if (maxPending < 1) maxPending = 1;
+  for (i=0; i<numTransactions; i++) {
+    pT = &transactions[i];
+    pT->responseLen = 0;
+    pT->status = asynSuccess;
+    if (pT->response && (pT->maxResponseLen > 0)) pT->response[0] = 0;
+  }
+  pasynOctetSyncIO->getInputEos(pasynUserController_, portEos, sizeof(portEos), &portEosLen);
+  pasynOctetSyncIO->flush(pasynUserController_);
+
+  while (done < numTransactions) {
+    /* Send commands until maxPending replies are outstanding */
+    while ((next < numTransactions) && (next - done < maxPending)) {
+      pT = &transactions[next++];
+      timeout = (pT->timeout > 0.) ? pT->timeout : DEFAULT_CONTROLLER_TIMEOUT;
+      if (pTrace_) epicsTimeGetCurrent(&pT->sendTime);
+      status = pasynOctetSyncIO->write(pasynUserController_, pT->command,
+                                       strlen(pT->command), timeout, &nwrite);
+      if (pTrace_ && (status || !pT->response))
+        motorTraceRecord(pTrace_, pT->command, &pT->sendTime, 0, status);
+      if (status) {
+        asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+          "%s:%s: error writing %s, status=%d\n",
+          driverName, functionName, pT->command, status);
+        pT->status = status;
+      }
+    }
+
+    /* Read the reply to the oldest command */
+    pT = &transactions[done++];
+    if (!pT->response || pT->status) continue;
+    timeout = (pT->timeout > 0.) ? pT->timeout : DEFAULT_CONTROLLER_TIMEOUT;
+    if (pT->inputEos)
+      pasynOctetSyncIO->setInputEos(pasynUserController_, pT->inputEos, (int)strlen(pT->inputEos));
+    status = pasynOctetSyncIO->read(pasynUserController_, pT->response, pT->maxResponseLen,
+                                    timeout, &pT->responseLen, &eomReason);
+    if ((status == asynSuccess) && (eomReason == ASYN_EOM_CNT) &&
+        (pT->inputEos ? (strlen(pT->inputEos) > 0) : (portEosLen > 0))) {
+      /* The reply did not fit; the rest of it would be taken as the next reply */
+      status = asynOverflow;
+    }
+    if (pT->inputEos)
+      pasynOctetSyncIO->setInputEos(pasynUserController_, portEos, portEosLen);
+    if (pTrace_) motorTraceRecord(pTrace_, pT->command, &pT->sendTime, pT->responseLen, status);
+    if (status) {
+      asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+        "%s:%s: error reading reply to %s, status=%d, %d commands outstanding\n",
+        driverName, functionName, pT->command, status, next - done);
+      pT->status = status;
+      pasynOctetSyncIO->flush(pasynUserController_);
+      /* Abort the rest of the batch, sent or not */
+      for (; done < numTransactions; done++) {
+        if (!transactions[done].status)
+          transactions[done].status = asynError;
+      }
+    }
+  }
+
+  for (i=0; i<numTransactions; i++) {
+    if (transactions[i].status) {
+      firstStatus = transactions[i].status;
+      break;
+    }
+  }
+  return firstStatus;
+}
+
 
 
 /* These are the functions for profile moves */
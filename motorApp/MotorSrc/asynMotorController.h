@@ -9,10 +9,14 @@
 #define asynMotorController_H
 
 #include <epicsEvent.h>
+#include <epicsTimer.h>
 #include <epicsTypes.h>
 
+#include "motorTrace.h"
+
 #define MAX_CONTROLLER_STRING_SIZE 256
 #define DEFAULT_CONTROLLER_TIMEOUT 2.0
+#define MAX_CONTROLLER_EOS_SIZE 8
 
 /** Strings defining parameters for the driver. 
   * These are the values passed to drvUserCreate. 
@@ -150,6 +154,18 @@ enum ProfileStatus {
 #ifdef __cplusplus
 #include <asynPortDriver.h>
 
+/** One command of a batch sent with asynMotorController::writeReadControllerPipelined() */
+typedef struct asynMotorTransaction {
+  const char *command;      /**< String to send; the output EOS of the port is appended */
+  char *response;           /**< Buffer for the reply, or NULL for a command that has no reply */
+  size_t maxResponseLen;    /**< Size of the response buffer */
+  const char *inputEos;     /**< Terminator of the reply, or NULL for the input EOS of the port */
+  double timeout;           /**< Timeout for the reply; 0 for DEFAULT_CONTROLLER_TIMEOUT */
+  size_t responseLen;       /**< Output: number of characters read */
+  asynStatus status;        /**< Output: status of this command */
+  epicsTimeStamp sendTime;  /**< Output: time the command was sent */
+} asynMotorTransaction;
+
 class asynMotorAxis;
 
 class epicsShareClass asynMotorController : public asynPortDriver {
@@ -177,6 +193,7 @@ class epicsShareClass asynMotorController : public asynPortDriver {
   virtual asynStatus wakeupPoller();
   virtual asynStatus poll();
   virtual asynStatus setDeferredMoves(bool defer);
+  virtual asynStatus startMove(asynMotorAxis *pAxis, int function, double value);
   void asynMotorPoller();  // This should be private but is called from C function
   
   /* Functions to deal with moveToHome.*/
@@ -298,14 +315,18 @@ class epicsShareClass asynMotorController : public asynPortDriver {
 
   int moveToHomeAxis_;
 
+  epicsTimerQueueId timerQueue_; /**< Timer queue for delayed axis actions, e.g. moves waiting for auto power on */
+
   /* These are convenience functions for controllers that use asynOctet interfaces to the hardware */
   asynStatus writeController();
   asynStatus writeController(const char *output, double timeout);
   asynStatus writeReadController();
   asynStatus writeReadController(const char *output, char *response, size_t maxResponseLen, size_t *responseLen, double timeout);
+  asynStatus writeReadControllerPipelined(asynMotorTransaction *transactions, int numTransactions, int maxPending);
   asynUser *pasynUserController_;
   char outString_[MAX_CONTROLLER_STRING_SIZE];
   char inString_[MAX_CONTROLLER_STRING_SIZE];
+  motorTrace *pTrace_;          /**< Trace of the transactions above, NULL if motorTraceSize is 0 */
 
   friend class asynMotorAxis;
 };
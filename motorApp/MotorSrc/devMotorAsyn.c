@@ -43,6 +43,16 @@
  * Added "Use Relative" (use_rel) indicator to init_controller()'s "LOAD_POS" logic.
  * See README R6-10 item #6 for details.
  * 
+ * .07 2026-10-19
+ * Optional coalesced status delivery (devMotorAsynCoalesce).  statusCallback()
+ * stores the latest MotorStatus and queues one callback to process the record,
+ * instead of processing it on the driver's poller thread.  Added a dset report
+ * with status delivery counters.
+ * 
+ * .08 2026-10-19
+ * update_values() defers posting RMP, REP and RVEL to the motor record while it
+ * is decimating readback monitors (MDEC set from the Max Monitor Rate, MMXR).
+ * 
  */
 
 #include <stddef.h>
@@ -58,6 +68,8 @@
 #include <devSup.h>
 #include <alarm.h>
 #include <epicsEvent.h>
+#include <epicsMutex.h>
+#include <callback.h>
 #include <cantProceed.h> /* !! for callocMustSucceed() */
 #include <dbEvent.h>
 
@@ -76,6 +88,7 @@
 #include "motor_interface.h"
 
 /*Create the dset for devMotor */
+static long report( int interest );
 static long init( int after );
 static long init_record(struct motorRecord *);
 static CALLBACK_VALUE update_values(struct motorRecord *);
@@ -84,13 +97,14 @@ static RTN_STATUS build_trans( motor_cmnd, double *, struct motorRecord *);
 static RTN_STATUS end_trans(struct motorRecord *);
 static void asynCallback(asynUser *);
 static void statusCallback(void *, asynUser *, void *);
+static void processStatus(CALLBACK *);
 
 typedef enum {int32Type, float64Type, float64ArrayType} interfaceType;
 
 struct motor_dset devMotorAsyn={ 
     {
          8,
-         NULL,
+         (DEVSUPFUN) report,
          (DEVSUPFUN) init,
          (DEVSUPFUN) init_record,
          NULL 
@@ -103,6 +117,13 @@ struct motor_dset devMotorAsyn={
 
 epicsExportAddress(dset,devMotorAsyn);
 
+/* When nonzero, statusCallback() only stores the latest status and queues a
+ * callback to process the record, so that the driver's poller does not wait for
+ * record processing and bursts of status changes are processed once.
+ * Set it with "var devMotorAsynCoalesce 1" before iocInit. */
+int devMotorAsynCoalesce = 0;
+epicsExportAddress(int, devMotorAsynCoalesce);
+
 /* Note, we define these commands here.  These are not pasynUser->reason, they are
  * an index into those reasons returned from driver */
 typedef enum motorCommand {
@@ -136,7 +157,7 @@ typedef struct {
     double dvalue;
 } motorAsynMessage;
 
-typedef struct
+typedef struct motorAsynPvt
 {
     struct motorRecord * pmr;
     int moveRequestPending;
@@ -158,8 +179,21 @@ typedef struct
     void *registrarPvt;
     epicsEventId initEvent;
     int driverReasons[NUM_MOTOR_COMMANDS];
+    /* Coalesced status delivery */
+    epicsMutexId statusLock;        /* Protects pendingStatus and statusPending */
+    struct MotorStatus pendingStatus;
+    int statusPending;              /* A processStatus() callback is queued */
+    CALLBACK statusCallback;
+    /* Status delivery counters, for report() */
+    unsigned long numStatusUpdates; /* Calls to statusCallback() */
+    unsigned long numCoalesced;     /* Updates merged into an already queued callback */
+    unsigned long numQueueFull;     /* Updates processed directly because the callback queue was full */
+    struct motorAsynPvt *next;      /* Next record in pvtList */
 } motorAsynPvt;
 
+/* All records using this device support, for report() */
+static motorAsynPvt *pvtList = NULL;
+
 
 
 /* The init routine is used to set a flag to indicate that it is OK to call dbScanLock */
@@ -170,6 +204,26 @@ static long init( int after )
     return 0;
 }
 
+static long report( int interest )
+{
+    motorAsynPvt *pPvt;
+    int numRecords = 0;
+    unsigned long numStatusUpdates = 0, numCoalesced = 0, numQueueFull = 0;
+
+    for (pPvt = pvtList; pPvt; pPvt = pPvt->next) {
+        numRecords++;
+        numStatusUpdates += pPvt->numStatusUpdates;
+        numCoalesced += pPvt->numCoalesced;
+        numQueueFull += pPvt->numQueueFull;
+        if (interest > 0)
+            printf("    %s: status updates=%lu, coalesced=%lu, queue full=%lu\n",
+                   pPvt->pmr->name, pPvt->numStatusUpdates, pPvt->numCoalesced, pPvt->numQueueFull);
+    }
+    printf("    devMotorAsyn: %d records, coalesce=%d, status updates=%lu, coalesced=%lu, queue full=%lu\n",
+           numRecords, devMotorAsynCoalesce, numStatusUpdates, numCoalesced, numQueueFull);
+    return 0;
+}
+
 static void init_controller(struct motorRecord *pmr, asynUser *pasynUser )
 {
     /* This routine is copied out of the old motordevCom and initialises the controller
@@ -251,6 +305,12 @@ static long init_record(struct motorRecord * pmr )
     pPvt->pasynUser = pasynUser;
     pPvt->pmr = pmr;
     pmr->dpvt = pPvt;
+    pPvt->statusLock = epicsMutexMustCreate();
+    callbackSetCallback(processStatus, &pPvt->statusCallback);
+    callbackSetPriority(pmr->prio, &pPvt->statusCallback);
+    callbackSetUser(pPvt, &pPvt->statusCallback);
+    pPvt->next = pvtList;
+    pvtList = pPvt;
 
     status = pasynEpicsUtils->parseLink(pasynUser, &pmr->out,
                                         &port, &signal, &userParam);
@@ -417,18 +477,27 @@ CALLBACK_VALUE update_values(struct motorRecord * pmr)
     {
         epicsInt32 rawvalue;
 
+        /* While the record is decimating monitors (MMXR), leave the posting
+         * of RMP, REP and RVEL to the record. */
+
         rawvalue = (epicsInt32)floor(pPvt->status.position + 0.5);
         if (pmr->rmp != rawvalue)
         {
             pmr->rmp = rawvalue;
-            db_post_events(pmr, &pmr->rmp, DBE_VAL_LOG);
+            if (pmr->mdec)
+                pmr->mdfr = 1;
+            else
+                db_post_events(pmr, &pmr->rmp, DBE_VAL_LOG);
         }
 
         rawvalue = (epicsInt32)floor(pPvt->status.encoderPosition + 0.5);
         if (pmr->rep != rawvalue)
         {
             pmr->rep = rawvalue;
-            db_post_events(pmr, &pmr->rep, DBE_VAL_LOG);
+            if (pmr->mdec)
+                pmr->mdfr = 1;
+            else
+                db_post_events(pmr, &pmr->rep, DBE_VAL_LOG);
         }
 
         /* Don't post MSTA changes here; motor record's process() function does efficent MSTA posting. */
@@ -438,7 +507,10 @@ CALLBACK_VALUE update_values(struct motorRecord * pmr)
         if (pmr->rvel != rawvalue)
         {
             pmr->rvel = rawvalue;
-            db_post_events(pmr, &pmr->rvel, DBE_VAL_LOG);
+            if (pmr->mdec)
+                pmr->mdfr = 1;
+            else
+                db_post_events(pmr, &pmr->rvel, DBE_VAL_LOG);
         }
 
         rc = CALLBACK_DATA;
@@ -718,6 +790,7 @@ static void statusCallback(void *drvPvt, asynUser *pasynUser,
     motorAsynPvt *pPvt = (motorAsynPvt *)drvPvt;
     motorRecord *pmr = pPvt->pmr;
     MotorStatus *value = (MotorStatus *)pValue;
+    int queue;
 
     asynPrint(pasynUser, ASYN_TRACEIO_DEVICE,
               "%s devMotorAsyn::statusCallback new value=[p:%f,e:%f,s:%x] %c%c\n",
@@ -725,6 +798,29 @@ static void statusCallback(void *drvPvt, asynUser *pasynUser,
               pPvt->needUpdate ? 'N':' ', 
               pPvt->moveRequestPending ? 'P':' ');
 
+    if (dbScanLockOK && devMotorAsynCoalesce) {
+        /* Keep only the latest status; a queued callback will process it */
+        epicsMutexLock(pPvt->statusLock);
+        pPvt->numStatusUpdates++;
+        memcpy(&pPvt->pendingStatus, value, sizeof(struct MotorStatus));
+        queue = !pPvt->statusPending;
+        if (queue)
+            pPvt->statusPending = 1;
+        else
+            pPvt->numCoalesced++;
+        epicsMutexUnlock(pPvt->statusLock);
+        if (queue && callbackRequest(&pPvt->statusCallback) != 0) {
+            /* Callback queue full; process the record here rather than lose
+             * the update, which may be the final one of a move. */
+            epicsMutexLock(pPvt->statusLock);
+            pPvt->numQueueFull++;
+            epicsMutexUnlock(pPvt->statusLock);
+            processStatus(&pPvt->statusCallback);
+        }
+        return;
+    }
+
+    pPvt->numStatusUpdates++;
     if (dbScanLockOK) {
         dbScanLock((dbCommon *)pmr);
         memcpy(&pPvt->status, value, sizeof(struct MotorStatus));
@@ -740,3 +836,26 @@ static void statusCallback(void *drvPvt, asynUser *pasynUser,
     }
 }
 
+/**
+ * Callback queued by statusCallback() in coalesced mode.  Processes the record
+ * once with the latest status delivered since the callback was queued.
+ */
+static void processStatus(CALLBACK *pcallback)
+{
+    motorAsynPvt *pPvt;
+    motorRecord *pmr;
+
+    callbackGetUser(pPvt, pcallback);
+    pmr = pPvt->pmr;
+    dbScanLock((dbCommon *)pmr);
+    epicsMutexLock(pPvt->statusLock);
+    memcpy(&pPvt->status, &pPvt->pendingStatus, sizeof(struct MotorStatus));
+    /* Updates from now on need another callback */
+    pPvt->statusPending = 0;
+    epicsMutexUnlock(pPvt->statusLock);
+    if (!pPvt->moveRequestPending) {
+        pPvt->needUpdate = 1;
+        dbProcess((dbCommon*)pmr);
+    }
+    dbScanUnlock((dbCommon*)pmr);
+}
@@ -149,7 +149,35 @@ static motorCommandStruct motorCommands[] = {
     {motorStatusHomed,          motorStatusHomedString},
 };
 
-typedef enum{typeInt32, typeFloat64, typeFloat64Array} dataType;
+typedef enum{typeInt32, typeFloat64, typeFloat64Array, typeGenericPointer} dataType;
+
+/* Number of distinct pasynUser->reason values returned by drvUserCreate */
+#define NUM_MOTOR_REASONS (motorUpdateStatus + 1)
+
+/* Interrupt clients of one interface, grouped by axis and reason, so that
+   intCallback only visits the clients interested in a change.  The clients
+   for axis a and reason r are clients[first[s]] to clients[first[s+1]-1],
+   where s = a*NUM_MOTOR_REASONS + r.  genericPointer clients are grouped by
+   axis only, with r = 0.  The table is rebuilt from the asyn interrupt list
+   on the first callback after a client registers or cancels.
+   intCallback copies the clients of its axis out of the table with
+   pPvt->lock held and calls them after releasing it, since the callbacks
+   take dbScanLock and device support registers and cancels with
+   dbScanLock held.
+   asyn only adds and removes clients at the end of the last active
+   interruptStart/interruptEnd pass, so a table built during a pass may miss
+   a client registered during it.  The passes are counted in active, and the
+   table is invalidated again when the last one ends if a client registered
+   or cancelled meanwhile. */
+#define MAX_AXIS_SUBSCRIBERS 64    /* Clients of one axis copied without malloc */
+
+typedef struct {
+    int valid;
+    int active;                    /* interruptStart/interruptEnd passes in progress */
+    int changed;                   /* A client registered or cancelled during a pass */
+    int *first;
+    void **clients;
+} subscriberTable;
 
 struct drvmotorPvt;
 
@@ -191,6 +219,10 @@ typedef struct drvmotorPvt {
     void *genericPointerInterruptPvt;
     asynInterface drvUser;
     asynUser *pasynUser;
+    /* Interrupt clients, protected by lock */
+    subscriberTable int32Subscribers;
+    subscriberTable float64Subscribers;
+    subscriberTable genericPointerSubscribers;
 } drvmotorPvt;
 
 /* These functions are used by the interfaces */
@@ -224,6 +256,14 @@ static asynStatus disconnect        (void *drvPvt, asynUser *pasynUser);
 
 /* These are private functions, not used in any interfaces */
 static void intCallback(void *drvPvt, unsigned int num, unsigned int *changed);
+static void buildSubscribers(drvmotorPvt *pPvt, subscriberTable *pTable,
+                             dataType type, ELLLIST *pclientList);
+static void **copySubscribers(drvmotorPvt *pPvt, subscriberTable *pTable, dataType type,
+                              ELLLIST *pclientList, int axis, int *first, void **buffer);
+static void startSubscribers(drvmotorPvt *pPvt, subscriberTable *pTable, void *interruptPvt,
+                             ELLLIST **ppclientList);
+static void endSubscribers(drvmotorPvt *pPvt, subscriberTable *pTable, void *interruptPvt);
+static void installInterruptHooks(void);
 static int config      (drvmotorPvt *pPvt);
 static int logFunc     (void *userParam,
                         const motorAxisLogMask_t logMask,
@@ -276,6 +316,21 @@ static asynDrvUser drvMotorDrvUser = {
 
 static asynUser *defaultAsynUser;
 
+/* Default interrupt registration functions filled in by the asyn base
+   interfaces, which the hooks below call before invalidating the tables */
+static asynStatus (*int32RegisterInterruptUser)(void *drvPvt, asynUser *pasynUser,
+                       interruptCallbackInt32 callback, void *userPvt, void **registrarPvt);
+static asynStatus (*int32CancelInterruptUser)(void *drvPvt, asynUser *pasynUser,
+                       void *registrarPvt);
+static asynStatus (*float64RegisterInterruptUser)(void *drvPvt, asynUser *pasynUser,
+                       interruptCallbackFloat64 callback, void *userPvt, void **registrarPvt);
+static asynStatus (*float64CancelInterruptUser)(void *drvPvt, asynUser *pasynUser,
+                       void *registrarPvt);
+static asynStatus (*genericPointerRegisterInterruptUser)(void *drvPvt, asynUser *pasynUser,
+                       interruptCallbackGenericPointer callback, void *userPvt, void **registrarPvt);
+static asynStatus (*genericPointerCancelInterruptUser)(void *drvPvt, asynUser *pasynUser,
+                       void *registrarPvt);
+
 
 int drvAsynMotorConfigure(const char *portName, const char *driverName,
               int card, int num_axes)
@@ -374,6 +429,8 @@ int drvAsynMotorConfigure(const char *portName, const char *driverName,
         errlogPrintf("drvAsynMotorConfigure ERROR: Can't register drvUser\n");
         return -1;
     }
+    installInterruptHooks();
+
     /* Create asynUser for debugging */
     pPvt->pasynUser = pasynManager->createAsynUser(0, 0);
 
@@ -830,14 +887,16 @@ static void intCallback(void *axisPvt, unsigned int nChanged,
 {
     drvmotorAxisPvt *pAxis = (drvmotorAxisPvt *)axisPvt;
     drvmotorPvt *pPvt = pAxis->pPvt;
-    int addr;
-    unsigned int reason;
     ELLLIST *pclientList;
-    interruptNode *pnode;
+    void *buffer[MAX_AXIS_SUBSCRIBERS];
+    void **clients;
+    int first[NUM_MOTOR_REASONS + 1];
     int ivalue;
     double dvalue;
     unsigned int i, bit_num;
+    int reason, j;
     epicsInt32 changedmask = 0;
+    int statusValues[motorStatusLast - motorStatusDirection];
 
     /* We are called back with an array of things that have changed.
        First put these into a single int32 word for passing up to higher layers
@@ -850,6 +909,7 @@ static void intCallback(void *axisPvt, unsigned int nChanged,
             changedmask |= (1 << bit_num);
             (*pPvt->drvset->getInteger)(pAxis->axis, changed[i], &ivalue);
             BIT_SET(bit_num, &(pAxis->status.status), ivalue);
+            statusValues[bit_num] = ivalue;
         }
         if (changed[i] == motorPosition) {
             (*pPvt->drvset->getDouble)(pAxis->axis, changed[i], 
@@ -865,80 +925,286 @@ static void intCallback(void *axisPvt, unsigned int nChanged,
         }
     }
 
-    /* Pass float64 interrupts */
-    pasynManager->interruptStart(pPvt->float64InterruptPvt, &pclientList);
-    pnode = (interruptNode *)ellFirst(pclientList);
-    while (pnode) {
-        asynFloat64Interrupt *pfloat64Interrupt = pnode->drvPvt;
-        addr = pfloat64Interrupt->addr;
-        reason = pfloat64Interrupt->pasynUser->reason;
-        if (addr == pAxis->num) {
-            for (i = 0; i < nChanged; i++) {
-                if (changed[i] == reason) {
-                    (*pPvt->drvset->getDouble)(pAxis->axis, changed[i], &dvalue);
-                    pfloat64Interrupt->callback(pfloat64Interrupt->userPvt, 
-                                pfloat64Interrupt->pasynUser,
-                                dvalue);
-                }
-            }
+    /* Pass float64 interrupts, fetching each changed value once */
+    startSubscribers(pPvt, &pPvt->float64Subscribers, pPvt->float64InterruptPvt, &pclientList);
+    clients = copySubscribers(pPvt, &pPvt->float64Subscribers, typeFloat64, pclientList,
+                              pAxis->num, first, buffer);
+    for (i = 0; i < nChanged; i++) {
+        if (changed[i] >= NUM_MOTOR_REASONS) continue;
+        reason = changed[i];
+        if (first[reason] == first[reason+1]) continue;
+        (*pPvt->drvset->getDouble)(pAxis->axis, reason, &dvalue);
+        for (j = first[reason]; j < first[reason+1]; j++) {
+            asynFloat64Interrupt *pfloat64Interrupt = clients[j];
+            pfloat64Interrupt->callback(pfloat64Interrupt->userPvt, 
+                        pfloat64Interrupt->pasynUser,
+                        dvalue);
         }
-        pnode = (interruptNode *)ellNext(&pnode->node);
     }
-    pasynManager->interruptEnd(pPvt->float64InterruptPvt);
+    endSubscribers(pPvt, &pPvt->float64Subscribers, pPvt->float64InterruptPvt);
+    if (clients != buffer) free(clients);
 
     /* Pass motorStatus interrupts */
-    pasynManager->interruptStart(pPvt->genericPointerInterruptPvt, &pclientList);
-    pnode = (interruptNode *)ellFirst(pclientList);
-    while (pnode) {
-        asynGenericPointerInterrupt *pInterrupt = pnode->drvPvt;
-        addr = pInterrupt->addr;
-        reason = pInterrupt->pasynUser->reason;
-        if (addr == pAxis->num) {
-            pInterrupt->callback(pInterrupt->userPvt, 
-                            pInterrupt->pasynUser,
-                            (void *)&pAxis->status);
-        }
-        pnode = (interruptNode *)ellNext(&pnode->node);
+    startSubscribers(pPvt, &pPvt->genericPointerSubscribers, pPvt->genericPointerInterruptPvt, &pclientList);
+    clients = copySubscribers(pPvt, &pPvt->genericPointerSubscribers, typeGenericPointer,
+                              pclientList, pAxis->num, first, buffer);
+    for (j = first[0]; j < first[1]; j++) {
+        asynGenericPointerInterrupt *pInterrupt = clients[j];
+        pInterrupt->callback(pInterrupt->userPvt, 
+                        pInterrupt->pasynUser,
+                        (void *)&pAxis->status);
     }
-    pasynManager->interruptEnd(pPvt->genericPointerInterruptPvt);
+    endSubscribers(pPvt, &pPvt->genericPointerSubscribers, pPvt->genericPointerInterruptPvt);
+    if (clients != buffer) free(clients);
 
     /* Pass int32 interrupts */
-    pasynManager->interruptStart(pPvt->int32InterruptPvt, &pclientList);
-    pnode = (interruptNode *)ellFirst(pclientList);
-    while (pnode) {
-        asynInt32Interrupt *pint32Interrupt = pnode->drvPvt;
-        addr = pint32Interrupt->addr;
-        reason = pint32Interrupt->pasynUser->reason;
-        if (addr == pAxis->num) {
-            if ( reason >= motorStatusDirection && 
+    startSubscribers(pPvt, &pPvt->int32Subscribers, pPvt->int32InterruptPvt, &pclientList);
+    clients = copySubscribers(pPvt, &pPvt->int32Subscribers, typeInt32, pclientList,
+                              pAxis->num, first, buffer);
+    for (reason = 0; reason < NUM_MOTOR_REASONS; reason++) {
+        if (first[reason] == first[reason+1]) continue;
+        if ( reason >= motorStatusDirection && 
              reason < motorStatusLast ) {
-                if (BIT_ISSET(reason - motorStatusDirection, 1, &changedmask))
-                {
-                    (*pPvt->drvset->getInteger)(pAxis->axis, reason, &ivalue);
-                    pint32Interrupt->callback(pint32Interrupt->userPvt, 
-                                  pint32Interrupt->pasynUser,
-                                  ivalue);
-                }
-            }
-            /* If we've subscribed to the aggregate status */
-            else if (reason == motorStatus) {
-                pint32Interrupt->callback(pint32Interrupt->userPvt,
-                          pint32Interrupt->pasynUser,
-                          pAxis->status.status);
-            }
-            else {
-                (*pPvt->drvset->getInteger)(pAxis->axis, reason, &ivalue);
-                          pint32Interrupt->callback(pint32Interrupt->userPvt, 
+            /* Status bits are only passed when they changed */
+            if (!BIT_ISSET(reason - motorStatusDirection, 1, &changedmask)) continue;
+            ivalue = statusValues[reason - motorStatusDirection];
+        }
+        /* If we've subscribed to the aggregate status */
+        else if (reason == motorStatus) {
+            ivalue = pAxis->status.status;
+        }
+        else {
+            (*pPvt->drvset->getInteger)(pAxis->axis, reason, &ivalue);
+        }
+        for (j = first[reason]; j < first[reason+1]; j++) {
+            asynInt32Interrupt *pint32Interrupt = clients[j];
+            pint32Interrupt->callback(pint32Interrupt->userPvt, 
                           pint32Interrupt->pasynUser,
                           ivalue);
-            }
         }
-        pnode = (interruptNode *)ellNext(&pnode->node);
     }
-    pasynManager->interruptEnd(pPvt->int32InterruptPvt);
+    endSubscribers(pPvt, &pPvt->int32Subscribers, pPvt->int32InterruptPvt);
+    if (clients != buffer) free(clients);
 }
 
-
+/* Copies the clients of one axis out of a subscriber table, rebuilding the table
+   first if a client registered or cancelled.  On return the clients for reason r
+   are clients[first[r]] to clients[first[r+1]-1].  The copy is in buffer, which has
+   room for MAX_AXIS_SUBSCRIBERS clients, or in memory the caller must free if
+   there are more.  Must be called between startSubscribers and endSubscribers, which
+   keep the clients valid until the callbacks are done. */
+static void **copySubscribers(drvmotorPvt *pPvt, subscriberTable *pTable, dataType type,
+                              ELLLIST *pclientList, int axis, int *first, void **buffer)
+{
+    void **clients = buffer;
+    int base = axis*NUM_MOTOR_REASONS;
+    int nclients;
+    int r;
+
+    epicsMutexLock(pPvt->lock);
+    if (!pTable->valid) buildSubscribers(pPvt, pTable, type, pclientList);
+    nclients = pTable->first[base+NUM_MOTOR_REASONS] - pTable->first[base];
+    if (nclients > MAX_AXIS_SUBSCRIBERS)
+        clients = mallocMustSucceed(nclients * sizeof(void *), "drvMotorAsyn::copySubscribers");
+    for (r = 0; r <= NUM_MOTOR_REASONS; r++)
+        first[r] = pTable->first[base+r] - pTable->first[base];
+    memcpy(clients, &pTable->clients[pTable->first[base]], nclients * sizeof(void *));
+    epicsMutexUnlock(pPvt->lock);
+    return clients;
+}
+
+/* Starts a pass over the interrupt clients of a subscriber table */
+static void startSubscribers(drvmotorPvt *pPvt, subscriberTable *pTable, void *interruptPvt,
+                             ELLLIST **ppclientList)
+{
+    epicsMutexLock(pPvt->lock);
+    pTable->active++;
+    epicsMutexUnlock(pPvt->lock);
+    pasynManager->interruptStart(interruptPvt, ppclientList);
+}
+
+/* Ends a pass over the interrupt clients of a subscriber table.  Clients that
+   registered or cancelled during the passes are on the asyn list once the last
+   pass has ended, so the table is rebuilt on the next callback */
+static void endSubscribers(drvmotorPvt *pPvt, subscriberTable *pTable, void *interruptPvt)
+{
+    pasynManager->interruptEnd(interruptPvt);
+    epicsMutexLock(pPvt->lock);
+    if (--pTable->active == 0 && pTable->changed) {
+        pTable->valid = 0;
+        pTable->changed = 0;
+    }
+    epicsMutexUnlock(pPvt->lock);
+}
+
+/* Gets the subscriber table slot for an interrupt client.
+   Returns 0 if the client's address or reason is not handled by this driver */
+static int subscriberSlot(drvmotorPvt *pPvt, dataType type, void *pInterrupt,
+                          int *slot)
+{
+    int addr, reason;
+
+    switch(type) {
+        case typeInt32:
+            addr = ((asynInt32Interrupt *)pInterrupt)->addr;
+            reason = ((asynInt32Interrupt *)pInterrupt)->pasynUser->reason;
+            break;
+        case typeFloat64:
+            addr = ((asynFloat64Interrupt *)pInterrupt)->addr;
+            reason = ((asynFloat64Interrupt *)pInterrupt)->pasynUser->reason;
+            break;
+        case typeGenericPointer:
+            addr = ((asynGenericPointerInterrupt *)pInterrupt)->addr;
+            reason = 0;
+            break;
+        default:
+            return 0;
+    }
+    if (addr < 0 || addr >= pPvt->numAxes ||
+        reason < 0 || reason >= NUM_MOTOR_REASONS) return 0;
+    *slot = addr*NUM_MOTOR_REASONS + reason;
+    return 1;
+}
+
+/* Rebuilds a subscriber table from an interrupt client list.
+   Must be called between startSubscribers and endSubscribers with pPvt->lock held */
+static void buildSubscribers(drvmotorPvt *pPvt, subscriberTable *pTable,
+                             dataType type, ELLLIST *pclientList)
+{
+    interruptNode *pnode;
+    int nslots = pPvt->numAxes * NUM_MOTOR_REASONS;
+    int *next;
+    int i, slot;
+
+    free(pTable->first);
+    free(pTable->clients);
+    pTable->first = callocMustSucceed(nslots + 1, sizeof(int), "drvMotorAsyn::buildSubscribers");
+
+    /* Count the clients for each slot, then convert the counts to offsets */
+    for (pnode = (interruptNode *)ellFirst(pclientList); pnode;
+         pnode = (interruptNode *)ellNext(&pnode->node)) {
+        if (subscriberSlot(pPvt, type, pnode->drvPvt, &slot)) pTable->first[slot+1]++;
+    }
+    for (i = 0; i < nslots; i++) pTable->first[i+1] += pTable->first[i];
+
+    pTable->clients = callocMustSucceed(pTable->first[nslots] + 1, sizeof(void *),
+                                        "drvMotorAsyn::buildSubscribers");
+    next = callocMustSucceed(nslots, sizeof(int), "drvMotorAsyn::buildSubscribers");
+    memcpy(next, pTable->first, nslots * sizeof(int));
+    for (pnode = (interruptNode *)ellFirst(pclientList); pnode;
+         pnode = (interruptNode *)ellNext(&pnode->node)) {
+        if (subscriberSlot(pPvt, type, pnode->drvPvt, &slot))
+            pTable->clients[next[slot]++] = pnode->drvPvt;
+    }
+    free(next);
+    pTable->valid = 1;
+}
+
+/* Interrupt registration hooks.  These call the asyn base implementations
+   and then mark the port's subscriber table for rebuilding.  pPvt->lock is not
+   held during the base call: cancelInterruptUser waits for the callbacks in
+   progress, which take pPvt->lock in copySubscribers */
+static asynStatus int32RegisterHook(void *drvPvt, asynUser *pasynUser,
+                       interruptCallbackInt32 callback, void *userPvt, void **registrarPvt)
+{
+    drvmotorPvt *pPvt = (drvmotorPvt *)drvPvt;
+    asynStatus status;
+
+    status = (*int32RegisterInterruptUser)(drvPvt, pasynUser, callback, userPvt, registrarPvt);
+    epicsMutexLock(pPvt->lock);
+    pPvt->int32Subscribers.valid = 0;
+    if (pPvt->int32Subscribers.active) pPvt->int32Subscribers.changed = 1;
+    epicsMutexUnlock(pPvt->lock);
+    return(status);
+}
+
+static asynStatus int32CancelHook(void *drvPvt, asynUser *pasynUser, void *registrarPvt)
+{
+    drvmotorPvt *pPvt = (drvmotorPvt *)drvPvt;
+    asynStatus status;
+
+    status = (*int32CancelInterruptUser)(drvPvt, pasynUser, registrarPvt);
+    epicsMutexLock(pPvt->lock);
+    pPvt->int32Subscribers.valid = 0;
+    if (pPvt->int32Subscribers.active) pPvt->int32Subscribers.changed = 1;
+    epicsMutexUnlock(pPvt->lock);
+    return(status);
+}
+
+static asynStatus float64RegisterHook(void *drvPvt, asynUser *pasynUser,
+                       interruptCallbackFloat64 callback, void *userPvt, void **registrarPvt)
+{
+    drvmotorPvt *pPvt = (drvmotorPvt *)drvPvt;
+    asynStatus status;
+
+    status = (*float64RegisterInterruptUser)(drvPvt, pasynUser, callback, userPvt, registrarPvt);
+    epicsMutexLock(pPvt->lock);
+    pPvt->float64Subscribers.valid = 0;
+    if (pPvt->float64Subscribers.active) pPvt->float64Subscribers.changed = 1;
+    epicsMutexUnlock(pPvt->lock);
+    return(status);
+}
+
+static asynStatus float64CancelHook(void *drvPvt, asynUser *pasynUser, void *registrarPvt)
+{
+    drvmotorPvt *pPvt = (drvmotorPvt *)drvPvt;
+    asynStatus status;
+
+    status = (*float64CancelInterruptUser)(drvPvt, pasynUser, registrarPvt);
+    epicsMutexLock(pPvt->lock);
+    pPvt->float64Subscribers.valid = 0;
+    if (pPvt->float64Subscribers.active) pPvt->float64Subscribers.changed = 1;
+    epicsMutexUnlock(pPvt->lock);
+    return(status);
+}
+
+static asynStatus genericPointerRegisterHook(void *drvPvt, asynUser *pasynUser,
+                       interruptCallbackGenericPointer callback, void *userPvt, void **registrarPvt)
+{
+    drvmotorPvt *pPvt = (drvmotorPvt *)drvPvt;
+    asynStatus status;
+
+    status = (*genericPointerRegisterInterruptUser)(drvPvt, pasynUser, callback, userPvt, registrarPvt);
+    epicsMutexLock(pPvt->lock);
+    pPvt->genericPointerSubscribers.valid = 0;
+    if (pPvt->genericPointerSubscribers.active) pPvt->genericPointerSubscribers.changed = 1;
+    epicsMutexUnlock(pPvt->lock);
+    return(status);
+}
+
+static asynStatus genericPointerCancelHook(void *drvPvt, asynUser *pasynUser, void *registrarPvt)
+{
+    drvmotorPvt *pPvt = (drvmotorPvt *)drvPvt;
+    asynStatus status;
+
+    status = (*genericPointerCancelInterruptUser)(drvPvt, pasynUser, registrarPvt);
+    epicsMutexLock(pPvt->lock);
+    pPvt->genericPointerSubscribers.valid = 0;
+    if (pPvt->genericPointerSubscribers.active) pPvt->genericPointerSubscribers.changed = 1;
+    epicsMutexUnlock(pPvt->lock);
+    return(status);
+}
+
+/* The interface structures are shared by all ports, so the base functions
+   are saved and replaced only the first time a port is configured */
+static void installInterruptHooks(void)
+{
+    if (int32RegisterInterruptUser) return;
+    int32RegisterInterruptUser = drvMotorInt32.registerInterruptUser;
+    int32CancelInterruptUser = drvMotorInt32.cancelInterruptUser;
+    drvMotorInt32.registerInterruptUser = int32RegisterHook;
+    drvMotorInt32.cancelInterruptUser = int32CancelHook;
+    float64RegisterInterruptUser = drvMotorFloat64.registerInterruptUser;
+    float64CancelInterruptUser = drvMotorFloat64.cancelInterruptUser;
+    drvMotorFloat64.registerInterruptUser = float64RegisterHook;
+    drvMotorFloat64.cancelInterruptUser = float64CancelHook;
+    genericPointerRegisterInterruptUser = drvMotorGenericPointer.registerInterruptUser;
+    genericPointerCancelInterruptUser = drvMotorGenericPointer.cancelInterruptUser;
+    drvMotorGenericPointer.registerInterruptUser = genericPointerRegisterHook;
+    drvMotorGenericPointer.cancelInterruptUser = genericPointerCancelHook;
+}
+
+
 /*static void rebootCallback(void *drvPvt)*/
 /*{*/
 /*   drvmotorPvt *pPvt = (drvmotorPvt *)drvPvt;*/
@@ -1021,7 +1287,7 @@ static void report(void *drvPvt, FILE *fp, int details)
         fprintf(fp, "    messages sent OK=%d; send failed (queue full)=%d\n",
                 pPvt->messagesSent, pPvt->messagesFailed);
         /* Report int32 interrupts */
-        pasynManager->interruptStart(pPvt->int32InterruptPvt, &pclientList);
+        startSubscribers(pPvt, &pPvt->int32Subscribers, pPvt->int32InterruptPvt, &pclientList);
         pnode = (interruptNode *)ellFirst(pclientList);
         while (pnode) {
             asynInt32Interrupt *pint32Interrupt = pnode->drvPvt;
@@ -1030,10 +1296,10 @@ static void report(void *drvPvt, FILE *fp, int details)
                     pint32Interrupt->pasynUser->reason);
             pnode = (interruptNode *)ellNext(&pnode->node);
         }
-        pasynManager->interruptEnd(pPvt->int32InterruptPvt);
+        endSubscribers(pPvt, &pPvt->int32Subscribers, pPvt->int32InterruptPvt);
 
         /* Report float64 interrupts */
-        pasynManager->interruptStart(pPvt->float64InterruptPvt, &pclientList);
+        startSubscribers(pPvt, &pPvt->float64Subscribers, pPvt->float64InterruptPvt, &pclientList);
         pnode = (interruptNode *)ellFirst(pclientList);
         while (pnode) {
             asynFloat64Interrupt *pfloat64Interrupt = pnode->drvPvt;
@@ -1042,10 +1308,10 @@ static void report(void *drvPvt, FILE *fp, int details)
                     pfloat64Interrupt->pasynUser->reason);
             pnode = (interruptNode *)ellNext(&pnode->node);
         }
-        pasynManager->interruptEnd(pPvt->float64InterruptPvt);
+        endSubscribers(pPvt, &pPvt->float64Subscribers, pPvt->float64InterruptPvt);
 
         /* Report motorStatus interrupts */
-        pasynManager->interruptStart(pPvt->genericPointerInterruptPvt, &pclientList);
+        startSubscribers(pPvt, &pPvt->genericPointerSubscribers, pPvt->genericPointerInterruptPvt, &pclientList);
         pnode = (interruptNode *)ellFirst(pclientList);
         while (pnode) {
             asynGenericPointerInterrupt *pInterrupt = pnode->drvPvt;
@@ -1054,7 +1320,7 @@ static void report(void *drvPvt, FILE *fp, int details)
                     pInterrupt->pasynUser->reason); 
             pnode = (interruptNode *)ellNext(&pnode->node);
         }
-        pasynManager->interruptEnd(pPvt->genericPointerInterruptPvt);
+        endSubscribers(pPvt, &pPvt->genericPointerSubscribers, pPvt->genericPointerInterruptPvt);
     }
 }
 
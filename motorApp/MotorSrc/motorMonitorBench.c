@@ -0,0 +1,347 @@
+/* motorMonitorBench.c
+ *
+ * Benchmark of the motor record's readback monitors and the Max Monitor Rate
+ * (MMXR) field.
+ *
+ * Loads one motor record with a simulated device support into a host IOC and
+ * subscribes to its readback fields, as a CA client would.  The record is then
+ * processed every poll period while it moves back and forth, as a model 2 or
+ * model 3 poller would, first with MMXR = 0 and then with the given MMXR.  For
+ * each run it reports the events delivered to the subscriptions and the time
+ * spent in dbProcess().
+ *
+ * Usage: motorMonitorBench [mmxr [nPasses [period]]]
+ *     mmxr     Max Monitor Rate of the second run, in Hz (default 10)
+ *     nPasses  Number of record passes in each run (default 1000)
+ *     period   Poll period in seconds (default 0.01)
+ *
+ * Run it from the source directory or from O.<arch>; it reads
+ * O.Common/motorMonitorBench.dbd and motorMonitorBench.db.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <epicsTime.h>
+#include <epicsThread.h>
+#include <dbAccess.h>
+#include <dbEvent.h>
+#include <iocInit.h>
+#include <osiFileName.h>
+
+#include "motorRecord.h"
+#include "motor.h"
+
+#if !LT_EPICSBASE(3,15,0,0)
+#include <dbChannel.h>
+typedef struct dbChannel eventChannel;
+#else
+typedef struct dbAddr eventChannel;
+#endif
+
+#include "epicsExport.h"
+
+#define BENCH_RECORD "bench:m1"
+#define BENCH_SEARCH_PATH "." OSI_PATH_LIST_SEPARATOR ".." OSI_PATH_LIST_SEPARATOR \
+                          "O.Common" OSI_PATH_LIST_SEPARATOR "../O.Common"
+
+int motorMonitorBench_registerRecordDeviceDriver(struct dbBase *pdbbase);
+
+/* Simulated axis; the bench thread moves it one step per pass */
+static struct
+{
+    double position;
+    double target;
+    double step;        /* Raw steps per pass */
+    double velocity;    /* Raw steps per second */
+    int moving;
+    CALLBACK_VALUE callback_flag;
+} axis;
+
+static long bench_init_record(void *);
+static CALLBACK_VALUE bench_update(struct motorRecord *);
+static long bench_start(struct motorRecord *);
+static RTN_STATUS bench_build(motor_cmnd, double *, struct motorRecord *);
+static RTN_STATUS bench_end(struct motorRecord *);
+
+struct motor_dset devMotorBench =
+{
+    {8, NULL, NULL, (DEVSUPFUN) bench_init_record, NULL},
+    bench_update,
+    bench_start,
+    bench_build,
+    bench_end
+};
+
+epicsExportAddress(dset, devMotorBench);
+
+static long bench_init_record(void *arg)
+{
+    struct motorRecord *pmr = (struct motorRecord *) arg;
+    msta_field msta;
+
+    msta.All = 0;
+    msta.Bits.RA_DONE = 1;
+    pmr->msta = msta.All;
+    return(0);
+}
+
+/* Posts RMP, REP and RVEL the way devMotorAsyn does, including MMXR deferral */
+static CALLBACK_VALUE bench_update(struct motorRecord *pmr)
+{
+    msta_field msta;
+    epicsInt32 rawvalue;
+
+    if (axis.callback_flag == NOTHING_DONE)
+        return(NOTHING_DONE);
+
+    rawvalue = (epicsInt32) floor(axis.position + 0.5);
+    if (pmr->rmp != rawvalue)
+    {
+        pmr->rmp = rawvalue;
+        if (pmr->mdec)
+            pmr->mdfr = 1;
+        else
+            db_post_events(pmr, &pmr->rmp, DBE_VAL_LOG);
+    }
+    if (pmr->rep != rawvalue)
+    {
+        pmr->rep = rawvalue;
+        if (pmr->mdec)
+            pmr->mdfr = 1;
+        else
+            db_post_events(pmr, &pmr->rep, DBE_VAL_LOG);
+    }
+    rawvalue = axis.moving ? (epicsInt32) floor(axis.velocity) : 0;
+    if (pmr->rvel != rawvalue)
+    {
+        pmr->rvel = rawvalue;
+        if (pmr->mdec)
+            pmr->mdfr = 1;
+        else
+            db_post_events(pmr, &pmr->rvel, DBE_VAL_LOG);
+    }
+
+    msta.All = 0;
+    msta.Bits.RA_DONE = axis.moving ? 0 : 1;
+    msta.Bits.RA_DIRECTION = (axis.target >= axis.position) ? 1 : 0;
+    pmr->msta = msta.All;
+    return(CALLBACK_DATA);
+}
+
+static long bench_start(struct motorRecord *pmr)
+{
+    return(0);
+}
+
+static RTN_STATUS bench_build(motor_cmnd command, double *parms, struct motorRecord *pmr)
+{
+    switch (command)
+    {
+        case MOVE_ABS:
+            axis.target = *parms;
+            axis.moving = 1;
+            break;
+        case MOVE_REL:
+            axis.target = axis.position + *parms;
+            axis.moving = 1;
+            break;
+        case STOP_AXIS:
+            axis.target = axis.position;
+            axis.moving = 0;
+            break;
+        case LOAD_POS:
+            axis.position = axis.target = *parms;
+            axis.moving = 0;
+            break;
+        default:
+            break;
+    }
+    return(OK);
+}
+
+static RTN_STATUS bench_end(struct motorRecord *pmr)
+{
+    return(OK);
+}
+
+
+/* Events delivered to the subscriptions; written by the event task only */
+static const char *fieldNames[] = {"RBV", "RRBV", "DRBV", "DIFF", "RDIF", "RMP", "REP", "RVEL", "DMOV"};
+#define NUM_FIELDS (sizeof(fieldNames) / sizeof(fieldNames[0]))
+static volatile unsigned long nEvents[NUM_FIELDS];
+
+static void benchEvent(void *user, eventChannel *chan, int eventsRemaining,
+                       struct db_field_log *pfl)
+{
+    nEvents[(size_t) user]++;
+}
+
+static int subscribe(dbEventCtx ctx, size_t field)
+{
+    char pvname[PVNAME_STRINGSZ + 8];
+    dbEventSubscription sub;
+
+    sprintf(pvname, "%s.%s", BENCH_RECORD, fieldNames[field]);
+#if LT_EPICSBASE(3,15,0,0)
+    {
+        static DBADDR addr[NUM_FIELDS];
+
+        if (dbNameToAddr(pvname, &addr[field]))
+            return(-1);
+        sub = db_add_event(ctx, &addr[field], benchEvent, (void *) field, DBE_VALUE | DBE_ALARM);
+    }
+#else
+    {
+        dbChannel *chan = dbChannelCreate(pvname);
+
+        if (!chan || dbChannelOpen(chan))
+            return(-1);
+        sub = db_add_event(ctx, chan, benchEvent, (void *) field, DBE_VALUE | DBE_ALARM);
+    }
+#endif
+    if (sub == NULL)
+        return(-1);
+    db_event_enable(sub);
+    return(0);
+}
+
+/* Wait until the event task has delivered everything that was posted */
+static void drainEvents(void)
+{
+    unsigned long last, total = 0;
+    size_t i;
+
+    do
+    {
+        last = total;
+        epicsThreadSleep(0.2);
+        for (i = 0, total = 0; i < NUM_FIELDS; i++)
+            total += nEvents[i];
+    } while (total != last);
+}
+
+static void run(struct motorRecord *pmr, double mmxr, int nPasses, double period)
+{
+    DBADDR valAddr, mmxrAddr;
+    epicsTimeStamp start, end, t0, t1;
+    double busy = 0., elapsed, dest = 0.;
+    unsigned long readbacks = 0;
+    size_t i;
+    int pass, dmov, nMoves = 0;
+
+    dbNameToAddr(BENCH_RECORD ".VAL", &valAddr);
+    dbNameToAddr(BENCH_RECORD ".MMXR", &mmxrAddr);
+    dbPutField(&mmxrAddr, DBR_DOUBLE, &mmxr, 1);
+    drainEvents();
+    for (i = 0; i < NUM_FIELDS; i++)
+        nEvents[i] = 0;
+
+    epicsTimeGetCurrent(&start);
+    for (pass = 0; pass < nPasses; pass++)
+    {
+        dbScanLock((dbCommon *) pmr);
+        dmov = pmr->dmov;
+        dbScanUnlock((dbCommon *) pmr);
+        if (dmov)
+        {
+            /* Move back and forth between 0 and 5 */
+            dest = (dest == 0.) ? 5. : 0.;
+            dbPutField(&valAddr, DBR_DOUBLE, &dest, 1);
+            nMoves++;
+        }
+
+        epicsThreadSleep(period);
+
+        /* One poll: the axis moves a step, then the record processes */
+        dbScanLock((dbCommon *) pmr);
+        if (axis.moving)
+        {
+            if (fabs(axis.target - axis.position) <= axis.step)
+            {
+                axis.position = axis.target;
+                axis.moving = 0;
+            }
+            else
+                axis.position += (axis.target > axis.position) ? axis.step : -axis.step;
+        }
+        epicsTimeGetCurrent(&t0);
+        axis.callback_flag = CALLBACK_DATA;
+        dbProcess((dbCommon *) pmr);
+        axis.callback_flag = NOTHING_DONE;
+        epicsTimeGetCurrent(&t1);
+        dbScanUnlock((dbCommon *) pmr);
+        busy += epicsTimeDiffInSeconds(&t1, &t0);
+    }
+    epicsTimeGetCurrent(&end);
+    elapsed = epicsTimeDiffInSeconds(&end, &start);
+    drainEvents();
+
+    printf("MMXR %g Hz: %d passes, %d moves, %f s elapsed, %f us per dbProcess()\n",
+           mmxr, nPasses, nMoves, elapsed, 1.e6 * busy / nPasses);
+    for (i = 0; i < NUM_FIELDS; i++)
+    {
+        printf("  %-5s %8lu events\n", fieldNames[i], nEvents[i]);
+        if (i < NUM_FIELDS - 1)
+            readbacks += nEvents[i];
+    }
+    printf("  readbacks %lu events, %f per second\n", readbacks, readbacks / elapsed);
+}
+
+int main(int argc, char *argv[])
+{
+    double mmxr = 10.;
+    int nPasses = 1000;
+    double period = 0.01;
+    DBADDR addr;
+    struct motorRecord *pmr;
+    dbEventCtx ctx;
+    size_t i;
+
+    if (argc > 1) mmxr = atof(argv[1]);
+    if (argc > 2) nPasses = atoi(argv[2]);
+    if (argc > 3) period = atof(argv[3]);
+    if (mmxr < 0. || nPasses < 1 || period <= 0.) {
+        printf("Usage: %s [mmxr [nPasses [period]]], mmxr >= 0, period > 0\n", argv[0]);
+        return 1;
+    }
+
+    if (dbLoadDatabase("motorMonitorBench.dbd", BENCH_SEARCH_PATH, NULL) ||
+        motorMonitorBench_registerRecordDeviceDriver(pdbbase) ||
+        dbLoadRecords("motorMonitorBench.db", NULL) ||
+        iocInit())
+    {
+        printf("Cannot start the IOC; run from the source directory or O.<arch>\n");
+        return 1;
+    }
+    if (dbNameToAddr(BENCH_RECORD, &addr))
+    {
+        printf("Cannot find record %s\n", BENCH_RECORD);
+        return 1;
+    }
+    pmr = (struct motorRecord *) addr.precord;
+    /* VELO in raw steps per poll period */
+    axis.velocity = pmr->velo / fabs(pmr->mres);
+    axis.step = axis.velocity * period;
+
+    ctx = db_init_events();
+    if (ctx == NULL ||
+        db_start_events(ctx, "motorMonitorBench", NULL, NULL, epicsThreadPriorityMedium) != DB_EVENT_OK)
+    {
+        printf("Cannot start the database event task\n");
+        return 1;
+    }
+    for (i = 0; i < NUM_FIELDS; i++)
+    {
+        if (subscribe(ctx, i))
+        {
+            printf("Cannot subscribe to %s.%s\n", BENCH_RECORD, fieldNames[i]);
+            return 1;
+        }
+    }
+
+    run(pmr, 0., nPasses, period);
+    run(pmr, mmxr, nPasses, period);
+    return 0;
+}
@@ -187,6 +187,13 @@ USAGE...        Motor Record Support.
  *                    processing was standard. If processing is needed on a DMOV false to true
  *                    transition, a new motor record field should be added.
  * .75 05-18-17 rls - Stop motor if URIP is Yes and RDBL read returns an error. 
+ * .76 10-19-26     - New Max Monitor Rate (MMXR) field. While moving, RBV, RRBV, DRBV, DIFF, RDIF
+ *                    and device support's RMP, REP and RVEL are posted at most MMXR times per
+ *                    second; the last deferred values are posted by a delayed callback or when
+ *                    DMOV goes true.
+ * .77 10-19-26     - Readback-only fast path in process(). A callback that changes only the
+ *                    position of a motor at rest recomputes RRBV, DRBV, RBV, DIFF and RDIF and
+ *                    skips the motion state machine and do_work().
  */                                                          
 
 #define VERSION 6.10
@@ -199,11 +206,13 @@ USAGE...        Motor Record Support.
 #include    <callback.h>
 #include    <dbAccess.h>
 #include    <dbScan.h>
+#include    <dbLock.h>
 #include    <recGbl.h>
 #include    <recSup.h>
 #include    <dbEvent.h>
 #include    <devSup.h>
 #include    <math.h>
+#include    <epicsTime.h>
 
 #define GEN_SIZE_OFFSET
 #include    "motorRecord.h"
@@ -234,7 +243,10 @@ static inline void Debug(int level, const char *format, ...) {
 static RTN_STATUS do_work(motorRecord *, CALLBACK_VALUE);
 static void alarm_sub(motorRecord *);
 static void monitor(motorRecord *);
+static void post_readbacks(motorRecord *, unsigned short);
 static void process_motor_info(motorRecord *, bool);
+static void process_readback(motorRecord *, bool);
+static bool readback_only(motorRecord *);
 static void load_pos(motorRecord *);
 static void check_speed_and_resolution(motorRecord *);
 static void set_dial_highlimit(motorRecord *, struct motor_dset *);
@@ -452,6 +464,8 @@ struct callback         /* DLY feature callback structure. */
 {
     CALLBACK dly_callback;
     struct motorRecord *precord;
+    CALLBACK mon_callback;      /* Trailing-edge post of deferred monitors (MMXR). */
+    bool mon_queued;
 };
 
 static void callbackFunc(struct callback *pcb)
@@ -477,6 +491,57 @@ static void callbackFunc(struct callback *pcb)
 }
 
 
+/*
+When the Max Monitor Rate (MMXR) is nonzero, monitor() defers the frequently
+changing readback fields while the motor is moving (see process()).  This
+callback posts whatever is still deferred once the monitor interval has
+elapsed, so that the last readback of a burst is never lost.
+*/
+
+static double monitor_time()
+{
+    epicsTimeStamp now;
+
+    epicsTimeGetCurrent(&now);
+    return((double) now.secPastEpoch + 1.e-9 * now.nsec);
+}
+
+/* The mmap bits of the readback fields that MMXR can defer. */
+static epicsUInt32 readback_bits()
+{
+    mmap_field bits;
+
+    bits.All = 0;
+    bits.Bits.M_RBV = 1;
+    bits.Bits.M_RRBV = 1;
+    bits.Bits.M_DRBV = 1;
+    bits.Bits.M_DIFF = 1;
+    bits.Bits.M_RDIF = 1;
+    return(bits.All);
+}
+
+static void monitorCallbackFunc(CALLBACK *pcb)
+{
+    void *puser;
+    struct callback *pcallback;
+    motorRecord *pmr;
+
+    callbackGetUser(puser, pcb);
+    pcallback = (struct callback *) puser;
+    pmr = pcallback->precord;
+
+    dbScanLock((dbCommon *) pmr);
+    pcallback->mon_queued = false;
+    /* If the record is processing, its monitor() takes care of the deferred fields. */
+    if (!pmr->pact && ((pmr->mmap & readback_bits()) != 0 || pmr->mdfr != 0))
+    {
+        post_readbacks(pmr, 0);
+        pmr->mlpt = monitor_time();
+    }
+    dbScanUnlock((dbCommon *) pmr);
+}
+
+
 /******************************************************************************
         enforceMinRetryDeadband()
 
@@ -562,6 +627,9 @@ static long init_record(dbCommon* arg, int pass)
                         &pcallback->dly_callback);
     callbackSetPriority(pmr->prio, &pcallback->dly_callback);
     pcallback->precord = pmr;
+    callbackSetCallback(monitorCallbackFunc, &pcallback->mon_callback);
+    callbackSetPriority(pmr->prio, &pcallback->mon_callback);
+    callbackSetUser(pcallback, &pcallback->mon_callback);
 
     /*
      * Reconcile two different ways of specifying speed and resolution; make
@@ -1091,6 +1159,11 @@ LOGIC:
     IF motor status field (MSTA) was modified.
         Mark MSTA as changed.
     ENDIF
+    IF this is a readback-only update (see readback_only()).
+        Call process_readback().
+        Update Readback output link (RLNK), call dbPutLink().
+        GOTO Exit.
+    ENDIF
     IF function was invoked by a callback, OR, process delay acknowledged is true?
         Set process reason indicator to CALLBACK_DATA.
         Call process_motor_info().
@@ -1196,9 +1269,24 @@ static long process(dbCommon *arg)
      * Call device support to get raw motor position/status and to see whether
      * this is a callback.
      */
+    /*
+     * Decide whether readback monitors are deferred during this pass.  Device
+     * support also checks MDEC before posting RMP, REP and RVEL.
+     */
+    pmr->mdec = 0;
+    if (pmr->mmxr > 0.0 && pmr->dmov == 0 &&
+        (monitor_time() - pmr->mlpt) < (1.0 / pmr->mmxr))
+        pmr->mdec = 1;
     process_reason = (*pdset->update_values) (pmr);
     if (pmr->msta != old_msta)
         MARK(M_MSTA);
+    else if (process_reason == CALLBACK_DATA && readback_only(pmr))
+    {
+        /* Idle motor, only the position changed; skip the state machine. */
+        process_readback(pmr, false);
+        status = dbPutLink(&(pmr->rlnk), DBR_DOUBLE, &(pmr->rbv), 1);
+        goto process_exit;
+    }
 
     if ((process_reason == CALLBACK_DATA) || (pmr->mip & MIP_DELAY_ACK))
     {
@@ -3305,63 +3393,19 @@ static void alarm_sub(motorRecord * pmr)
 
 
 /******************************************************************************
-        monitor()
-
-LOGIC:
-    Initalize local variables for MARKED and UNMARKED macros.
-    Set monitor_mask from recGblResetAlarms() return value.
-    IF both Monitor (MDEL) and Archive (ADEL) Deadbands are zero.
-        Set local_mask <- monitor_mask.
-        IF RBV marked for value change
-            bitwiseOR both DBE_VALUE and DBE_LOG into local_mask.
-            dbpost RBV.
-            Clear RBV marked for value change.
-        ENDIF
-    ELSE IF RBV marked for value change.
-        Clear RBV marked for value change.
-        Set local_mask <- monitor_mask.
-        IF Monitor Deadband (MDEL) is zero.
-            bitwiseOR DBE_VALUE into local_mask.
-        ELSE
-            IF |MLST - RBV| > MDEL
-                bitwiseOR DBE_VALUE into local_mask.
-                Update Last Value Monitored (MLST).
-            ENDIF
-        ENDIF
-        IF Archive Deadband (ADEL) is zero.
-            bitwiseOR DBE_LOG into local_mask.
-        ELSE
-            IF |ALST - RBV| > ADEL
-                bitwiseOR DBE_LOG into local_mask.
-                Update Last Value Archived (MLST).
-            ENDIF            
-        ENIDIF
-        IF local_mask is nonzero.
-            dbpost RBV.
-        ENDIF            
-    ENDIF
-
-    dbpost frequently changing PV's.
-    IF no PV's marked for value change.
-        EXIT.
-    ENDIF
-    
-    dbpost remaining PV's.
-    Clear all PF's marked for value change.
-    EXIT
+        post_readbacks()
 
+Post the frequently changing readback fields (RBV, RRBV, DRBV, DIFF, RDIF) and
+any raw readbacks (RMP, REP, RVEL) that device support deferred.  Called by
+monitor() and by the MMXR trailing-edge callback.
 *******************************************************************************/
-static void monitor(motorRecord * pmr)
+static void post_readbacks(motorRecord * pmr, unsigned short monitor_mask)
 {
-    unsigned short monitor_mask, local_mask;
+    unsigned short local_mask;
     double delta = 0.0;
     mmap_field mmap_bits;
-    nmap_field nmap_bits;
 
     mmap_bits.All = pmr->mmap; /* Initialize for MARKED. */
-    nmap_bits.All = pmr->nmap; /* Initialize for MARKED_AUX. */
-
-    monitor_mask = recGblResetAlarms(pmr);
 
     if (pmr->mdel == 0.0 && pmr->adel == 0.0)
     {
@@ -3429,6 +3473,110 @@ static void monitor(motorRecord * pmr)
         UNMARK(M_RDIF);
     }
     
+    if (pmr->mdfr != 0)
+    {
+        pmr->mdfr = 0;
+        db_post_events(pmr, &pmr->rmp, DBE_VAL_LOG);
+        db_post_events(pmr, &pmr->rep, DBE_VAL_LOG);
+        db_post_events(pmr, &pmr->rvel, DBE_VAL_LOG);
+    }
+}
+
+
+/******************************************************************************
+        monitor()
+
+LOGIC:
+    Set monitor_mask from recGblResetAlarms() return value.
+    IF readbacks are decimated (MDEC), motor is moving and no alarm change.
+        Hold back the marked readback PV's; queue the trailing-edge callback.
+    ELSE
+        Call post_readbacks(); Update Last Monitor Post Time (MLPT).
+    ENDIF
+    Initalize local variables for MARKED and UNMARKED macros.
+
+post_readbacks() LOGIC:
+    IF both Monitor (MDEL) and Archive (ADEL) Deadbands are zero.
+        Set local_mask <- monitor_mask.
+        IF RBV marked for value change
+            bitwiseOR both DBE_VALUE and DBE_LOG into local_mask.
+            dbpost RBV.
+            Clear RBV marked for value change.
+        ENDIF
+    ELSE IF RBV marked for value change.
+        Clear RBV marked for value change.
+        Set local_mask <- monitor_mask.
+        IF Monitor Deadband (MDEL) is zero.
+            bitwiseOR DBE_VALUE into local_mask.
+        ELSE
+            IF |MLST - RBV| > MDEL
+                bitwiseOR DBE_VALUE into local_mask.
+                Update Last Value Monitored (MLST).
+            ENDIF
+        ENDIF
+        IF Archive Deadband (ADEL) is zero.
+            bitwiseOR DBE_LOG into local_mask.
+        ELSE
+            IF |ALST - RBV| > ADEL
+                bitwiseOR DBE_LOG into local_mask.
+                Update Last Value Archived (MLST).
+            ENDIF            
+        ENIDIF
+        IF local_mask is nonzero.
+            dbpost RBV.
+        ENDIF            
+    ENDIF
+    dbpost RRBV, DRBV, DIFF, RDIF; dbpost RMP, REP, RVEL if deferred (MDFR).
+
+monitor() continued:
+    dbpost frequently changing PV's.
+    IF no PV's marked for value change.
+        EXIT.
+    ENDIF
+    
+    dbpost remaining PV's.
+    Clear all PF's marked for value change.
+    EXIT
+
+*******************************************************************************/
+static void monitor(motorRecord * pmr)
+{
+    unsigned short monitor_mask, local_mask;
+    mmap_field mmap_bits;
+    nmap_field nmap_bits;
+    epicsUInt32 deferred = 0;
+
+    monitor_mask = recGblResetAlarms(pmr);
+
+    /*
+     * With MMXR set, hold back the readback fields while moving; they stay
+     * marked and are posted by a later pass, by the trailing-edge callback, or
+     * when DMOV goes true.  Alarm changes are never deferred.
+     */
+    if (pmr->mdec != 0 && pmr->dmov == 0 && monitor_mask == 0)
+    {
+        struct callback *pcallback = (struct callback *) pmr->cbak;
+
+        deferred = pmr->mmap & readback_bits();
+        pmr->mmap &= ~deferred;
+        if ((deferred != 0 || pmr->mdfr != 0) && !pcallback->mon_queued)
+        {
+            double delay = pmr->mlpt + (1.0 / pmr->mmxr) - monitor_time();
+
+            pcallback->mon_queued = true;
+            callbackRequestDelayed(&pcallback->mon_callback, (delay > 0.0) ? delay : 0.0);
+        }
+    }
+    else
+    {
+        post_readbacks(pmr, monitor_mask);
+        if (pmr->mmxr > 0.0)
+            pmr->mlpt = monitor_time();
+    }
+
+    mmap_bits.All = pmr->mmap; /* Initialize for MARKED. */
+    nmap_bits.All = pmr->nmap; /* Initialize for MARKED_AUX. */
+
     if ((local_mask = monitor_mask | (MARKED(M_MSTA) ? DBE_VAL_LOG : 0)))
     {
         msta_field msta;
@@ -3448,7 +3596,10 @@ static void monitor(motorRecord * pmr)
     }
 
     if ((pmr->mmap == 0) && (pmr->nmap == 0))
+    {
+        pmr->mmap = deferred;
         return;
+    }
 
     /* short circuit: less frequently posted PV's go below this line. */
     mmap_bits.All = pmr->mmap; /* Initialize for MARKED. */
@@ -3537,30 +3688,45 @@ static void monitor(motorRecord * pmr)
         db_post_events(pmr, &pmr->homr, local_mask);
 
     UNMARK_ALL;
+    pmr->mmap = deferred;
 }
 
 
 /******************************************************************************
-        process_motor_info()
+        readback_only()
+
+Return true if a device support callback carries nothing but a new position
+for a motor that is at rest: MSTA is unchanged, no motion, retry, delay or
+status update is in progress, nothing was written to the record and no stop,
+pause, SPMG change or limit switch needs attention.  process() then only
+recomputes the readback fields with process_readback().  A closed-loop motor
+(OMSL) always goes through do_work(), which reads DOL.
 *******************************************************************************/
-static void process_motor_info(motorRecord * pmr, bool initcall)
+static bool readback_only(motorRecord * pmr)
+{
+    if (pmr->mip != MIP_DONE || pmr->dmov == FALSE || pmr->movn != 0 ||
+        pmr->putf || pmr->stop || pmr->spmg != motorSPMG_Go ||
+        pmr->spmg != pmr->lspg || pmr->omsl == menuOmslclosed_loop ||
+        pmr->stup != motorSTUP_OFF || pmr->rhls || pmr->rlls)
+        return(false);
+    return(true);
+}
+
+
+/******************************************************************************
+        process_readback()
+
+Calculate the raw, dial and user readbacks and the distance to the target
+(RRBV, DRBV, RBV, DIFF and RDIF) from RMP, REP or the RDBL link.
+*******************************************************************************/
+static void process_readback(motorRecord * pmr, bool initcall)
 {
     double old_drbv = pmr->drbv;
     double old_rbv = pmr->rbv;
     long old_rrbv = pmr->rrbv;
-    short old_tdir = pmr->tdir;
-    short old_movn = pmr->movn;
-    short old_hls = pmr->hls;
-    short old_lls = pmr->lls;
-    short old_athm = pmr->athm;
     int dir = (pmr->dir == motorDIR_Pos) ? 1 : -1;
-    bool ls_active;
-    msta_field msta;
-
-    /*** Process record fields. ***/
 
     /* Calculate raw and dial readback values. */
-    msta.All = pmr->msta;
     if (pmr->ueip == motorUEIP_Yes)
     {
         /* An encoder is present and the user wants us to use it. */
@@ -3606,6 +3772,31 @@ static void process_motor_info(motorRecord * pmr, bool initcall)
     if (pmr->rbv != old_rbv)
         MARK(M_RBV);
 
+    pmr->diff = pmr->dval - pmr->drbv;
+    MARK(M_DIFF);
+    pmr->rdif = NINT(pmr->diff / pmr->mres);
+    MARK(M_RDIF);
+}
+
+
+/******************************************************************************
+        process_motor_info()
+*******************************************************************************/
+static void process_motor_info(motorRecord * pmr, bool initcall)
+{
+    short old_tdir = pmr->tdir;
+    short old_movn = pmr->movn;
+    short old_hls = pmr->hls;
+    short old_lls = pmr->lls;
+    short old_athm = pmr->athm;
+    bool ls_active;
+    msta_field msta;
+
+    /*** Process record fields. ***/
+
+    process_readback(pmr, initcall);
+    msta.All = pmr->msta;
+
     /* Set most recent raw direction. */
     pmr->tdir = (msta.Bits.RA_DIRECTION) ? 1 : 0;
     if (pmr->tdir != old_tdir)
@@ -3652,11 +3843,6 @@ static void process_motor_info(motorRecord * pmr, bool initcall)
 
     if (pmr->athm != old_athm)
         MARK(M_ATHM);
-
-    pmr->diff = pmr->dval - pmr->drbv;
-    MARK(M_DIFF);
-    pmr->rdif = NINT(pmr->diff / pmr->mres);
-    MARK(M_RDIF);
 }
 
 /* Calc and load new raw position into motor w/out moving it. */
@@ -0,0 +1,412 @@
+/* motorTrace.c
+ *
+ * Command/response trace rings for motor controllers, see motorTrace.h.
+ *
+ * Recording a transaction claims the next slot with an atomic increment and
+ * copies a few fields into it; nothing is formatted.  The seq field of an entry
+ * is cleared while it is written, with memory barriers on either side, so a dump
+ * that runs at the same time skips entries that are being overwritten.  On base
+ * 3.14, which has no atomics, recording and dumping take the lock of the ring.
+ *
+ * iocsh commands:
+ *   motorTraceDump(name, count, fileName)   last count transactions of a ring,
+ *                                           all rings listed if name is empty
+ *   motorTraceHistogram(name, fileName)     latency histogram per command type
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <epicsVersion.h>
+#include <epicsMutex.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+#include <iocsh.h>
+
+#if (EPICS_VERSION > 3) || ((EPICS_VERSION == 3) && (EPICS_REVISION >= 15))
+#include <epicsAtomic.h>
+#define HAVE_ATOMICS
+#endif
+
+#define epicsExportSharedSymbols
+#include <shareLib.h>
+#include "motorTrace.h"
+#include <epicsExport.h>
+
+#define MAX_COMMAND_TYPES 64
+#define NUM_LATENCY_BINS  14
+
+struct motorTrace {
+  char name[MOTOR_TRACE_NAME_SIZE];
+  int size;
+  int count;                    /* Number of transactions recorded */
+#ifndef HAVE_ATOMICS
+  epicsMutexId countLock;       /* Protects count and entries; XPS sockets to one IP:port share a ring */
+#endif
+  motorTraceEntry *entries;
+  struct motorTrace *next;
+};
+
+typedef struct {
+  char type[MOTOR_TRACE_COMMAND_SIZE];
+  int count;
+  int errors;
+  double sum;
+  double max;
+  int bins[NUM_LATENCY_BINS];
+} commandStats;
+
+/* Upper edges of the latency bins in ms; the last bin has everything above */
+static const double binEdges[NUM_LATENCY_BINS-1] = {0.1, 0.2, 0.5, 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+
+static const char *driverName = "motorTrace";
+
+int motorTraceSize = 256;
+epicsExportAddress(int, motorTraceSize);
+
+static motorTrace *traceList = NULL;
+static epicsMutexId traceListLock = NULL;
+static epicsThreadOnceId traceListOnce = EPICS_THREAD_ONCE_INIT;
+
+static void traceListCreate(void *arg)
+{
+  traceListLock = epicsMutexMustCreate();
+}
+
+static void traceListInit(void)
+{
+  epicsThreadOnce(&traceListOnce, traceListCreate, NULL);
+}
+
+#ifdef HAVE_ATOMICS
+/* epicsAtomic has no unsigned int functions; seq is accessed as an int */
+#define SEQ_SET(pEntry, value) epicsAtomicSetIntT((int *)&(pEntry)->seq, (int)(value))
+#define SEQ_GET(pEntry)        ((unsigned int)epicsAtomicGetIntT((int *)&(pEntry)->seq))
+#endif
+
+/* Returns the number of transactions recorded */
+static unsigned int traceCount(motorTrace *pTrace)
+{
+#ifdef HAVE_ATOMICS
+  return (unsigned int)epicsAtomicGetIntT(&pTrace->count);
+#else
+  unsigned int count;
+
+  epicsMutexMustLock(pTrace->countLock);
+  count = (unsigned int)pTrace->count;
+  epicsMutexUnlock(pTrace->countLock);
+  return count;
+#endif
+}
+
+/* Returns the ring with this name, or NULL; called with traceListLock held */
+static motorTrace *findLocked(const char *name)
+{
+  motorTrace *pTrace;
+
+  for (pTrace = traceList; pTrace; pTrace = pTrace->next) {
+    if (strcmp(pTrace->name, name) == 0) break;
+  }
+  return pTrace;
+}
+
+/** Returns the ring with this name, or NULL */
+motorTrace *motorTraceFind(const char *name)
+{
+  motorTrace *pTrace;
+
+  traceListInit();
+  epicsMutexMustLock(traceListLock);
+  pTrace = findLocked(name);
+  epicsMutexUnlock(traceListLock);
+  return pTrace;
+}
+
+/** Creates a ring of size entries, rounded up to a power of 2, or returns the existing ring
+  * with this name.  Returns NULL if size is 0, which disables tracing for the caller. */
+motorTrace *motorTraceCreate(const char *name, int size)
+{
+  motorTrace *pTrace;
+
+  if (size <= 0) return NULL;
+  traceListInit();
+  /* Look up and insert under one lock, so two callers with the same name get the same ring */
+  epicsMutexMustLock(traceListLock);
+  pTrace = findLocked(name);
+  if (pTrace) goto done;
+
+  /* A power of 2, so that the slot numbers stay in order when the transaction count wraps */
+  while (size & (size - 1)) size += size & -size;
+  pTrace = (motorTrace *)calloc(1, sizeof(motorTrace));
+  if (pTrace) pTrace->entries = (motorTraceEntry *)calloc(size, sizeof(motorTraceEntry));
+  if (!pTrace || !pTrace->entries) {
+    printf("%s:motorTraceCreate: cannot allocate %d entries for %s\n", driverName, size, name);
+    free(pTrace);
+    pTrace = NULL;
+    goto done;
+  }
+  strncpy(pTrace->name, name, sizeof(pTrace->name)-1);
+  pTrace->size = size;
+#ifndef HAVE_ATOMICS
+  pTrace->countLock = epicsMutexMustCreate();
+#endif
+  pTrace->next = traceList;
+  traceList = pTrace;
+done:
+  epicsMutexUnlock(traceListLock);
+  return pTrace;
+}
+
+/** Records one transaction.
+  * \param[in] pTrace The ring; nothing is done if it is NULL.
+  * \param[in] command The command sent.
+  * \param[in] sendTime Time the command was sent; the latency is measured up to now.
+  * \param[in] replyLen Number of characters in the reply.
+  * \param[in] status Status of the transaction. */
+void motorTraceRecord(motorTrace *pTrace, const char *command,
+                      const epicsTimeStamp *sendTime, size_t replyLen, int status)
+{
+  motorTraceEntry *pEntry;
+  epicsTimeStamp now;
+  unsigned int slot;
+
+  if (!pTrace) return;
+  epicsTimeGetCurrent(&now);
+#ifdef HAVE_ATOMICS
+  slot = (unsigned int)epicsAtomicIncrIntT(&pTrace->count) - 1;
+  pEntry = &pTrace->entries[slot % pTrace->size];
+  SEQ_SET(pEntry, 0);
+  /* A reader that sees the new fields also sees seq cleared */
+  epicsAtomicWriteMemoryBarrier();
+#else
+  epicsMutexMustLock(pTrace->countLock);
+  slot = (unsigned int)pTrace->count++;
+  pEntry = &pTrace->entries[slot % pTrace->size];
+#endif
+  pEntry->time = *sendTime;
+  pEntry->latency = epicsTimeDiffInSeconds(&now, sendTime);
+  pEntry->replyLen = (unsigned int)replyLen;
+  pEntry->status = status;
+  strncpy(pEntry->command, command, MOTOR_TRACE_COMMAND_SIZE-1);
+  pEntry->command[MOTOR_TRACE_COMMAND_SIZE-1] = 0;
+#ifdef HAVE_ATOMICS
+  /* A reader that sees the new seq also sees the new fields */
+  epicsAtomicWriteMemoryBarrier();
+  SEQ_SET(pEntry, slot + 1);
+#else
+  pEntry->seq = slot + 1;
+  epicsMutexUnlock(pTrace->countLock);
+#endif
+}
+
+static FILE *openOutput(const char *fileName)
+{
+  FILE *fp;
+
+  if (!fileName || !fileName[0]) return stdout;
+  fp = fopen(fileName, "w");
+  if (!fp) printf("%s: cannot open %s\n", driverName, fileName);
+  return fp;
+}
+
+/** Copies the last count entries of a ring, oldest first, leaving out those being written.
+  * \return The number of entries copied. */
+static int copyEntries(motorTrace *pTrace, int count, motorTraceEntry *copy)
+{
+  motorTraceEntry *pEntry;
+  unsigned int last;
+  unsigned int first;
+  int n = 0;
+#ifdef HAVE_ATOMICS
+  unsigned int seq;
+
+  last = traceCount(pTrace);
+#else
+  epicsMutexMustLock(pTrace->countLock);
+  last = (unsigned int)pTrace->count;
+#endif
+  if ((count <= 0) || (count > pTrace->size)) count = pTrace->size;
+  if ((unsigned int)count > last) count = (int)last;
+  for (first = last - count; first != last; first++) {
+    pEntry = &pTrace->entries[first % pTrace->size];
+#ifdef HAVE_ATOMICS
+    /* Keep the copy only if seq is the same, and not 0, before and after it */
+    seq = SEQ_GET(pEntry);
+    epicsAtomicReadMemoryBarrier();
+    copy[n] = *pEntry;
+    epicsAtomicReadMemoryBarrier();
+    if ((seq == first + 1) && (SEQ_GET(pEntry) == first + 1)) n++;
+#else
+    copy[n] = *pEntry;
+    if (copy[n].seq == first + 1) n++;
+#endif
+  }
+#ifndef HAVE_ATOMICS
+  epicsMutexUnlock(pTrace->countLock);
+#endif
+  return n;
+}
+
+/** Prints the last count transactions of a ring, or lists the rings if name is empty.
+  * \param[in] name Name of the ring, the controller port name or the XPS "IP:port".
+  * \param[in] count Number of transactions, 0 for the whole ring.
+  * \param[in] fileName File to write, or empty for the console. */
+int motorTraceDump(const char *name, int count, const char *fileName)
+{
+  motorTrace *pTrace;
+  motorTraceEntry *copy;
+  char timeString[40];
+  FILE *fp;
+  int i, n;
+
+  if (!name || !name[0]) {
+    traceListInit();
+    epicsMutexMustLock(traceListLock);
+    for (pTrace = traceList; pTrace; pTrace = pTrace->next) {
+      printf("%s: %d entries, %u transactions\n", pTrace->name, pTrace->size, traceCount(pTrace));
+    }
+    epicsMutexUnlock(traceListLock);
+    return 0;
+  }
+  pTrace = motorTraceFind(name);
+  if (!pTrace) {
+    printf("%s:motorTraceDump: no trace %s\n", driverName, name);
+    return -1;
+  }
+  fp = openOutput(fileName);
+  if (!fp) return -1;
+  copy = (motorTraceEntry *)calloc(pTrace->size, sizeof(motorTraceEntry));
+  n = copyEntries(pTrace, count, copy);
+  fprintf(fp, "# %s, %d transactions\n", pTrace->name, n);
+  fprintf(fp, "# %-30s %10s %6s %6s  %s\n", "time", "ms", "reply", "status", "command");
+  for (i=0; i<n; i++) {
+    epicsTimeToStrftime(timeString, sizeof(timeString), "%Y/%m/%d %H:%M:%S.%06f", &copy[i].time);
+    fprintf(fp, "  %-30s %10.3f %6u %6d  %s\n", timeString, copy[i].latency*1000.,
+            copy[i].replyLen, copy[i].status, copy[i].command);
+  }
+  free(copy);
+  if (fp != stdout) fclose(fp);
+  return 0;
+}
+
+/* The type of a command is the command without its numbers, up to the first '(' or ','.
+ * "#01P" and "#02P" are both "#P", "GroupMoveAbsolute(GROUP1.POS,1.5)" is "GroupMoveAbsolute". */
+static void commandType(const char *command, char *type)
+{
+  int n = 0;
+
+  for (; *command && (*command != '(') && (*command != ','); command++) {
+    if (isdigit((unsigned char)*command) || (*command == '.') ||
+        (*command == '+') || (*command == '-')) continue;
+    type[n++] = *command;
+  }
+  while ((n > 0) && isspace((unsigned char)type[n-1])) n--;
+  type[n] = 0;
+}
+
+/** Prints the number of transactions, errors, mean and max latency, and a latency
+  * histogram for each type of command in a ring.
+  * \param[in] name Name of the ring.
+  * \param[in] fileName File to write, or empty for the console. */
+int motorTraceHistogram(const char *name, const char *fileName)
+{
+  motorTrace *pTrace;
+  motorTraceEntry *copy;
+  commandStats *stats;
+  commandStats *pS;
+  char type[MOTOR_TRACE_COMMAND_SIZE];
+  double ms;
+  FILE *fp;
+  int i, j, n, bin;
+  int numTypes = 0;
+
+  pTrace = motorTraceFind(name ? name : "");
+  if (!pTrace) {
+    printf("%s:motorTraceHistogram: no trace %s\n", driverName, name ? name : "");
+    return -1;
+  }
+  fp = openOutput(fileName);
+  if (!fp) return -1;
+  copy = (motorTraceEntry *)calloc(pTrace->size, sizeof(motorTraceEntry));
+  stats = (commandStats *)calloc(MAX_COMMAND_TYPES, sizeof(commandStats));
+  n = copyEntries(pTrace, 0, copy);
+  for (i=0; i<n; i++) {
+    commandType(copy[i].command, type);
+    for (j=0; j<numTypes; j++) {
+      if (strcmp(stats[j].type, type) == 0) break;
+    }
+    if (j == numTypes) {
+      /* The last type collects the commands past MAX_COMMAND_TYPES-1 types */
+      if (numTypes < MAX_COMMAND_TYPES-1) {
+        strcpy(stats[numTypes].type, type);
+        numTypes++;
+      } else {
+        j = MAX_COMMAND_TYPES - 1;
+        strcpy(stats[j].type, "(other)");
+        numTypes = MAX_COMMAND_TYPES;
+      }
+    }
+    pS = &stats[j];
+    ms = copy[i].latency * 1000.;
+    for (bin=0; bin<NUM_LATENCY_BINS-1; bin++) {
+      if (ms < binEdges[bin]) break;
+    }
+    pS->count++;
+    if (copy[i].status) pS->errors++;
+    pS->sum += ms;
+    if (ms > pS->max) pS->max = ms;
+    pS->bins[bin]++;
+  }
+
+  fprintf(fp, "# %s, %d transactions, latency in ms\n", pTrace->name, n);
+  fprintf(fp, "# %-20s %7s %6s %9s %9s ", "command", "count", "errors", "mean", "max");
+  for (bin=0; bin<NUM_LATENCY_BINS-1; bin++) fprintf(fp, " <%-5g", binEdges[bin]);
+  fprintf(fp, " >=%-5g\n", binEdges[NUM_LATENCY_BINS-2]);
+  for (j=0; j<numTypes; j++) {
+    pS = &stats[j];
+    fprintf(fp, "  %-20s %7d %6d %9.3f %9.3f ", pS->type, pS->count, pS->errors,
+            pS->sum/pS->count, pS->max);
+    for (bin=0; bin<NUM_LATENCY_BINS; bin++) fprintf(fp, " %6d", pS->bins[bin]);
+    fprintf(fp, "\n");
+  }
+  free(stats);
+  free(copy);
+  if (fp != stdout) fclose(fp);
+  return 0;
+}
+
+/* motorTraceDump */
+static const iocshArg motorTraceDumpArg0 = {"Trace name", iocshArgString};
+static const iocshArg motorTraceDumpArg1 = {"Number of transactions", iocshArgInt};
+static const iocshArg motorTraceDumpArg2 = {"File name", iocshArgString};
+static const iocshArg * const motorTraceDumpArgs[] = {&motorTraceDumpArg0,
+                                                      &motorTraceDumpArg1,
+                                                      &motorTraceDumpArg2};
+static const iocshFuncDef motorTraceDumpDef = {"motorTraceDump", 3, motorTraceDumpArgs};
+
+static void motorTraceDumpCallFunc(const iocshArgBuf *args)
+{
+  motorTraceDump(args[0].sval, args[1].ival, args[2].sval);
+}
+
+/* motorTraceHistogram */
+static const iocshArg motorTraceHistogramArg0 = {"Trace name", iocshArgString};
+static const iocshArg motorTraceHistogramArg1 = {"File name", iocshArgString};
+static const iocshArg * const motorTraceHistogramArgs[] = {&motorTraceHistogramArg0,
+                                                           &motorTraceHistogramArg1};
+static const iocshFuncDef motorTraceHistogramDef = {"motorTraceHistogram", 2, motorTraceHistogramArgs};
+
+static void motorTraceHistogramCallFunc(const iocshArgBuf *args)
+{
+  motorTraceHistogram(args[0].sval, args[1].sval);
+}
+
+static void motorTraceRegister(void)
+{
+  traceListInit();
+  iocshRegister(&motorTraceDumpDef, motorTraceDumpCallFunc);
+  iocshRegister(&motorTraceHistogramDef, motorTraceHistogramCallFunc);
+}
+epicsExportRegistrar(motorTraceRegister);
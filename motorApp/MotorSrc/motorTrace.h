@@ -0,0 +1,50 @@
+/* motorTrace.h
+ *
+ * Fixed-size ring of command/response records for controllers that talk to
+ * the hardware over asynOctet or the XPS socket library.
+ *
+ * Each transaction stores the time it was sent, the latency until the reply
+ * was read, the reply length, the status and the start of the command.  The
+ * ring is binary and nothing is formatted until it is dumped, so it can stay
+ * enabled in production.
+ */
+#ifndef MOTOR_TRACE_H
+#define MOTOR_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <shareLib.h>
+#include <epicsTime.h>
+
+#define MOTOR_TRACE_NAME_SIZE    64
+#define MOTOR_TRACE_COMMAND_SIZE 40   /* Longer commands are truncated */
+
+typedef struct motorTraceEntry {
+  unsigned int seq;                   /* Transaction number + 1, 0 while the entry is being written */
+  epicsTimeStamp time;                /* Time the command was sent */
+  double latency;                     /* Seconds from sending the command to the end of the reply */
+  unsigned int replyLen;              /* Number of characters in the reply */
+  int status;                         /* asynStatus, or the error code of the socket library */
+  char command[MOTOR_TRACE_COMMAND_SIZE];
+} motorTraceEntry;
+
+typedef struct motorTrace motorTrace;
+
+/* Number of entries of the rings created by controllers; 0 disables tracing.
+ * Set it with "var motorTraceSize 1024" before the controllers are created. */
+epicsShareExtern int motorTraceSize;
+
+epicsShareFunc motorTrace *motorTraceCreate(const char *name, int size);
+epicsShareFunc motorTrace *motorTraceFind(const char *name);
+epicsShareFunc void motorTraceRecord(motorTrace *pTrace, const char *command,
+                                     const epicsTimeStamp *sendTime, size_t replyLen, int status);
+epicsShareFunc int motorTraceDump(const char *name, int count, const char *fileName);
+epicsShareFunc int motorTraceHistogram(const char *name, const char *fileName);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* MOTOR_TRACE_H */
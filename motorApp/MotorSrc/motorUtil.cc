@@ -24,13 +24,31 @@ USAGE...        Motor Record Utility Support.
 *                  - Added redundant initialization error check. 
 * .02 03-11-08 rls - 64 bit compatability.
 *                  - add printChIDlist() to iocsh.
+* .03 10-19-26     - Use database access and db event subscriptions instead of
+*                    a CA client context.  The number of moving motors is kept
+*                    as a counter and a moving-set bitmap, so a DMOV change is
+*                    O(1) and allstop only visits moving motors.
+* .04 10-19-26     - allstop dispatches STOP through one callback per asyn port
+*                    (or per DTYP for other device support) and measures the
+*                    time from STOP to DMOV; $(P)stopLatency holds the worst
+*                    case of the last allstop.
+* .05 10-19-26     - Stops that do not reach DMOV within motorUtil_stopTimeout
+*                    are given up and logged, so the next allstop measures
+*                    afresh.  The group callbacks share the priorityHigh
+*                    callback queue; they only run concurrently when base
+*                    has callbackParallelThreads configured.
 */
 
 #include <stdio.h>
 #include <string.h>
-#include <cadef.h>
 #include <dbDefs.h>
+#include <dbAccess.h>
+#include <dbEvent.h>
+#include <callback.h>
 #include <epicsString.h>
+#include <epicsThread.h>
+#include <epicsMutex.h>
+#include <epicsTime.h>
 #include <cantProceed.h>
 #include <iocsh.h>
 #include <epicsExport.h>
@@ -38,7 +56,12 @@ USAGE...        Motor Record Utility Support.
 
 #include <motor.h>
 
-#define TIMEOUT 60 /* seconds */
+#if !LT_EPICSBASE(3,15,0,0)
+#include <dbChannel.h>
+typedef struct dbChannel eventChannel;
+#else
+typedef struct dbAddr eventChannel;
+#endif
 
 /* ----- External Declarations ----- */
 extern char **getMotorList();
@@ -47,28 +70,58 @@ extern char **getMotorList();
 /* ----- Function Declarations ----- */
 RTN_STATUS motorUtilInit(char *);
 static int motorUtil_task(void *);
-static chid getChID(char *);
-static long pvMonitor(int, chid, int);
-static void dmov_handler(struct event_handler_args);
-static void allstop_handler(struct event_handler_args);
-static void stopAll(chid, char *);
+static int getAddr(char *, DBADDR *);
+static dbEventSubscription pvMonitor(char *, DBADDR *, EVENTFUNC *, void *);
+static void dmov_handler(void *, eventChannel *, int, struct db_field_log *);
+static void allstop_handler(void *, eventChannel *, int, struct db_field_log *);
+static void stopAll(short);
 static int motorMovingCount();
-static void moving(int, chid, short);
+static void moving(int, short);
+static void getGroup(int);
+static void stopGroup(CALLBACK *);
+static void stopDone(int);
+static void stopTimeout(CALLBACK *);
 /* ----- --------------------- ----- */
 
 
 typedef struct motor_pv_info
 {
     char name[PVNAME_SZ];      /* pv names limited to 60 chars + term. in dbDefs.h */
-    chid chid_dmov;     /* Channel id for <motor name>.DMOV */
-    chid chid_stop;     /* Channel id for <motor name>.STOP */
+    DBADDR addr_dmov;   /* Database address of <motor name>.DMOV */
+    DBADDR addr_stop;   /* Database address of <motor name>.STOP */
+    dbEventSubscription sub_dmov;
     int in_motion;
-    int index;          /* Call to ca_add_event() must have ptr to argument. */
+    int index;          /* db_add_event() must have ptr to argument. */
+    int group;          /* Index into groupArray. */
+    bool stop_queued;   /* Waiting in its group's stop queue. */
+    bool stop_pending;  /* STOP sent by allstop, DMOV not yet seen. */
+    epicsTimeStamp stop_time;
+    double stop_latency;        /* Last STOP to DMOV time, seconds. */
 } Motor_pv_info;
 
+/* Motors sharing an asyn port (or, without asyn, a DTYP).  allstop queues one
+ * callback per group, which puts STOP to all of the group's queued motors, so
+ * each controller gets its stops in one batch.  The groups are queued at
+ * priorityHigh, which is served by a single callback thread unless
+ * callbackParallelThreads (base 3.16 and later) gives it more; only then do
+ * groups run concurrently. */
+typedef struct motor_port_group
+{
+    char port[PVNAME_SZ];
+    int numMembers;
+    int *queue;         /* Motor indices to stop; numMembers long. */
+    int numQueued;
+    int *work;          /* Copy of queue used by stopGroup(). */
+    bool queued;        /* The callback is queued or running. */
+    CALLBACK callback;
+} Port_group;
+
+#define MOVING_BITS 32  /* Motors per word of the moving-set bitmap. */
+
 
 /* ----- Global Variables ----- */
 int motorUtil_debug = 0;
+double motorUtil_stopTimeout = 10.0;   /* Seconds before an allstop stop is given up, 0 for never. */
 int numMotors = 0;
 /* ----- ---------------- ----- */
 
@@ -76,9 +129,22 @@ int numMotors = 0;
 static Motor_pv_info *motorArray;
 static char **motorlist = 0;
 static char *vme;
+static epicsUInt32 *movingSet;  /* Bit i set <=> motorArray[i] is moving. */
+static int numMotorsMoving = 0;
 static int old_numMotorsMoving = 0;
 static short old_alldone_value = 1;
-static chid chid_allstop, chid_moving, chid_alldone, chid_movingdiff;
+static dbEventCtx eventCtx;
+static dbEventSubscription sub_allstop;
+static DBADDR addr_allstop, addr_moving, addr_alldone, addr_movingdiff;
+static DBADDR addr_stoplatency;
+static Port_group *groupArray;
+static int numGroups = 0;
+static epicsMutexId stopLock;   /* Guards the stop queues and stop tracking. */
+static int numStopPending = 0;
+static double stopWorst = 0.0;  /* Worst STOP to DMOV time of this allstop. */
+static int numStopTimeouts = 0; /* Stops given up by stopTimeout(). */
+static bool stopTimeoutQueued = false;
+static CALLBACK stopTimeoutCallback;
 /* ----- ---------------- ----- */
 
 
@@ -113,11 +179,7 @@ RTN_STATUS motorUtilInit(char *vme_name)
 static int motorUtil_task(void *arg)
 {
     char temp[PVNAME_STRINGSZ+5];
-    int itera, status;
-    epicsEventId wait_forever;
-
-    SEVCHK(ca_context_create(ca_enable_preemptive_callback),
-           "motorUtil: ca_context_create() error");
+    int itera;
 
     motorlist = getMotorList();
     if (motorUtil_debug)
@@ -127,148 +189,254 @@ static int motorUtil_task(void *arg)
     {
         motorArray = (Motor_pv_info *) callocMustSucceed(numMotors,
                                    sizeof(Motor_pv_info), "motorUtil:init()");
+        movingSet = (epicsUInt32 *) callocMustSucceed((numMotors + MOVING_BITS - 1) / MOVING_BITS,
+                                   sizeof(epicsUInt32), "motorUtil:init()");
    
-        /* setup $(P)moving */
+        /* setup $(P)moving, $(P)alldone and $(P)movingDiff */
         strcpy(temp, vme);
         strcat(temp, "moving.VAL");
-        chid_moving = getChID(temp);
-
-        /* setup $(P)alldone */
+        itera = getAddr(temp, &addr_moving);
         strcpy(temp, vme);
         strcat(temp, "alldone.VAL");
-        chid_alldone = getChID(temp);
-
-        /* setup $(P)movingDiff */
+        itera |= getAddr(temp, &addr_alldone);
         strcpy(temp, vme);
         strcat(temp, "movingDiff.VAL");
-        chid_movingdiff = getChID(temp);
+        itera |= getAddr(temp, &addr_movingdiff);
 
-	if (!chid_moving || !chid_alldone || !chid_movingdiff) {
+	if (itera != 0) {
 	    errlogPrintf("Failed to connect to %smoving or %salldone or %smovingDiff.\n"
 			 "Check prefix matches Db\n", vme, vme, vme);
-	    ca_task_exit();
 	    return ERROR;
 	}
 
+        /* $(P)stopLatency is optional, older databases don't have it. */
+        strcpy(temp, vme);
+        strcat(temp, "stopLatency.VAL");
+        getAddr(temp, &addr_stoplatency);
+
+        stopLock = epicsMutexMustCreate();
+        callbackSetCallback(stopTimeout, &stopTimeoutCallback);
+        callbackSetPriority(priorityLow, &stopTimeoutCallback);
+        groupArray = (Port_group *) callocMustSucceed(numMotors,
+                                   sizeof(Port_group), "motorUtil:init()");
+
+        /* All handlers run on this event task, one at a time. */
+        eventCtx = db_init_events();
+        if (!eventCtx || db_start_events(eventCtx, "motorUtilEvent", NULL, NULL,
+                                         epicsThreadPriorityMedium) != DB_EVENT_OK)
+        {
+            errlogPrintf("motorUtil: cannot start the database event task\n");
+            return ERROR;
+        }
+
         /* loop over motors in motorlist and fill in motorArray */
         for (itera=0; itera < numMotors; itera++)
         {
             motorArray[itera].index = itera;
-
-            /* Setup .DMOVs */
             strcpy(motorArray[itera].name, motorlist[itera]);
-            strcpy(temp, motorlist[itera]);
-            strcat(temp, ".DMOV");
-            motorArray[itera].chid_dmov = getChID(temp);
-            status = pvMonitor(1, motorArray[itera].chid_dmov, itera);
-                    
+            getGroup(itera);
+
             /* Setup .STOPs */
             strcpy(temp, motorlist[itera]);
             strcat(temp, ".STOP");
-            motorArray[itera].chid_stop = getChID(temp);        
+            getAddr(temp, &motorArray[itera].addr_stop);
+
+            /* Setup .DMOVs */
+            strcpy(temp, motorlist[itera]);
+            strcat(temp, ".DMOV");
+            motorArray[itera].sub_dmov = pvMonitor(temp, &motorArray[itera].addr_dmov,
+                                                   dmov_handler, &(motorArray[itera].index));
+        }
+
+        for (itera=0; itera < numGroups; itera++)
+        {
+            Port_group *pgroup = &groupArray[itera];
+
+            pgroup->queue = (int *) callocMustSucceed(pgroup->numMembers,
+                                   sizeof(int), "motorUtil:init()");
+            pgroup->work = (int *) callocMustSucceed(pgroup->numMembers,
+                                   sizeof(int), "motorUtil:init()");
+            callbackSetCallback(stopGroup, &pgroup->callback);
+            callbackSetPriority(priorityHigh, &pgroup->callback);
+            callbackSetUser(pgroup, &pgroup->callback);
         }
 
         /* setup $(P)allstop */
         strcpy(temp, vme);
         strcat(temp, "allstop.VAL");
-        chid_allstop = getChID(temp);
-	if (!chid_allstop) {
+        sub_allstop = pvMonitor(temp, &addr_allstop, allstop_handler, NULL);
+	if (!sub_allstop)
 	    errlogPrintf("Failed to connect to %sallstop\n",vme);
-	} else {
-	    status = pvMonitor(0, chid_allstop, -1);
-	}
     }
     
-    /* Wait on a (never signalled) event here, rather than suspending the
-       thread, so as not to show up in the thread list as "SUSPENDED", which
-       is usually a sign of a fault. */
-    wait_forever = epicsEventCreate(epicsEventEmpty);
-    if (wait_forever) {
-	epicsEventMustWait(wait_forever);
-    }
-    return(ERROR);
+    return(OK);
 }
 
 
-static chid getChID(char *PVname)
+static int getAddr(char *PVname, DBADDR *paddr)
 {
-    chid channelID = 0;
-    int status;
+    long status;
 
     if (motorUtil_debug)
-	errlogPrintf("getChID(%s)\n", PVname);
+	errlogPrintf("getAddr(%s)\n", PVname);
 
-    /* In R3.14 ca_create_channel() will replace ca_search_and_connect() */
-    status = ca_search_and_connect(PVname, &channelID, 0, 0);
-    if (status == ECA_NORMAL) 
+    status = dbNameToAddr(PVname, paddr);
+    if (status)
     {
-	status = ca_pend_io(TIMEOUT);
+        errlogPrintf("motorUtil.cc: getAddr(%s) error: %li\n", PVname, status);
+        memset(paddr, 0, sizeof(DBADDR));
+        return ERROR;
     }
+    return OK;
+}
+
+
+/* Find or create the stop group of a motor from its OUT link (@asyn(port,...))
+ * or, for other device support, its DTYP. */
+static void getGroup(int index)
+{
+    char temp[PVNAME_STRINGSZ+5];
+    char link[MAX_STRING_SIZE];
+    char port[PVNAME_SZ] = "";
+    DBADDR addr;
+    int itera;
 
-    if (status != ECA_NORMAL)
+    strcpy(temp, motorArray[index].name);
+    strcat(temp, ".OUT");
+    if (dbNameToAddr(temp, &addr) == 0 &&
+        dbGetField(&addr, DBR_STRING, link, NULL, NULL, NULL) == 0 &&
+        strncmp(link, "@asyn(", 6) == 0)
     {
-        SEVCHK(status, "ca_search_and_connect");
-        errlogPrintf("motorUtil.cc: getChID(%s) error: %i\n", PVname, status);
-	channelID = 0;
+        strncpy(port, link + 6, PVNAME_SZ - 1);
+        port[strcspn(port, ",) ")] = 0;
     }
-    return channelID;
+    else
+    {
+        strcpy(temp, motorArray[index].name);
+        strcat(temp, ".DTYP");
+        if (dbNameToAddr(temp, &addr) == 0 &&
+            dbGetField(&addr, DBR_STRING, link, NULL, NULL, NULL) == 0)
+            strncpy(port, link, PVNAME_SZ - 1);
+    }
+
+    for (itera=0; itera < numGroups; itera++)
+        if (strcmp(groupArray[itera].port, port) == 0)
+            break;
+    if (itera == numGroups)
+        strcpy(groupArray[numGroups++].port, port);
+    groupArray[itera].numMembers++;
+    motorArray[index].group = itera;
 }
 
 
-static long pvMonitor(int eventType, chid channelID, int motor_index)
+/* Subscribe to value changes of PVname; the handler reads the value with
+ * dbGetField() on *paddr.  The current value is delivered immediately. */
+static dbEventSubscription pvMonitor(char *PVname, DBADDR *paddr,
+                                     EVENTFUNC *handler, void *handler_arg)
 {
-    int status; 
+    dbEventSubscription sub;
 
-    /* Create monitor */
-    if (eventType)      /* moving() */
-        status = ca_add_event(DBR_SHORT, channelID, &dmov_handler,
-                              &(motorArray[motor_index].index), 0);
-    else                /* stopAll() */
-        status = ca_add_event(DBR_STRING, channelID, &allstop_handler, 0, 0);
-    status = ca_pend_io(TIMEOUT);
+    if (getAddr(PVname, paddr) != OK)
+        return NULL;
 
-    if (status != ECA_NORMAL)
+#if LT_EPICSBASE(3,15,0,0)
+    sub = db_add_event(eventCtx, paddr, handler, handler_arg, DBE_VALUE);
+#else
     {
-        SEVCHK(status, "ca_add_event");
-        ca_task_exit(); /* this is serious */
-        return status;
-    }
+        dbChannel *chan = dbChannelCreate(PVname);
 
-    return ECA_NORMAL;
+        if (!chan || dbChannelOpen(chan))
+        {
+            errlogPrintf("motorUtil.cc: pvMonitor(%s) channel error\n", PVname);
+            if (chan)
+                dbChannelDelete(chan);
+            return NULL;
+        }
+        sub = db_add_event(eventCtx, chan, handler, handler_arg, DBE_VALUE);
+    }
+#endif
+    if (!sub)
+    {
+        errlogPrintf("motorUtil.cc: pvMonitor(%s) db_add_event error\n", PVname);
+        return NULL;
+    }
+    db_event_enable(sub);
+    db_post_single_event(sub);
+    return sub;
 }
 
 
-static void allstop_handler(struct event_handler_args args)
+static void allstop_handler(void *arg, eventChannel *chan, int eventsRemaining,
+                            struct db_field_log *pfl)
 {
-    stopAll(args.chid, (char *) args.dbr);
+    short value;
+
+    if (dbGetField(&addr_allstop, DBR_SHORT, &value, NULL, NULL, NULL) == 0)
+        stopAll(value);
 }
 
 
-static void stopAll(chid callback_chid, char *callback_value)
+static void stopAll(short allstop_value)
 {
-    int itera, status = 0;
-    short val = 1, release_val = 0;
-    
-    if (callback_chid != chid_allstop)
-        errlogPrintf("callback_chid = %p, chid_allstop = %p\n", callback_chid,
-                      chid_allstop);
+    int word, bit, itera;
+    short release_val = 0;
     
-    if (strcmp(callback_value, "release") != 0)
+    if (allstop_value != 0)
     {
-        /* if at least one motor is moving, then continue with stop all */
-        if (motorMovingCount())
+        epicsTimeStamp now;
+
+        epicsTimeGetCurrent(&now);
+        epicsMutexLock(stopLock);
+        if (numStopPending == 0)
+            stopWorst = 0.0;
+
+        /* Only stop a motor that is moving.  This should avoid problems caused by
+           trying to stop motor records for which device and driver support have
+           not been loaded.  Whole words of the moving set are skipped at once. */
+        for (word = 0; numMotorsMoving && word * MOVING_BITS < numMotors; word++)
         {
-            for(itera=0; itera < numMotors; itera++)
-	        /* Only stop a motor that is moving.  This should avoid problems caused by trying
-		to stop motor records for which device and driver support have not been loaded.*/
-                if (motorArray[itera].in_motion == 1)
-		    ca_put(DBR_SHORT, motorArray[itera].chid_stop, &val);
-            status = ca_flush_io(); 
+            epicsUInt32 bits = movingSet[word];
+
+            for (bit = 0; bits != 0; bit++, bits >>= 1)
+            {
+                Motor_pv_info *pmotor;
+                Port_group *pgroup;
+
+                if ((bits & 1) == 0)
+                    continue;
+                itera = word * MOVING_BITS + bit;
+                pmotor = &motorArray[itera];
+                if (!pmotor->addr_stop.precord || pmotor->stop_queued)
+                    continue;
+                pgroup = &groupArray[pmotor->group];
+                pgroup->queue[pgroup->numQueued++] = itera;
+                pmotor->stop_queued = true;
+                if (!pmotor->stop_pending)
+                    numStopPending++;
+                pmotor->stop_pending = true;
+                pmotor->stop_time = now;
+            }
         }
 
+        for (itera = 0; itera < numGroups; itera++)
+        {
+            Port_group *pgroup = &groupArray[itera];
+
+            if (pgroup->numQueued && !pgroup->queued)
+            {
+                pgroup->queued = true;
+                callbackRequest(&pgroup->callback);
+            }
+        }
+        if (numStopPending && !stopTimeoutQueued && motorUtil_stopTimeout > 0)
+        {
+            stopTimeoutQueued = true;
+            callbackRequestDelayed(&stopTimeoutCallback, motorUtil_stopTimeout);
+        }
+        epicsMutexUnlock(stopLock);
+
         /* reset allstop so that it may be called again */
-        ca_put(DBR_SHORT, chid_allstop, &release_val);
-        status = ca_flush_io();
+        dbPutField(&addr_allstop, DBR_SHORT, &release_val, 1);
         if (motorUtil_debug)
             errlogPrintf("reset allstop to \"release\"\n");
     }
@@ -277,17 +445,129 @@ static void stopAll(chid callback_chid, char *callback_value)
 }
 
 
-static void dmov_handler(struct event_handler_args args)
+/* Callback that sends STOP to every queued motor of one group. */
+static void stopGroup(CALLBACK *pcallback)
 {
-    moving(*((int *) args.usr), args.chid, *((short *) args.dbr));
+    void *puser;
+    Port_group *pgroup;
+    int itera, numWork;
+    short val = 1;
+
+    callbackGetUser(puser, pcallback);
+    pgroup = (Port_group *) puser;
+
+    epicsMutexLock(stopLock);
+    numWork = pgroup->numQueued;
+    memcpy(pgroup->work, pgroup->queue, numWork * sizeof(int));
+    pgroup->numQueued = 0;
+    pgroup->queued = false;
+    for (itera = 0; itera < numWork; itera++)
+        motorArray[pgroup->work[itera]].stop_queued = false;
+    epicsMutexUnlock(stopLock);
+
+    for (itera = 0; itera < numWork; itera++)
+        dbPutField(&motorArray[pgroup->work[itera]].addr_stop, DBR_SHORT, &val, 1);
+
+    if (motorUtil_debug)
+        errlogPrintf("stopped %i motors on %s\n", numWork, pgroup->port);
+}
+
+
+/* A motor stopped by allstop reached DMOV; record its stop latency and
+ * publish the worst case so far. */
+static void stopDone(int index)
+{
+    Motor_pv_info *pmotor = &motorArray[index];
+    epicsTimeStamp now;
+    double worst;
+    int pending;
+
+    epicsTimeGetCurrent(&now);
+    epicsMutexLock(stopLock);
+    if (!pmotor->stop_pending)
+    {
+        epicsMutexUnlock(stopLock);
+        return;
+    }
+    pmotor->stop_pending = false;
+    pmotor->stop_latency = epicsTimeDiffInSeconds(&now, &pmotor->stop_time);
+    if (pmotor->stop_latency > stopWorst)
+        stopWorst = pmotor->stop_latency;
+    pending = --numStopPending;
+    worst = stopWorst;
+    epicsMutexUnlock(stopLock);
+
+    if (motorUtil_debug)
+        errlogPrintf("%s stopped in %f s, %i stops pending\n", pmotor->name,
+                     pmotor->stop_latency, pending);
+    if (addr_stoplatency.precord)
+        dbPutField(&addr_stoplatency, DBR_DOUBLE, &worst, 1);
 }
 
 
-static void moving(int callback_motor_index, chid callback_chid,
-                   short callback_dmov)
+/* Delayed callback that gives up on stops that have not reached DMOV within
+ * motorUtil_stopTimeout.  Their time so far is recorded as their latency and
+ * counts towards the worst case, and numStopPending no longer includes them,
+ * so the next allstop starts a new measurement. */
+static void stopTimeout(CALLBACK *pcallback)
+{
+    epicsTimeStamp now;
+    double age, worst, next = 0.0;
+    int itera, numExpired = 0;
+
+    epicsTimeGetCurrent(&now);
+    epicsMutexLock(stopLock);
+    for (itera = 0; numStopPending && itera < numMotors; itera++)
+    {
+        Motor_pv_info *pmotor = &motorArray[itera];
+
+        if (!pmotor->stop_pending)
+            continue;
+        age = epicsTimeDiffInSeconds(&now, &pmotor->stop_time);
+        if (age < motorUtil_stopTimeout)
+        {
+            /* Stopped by a later allstop; check it again when it is due. */
+            if (next == 0.0 || motorUtil_stopTimeout - age < next)
+                next = motorUtil_stopTimeout - age;
+            continue;
+        }
+        pmotor->stop_pending = false;
+        pmotor->stop_latency = age;
+        if (age > stopWorst)
+            stopWorst = age;
+        numStopPending--;
+        numStopTimeouts++;
+        numExpired++;
+        errlogPrintf("motorUtil: %s did not reach DMOV within %f s of allstop\n",
+                     pmotor->name, age);
+    }
+    worst = stopWorst;
+    stopTimeoutQueued = (next > 0.0);
+    if (stopTimeoutQueued)
+        callbackRequestDelayed(&stopTimeoutCallback, next);
+    epicsMutexUnlock(stopLock);
+
+    if (numExpired && addr_stoplatency.precord)
+        dbPutField(&addr_stoplatency, DBR_DOUBLE, &worst, 1);
+}
+
+
+static void dmov_handler(void *arg, eventChannel *chan, int eventsRemaining,
+                         struct db_field_log *pfl)
+{
+    int index = *((int *) arg);
+    short dmov;
+
+    if (dbGetField(&motorArray[index].addr_dmov, DBR_SHORT, &dmov, NULL, NULL, NULL) == 0)
+        moving(index, dmov);
+}
+
+
+static void moving(int callback_motor_index, short callback_dmov)
 {
     short new_alldone_value, done = 1, not_done = 0;
-    int numMotorsMoving, status;
+    epicsUInt32 mask = 1u << (callback_motor_index % MOVING_BITS);
+    epicsUInt32 *pword = &movingSet[callback_motor_index / MOVING_BITS];
     char diffChar;
     char diffStr[PVNAME_STRINGSZ+1];
 
@@ -295,19 +575,26 @@ static void moving(int callback_motor_index, chid callback_chid,
         errlogPrintf("%s is %s\n", motorArray[callback_motor_index].name,
                (callback_dmov) ? "STOPPED" : "MOVING");
 
+    /* The initial event and repeated values must not be counted twice. */
     if (callback_dmov)
     {                      
+        if (motorArray[callback_motor_index].in_motion)
+            numMotorsMoving--;
         motorArray[callback_motor_index].in_motion = 0;
+        *pword &= ~mask;
         diffChar = '-';
+        if (motorArray[callback_motor_index].stop_pending)
+            stopDone(callback_motor_index);
     }
     else
     {
+        if (!motorArray[callback_motor_index].in_motion)
+            numMotorsMoving++;
         motorArray[callback_motor_index].in_motion = 1;
+        *pword |= mask;
         diffChar = '+';
     }
     
-    numMotorsMoving = motorMovingCount();
-
     new_alldone_value = (numMotorsMoving) ? 0 : 1;
     
     /* check to see if $(P)alldone needs to be updated */
@@ -319,7 +606,7 @@ static void moving(int callback_motor_index, chid callback_chid,
             if (motorUtil_debug)
                 errlogPrintf("sending alldone = TRUE\n");
 
-            ca_put(DBR_SHORT, chid_alldone, &done);
+            dbPutField(&addr_alldone, DBR_SHORT, &done, 1);
             old_alldone_value = new_alldone_value;
         }
         else
@@ -327,7 +614,7 @@ static void moving(int callback_motor_index, chid callback_chid,
             if (motorUtil_debug)
                 errlogPrintf("sending alldone = FALSE\n");
 
-            ca_put(DBR_SHORT, chid_alldone, &not_done);
+            dbPutField(&addr_alldone, DBR_SHORT, &not_done, 1);
             old_alldone_value = new_alldone_value;
         }
     }
@@ -337,34 +624,28 @@ static void moving(int callback_motor_index, chid callback_chid,
     /* check to see if $(P)moving needs to be updated */
     if (numMotorsMoving != old_numMotorsMoving)
     {
+        epicsInt32 count = numMotorsMoving;
+
         if (motorUtil_debug)
             errlogPrintf("updating number of motors moving\n");
 
         /* give $(P)moving the appropriate value */
-        ca_put(DBR_LONG, chid_moving, &numMotorsMoving);
+        dbPutField(&addr_moving, DBR_LONG, &count, 1);
 	
 	/* Tell which motor's dmov changed */
 	sprintf(diffStr, "%c%s", diffChar, motorArray[callback_motor_index].name);
-	ca_array_put(DBR_CHAR, strlen(diffStr)+1, chid_movingdiff, diffStr); 
+	dbPutField(&addr_movingdiff, DBR_CHAR, diffStr, strlen(diffStr)+1);
 
         old_numMotorsMoving = numMotorsMoving;
     }
     else if (motorUtil_debug)
 	errlogPrintf("the number of motors moving remains the same.\n");
-    
-    /* send the ca_puts */
-    status = ca_flush_io();
 }
 
 
 static int motorMovingCount()
 {
-    int itera, in_motion_count=0;
-
-    for (itera=0; itera < numMotors; itera++)
-        in_motion_count += motorArray[itera].in_motion;
-
-    return in_motion_count;
+    return numMotorsMoving;
 }
 
 
@@ -372,10 +653,12 @@ void listMovingMotors()
 {
     int itera;
   
-    errlogPrintf("\nThe following motors are moving:\n");
+    if (!movingSet)
+        return;
+    errlogPrintf("\nThe following %i motors are moving:\n", motorMovingCount());
     
     for (itera=0; itera < numMotors; itera++)
-        if (motorArray[itera].in_motion == 1)
+        if (movingSet[itera / MOVING_BITS] & (1u << (itera % MOVING_BITS)))
             errlogPrintf("%s, index = %i\n", motorArray[itera].name,
                    motorArray[itera].index);
 }
@@ -387,16 +670,17 @@ void printChIDlist()
 
     for (itera=0; itera < numMotors; itera++)
     {
-        errlogPrintf("i = %i,\tname = %s\tchid_dmov = %p\tchid_stop = \
-               %p\tin_motion = %i\tindex = %i\n", itera,
-               motorArray[itera].name, motorArray[itera].chid_dmov,
-               motorArray[itera].chid_stop, motorArray[itera].in_motion,
-               motorArray[itera].index);
+        errlogPrintf("i = %i,\tname = %s\tsub_dmov = %p\tstop = %s\tin_motion = %i\tindex = %i\tport = %s\tstop latency = %f\n",
+               itera, motorArray[itera].name, motorArray[itera].sub_dmov,
+               motorArray[itera].addr_stop.precord ? "connected" : "not connected",
+               motorArray[itera].in_motion, motorArray[itera].index,
+               groupArray[motorArray[itera].group].port, motorArray[itera].stop_latency);
     }
     
-    errlogPrintf("chid_allstop = %p\n", chid_allstop);
-    errlogPrintf("chid_alldone = %p\n", chid_alldone);
-    errlogPrintf("chid_moving = %p\n",  chid_moving);
+    errlogPrintf("sub_allstop = %p\n", sub_allstop);
+    errlogPrintf("moving = %i\n", motorMovingCount());
+    errlogPrintf("stop groups = %i, stops pending = %i, worst stop latency = %f, stops timed out = %i\n",
+                 numGroups, numStopPending, stopWorst, numStopTimeouts);
 }
 
 
@@ -439,6 +723,7 @@ static void motorUtilRegister(void)
 
 epicsExportRegistrar(motorUtilRegister);
 epicsExportAddress(int, motorUtil_debug);
+epicsExportAddress(double, motorUtil_stopTimeout);
 
 } // extern "C"
 
@@ -57,6 +57,8 @@ USAGE... This file contains device functions that are common to all motor
  * .14  08/19/14 rls Moved RMP and REP posting from record to here.
  * .15  07/29/15 rls Added "Use Relative" (use_rel) indicator to "init_pos" logic in
  *                   motor_init_record_com(). See README R6-10 item #6 for details.
+ * .16  10/19/26     Leave RMP, REP and RVEL posting to the record while it is
+ *                   decimating readback monitors (MDEC).
  */
 
 
@@ -409,20 +411,30 @@ epicsShareFunc CALLBACK_VALUE motor_update_values(struct motorRecord * mr)
     /* raw motor pulse count */
     if (ptrans->callback_changed == YES)
     {
+        /* While the record is decimating monitors (MDEC), it posts these. */
         if (mr->rmp != ptrans->motor_pos)
         {
             mr->rmp = ptrans->motor_pos;
-            db_post_events(mr, &mr->rmp, DBE_VAL_LOG);
+            if (mr->mdec)
+                mr->mdfr = 1;
+            else
+                db_post_events(mr, &mr->rmp, DBE_VAL_LOG);
         }
         if (mr->rep != ptrans->encoder_pos)
         {
             mr->rep = ptrans->encoder_pos;
-            db_post_events(mr, &mr->rep, DBE_VAL_LOG);
+            if (mr->mdec)
+                mr->mdfr = 1;
+            else
+                db_post_events(mr, &mr->rep, DBE_VAL_LOG);
         }
         if (mr->rvel != ptrans->vel)
         {
             mr->rvel = ptrans->vel;
-            db_post_events(mr, &mr->rvel, DBE_VAL_LOG);
+            if (mr->mdec)
+                mr->mdfr = 1;
+            else
+                db_post_events(mr, &mr->rvel, DBE_VAL_LOG);
         }
         mr->msta = ptrans->status.All;
         ptrans->callback_changed = NO;
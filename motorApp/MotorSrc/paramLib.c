@@ -6,6 +6,10 @@ with the EPICS motor API, so a number of the routines in a motor driver can
 be simple pass-through routines calling this library. For an example, see the
 drvMotorSim.c code.
 
+Values are stored in separate integer, double and type arrays, and changed
+parameters are recorded in a bitmap with one bit per parameter, so that
+paramCallCallback only has to visit the words of the bitmap that have bits set.
+
 */
 
 #include <stdio.h>
@@ -14,32 +18,46 @@ drvMotorSim.c code.
 #include <math.h>
 #define epicsExportSharedSymbols
 #include <shareLib.h>
+#include <epicsTypes.h>
 #include "paramLib.h"
 
 typedef enum { paramUndef, paramDouble, paramInt } paramType;
 
-typedef struct
-{
-    paramType type;
-    union
-    {
-        double dval;
-        int    ival;
-    } data;
-} paramVal;
+/* Number of parameters per word of the changed bitmap */
+#define FLAG_BITS 32
+#define FLAG_WORD(index) ((index) / FLAG_BITS)
+#define FLAG_MASK(index) (((epicsUInt32) 1) << ((index) % FLAG_BITS))
 
 typedef struct paramList
 {
     paramIndex startVal;
     paramIndex nvals;
-    int * flags;
+    paramIndex nwords;
+    epicsUInt32 * flags;
     paramIndex * set_flags;
-    paramVal * vals;
+    unsigned char * types;
+    int * ivals;
+    double * dvals;
     int forceCallback;
     paramCallback callback;
     void * param;
 } paramList;
 
+/* Returns the position of the lowest bit set in a non-zero word */
+static unsigned int lowestBit( epicsUInt32 word )
+{
+#if defined(__GNUC__)
+    return __builtin_ctz( word );
+#else
+    static const unsigned char debruijn[32] =
+    {
+         0,  1, 28,  2, 29, 14, 24,  3, 30, 22, 20, 15, 25, 17,  4,  8,
+        31, 27, 13, 23, 21, 19, 16,  7, 26, 12, 18,  6, 11,  5, 10,  9
+    };
+    return debruijn[((word & (~word + 1)) * 0x077CB531U) >> 27];
+#endif
+}
+
 /** Deletes a parameter system created by paramCreate.
 
     Allocates data structures for a parameter system with the given number of
@@ -52,9 +70,12 @@ typedef struct paramList
 */
 static void paramDestroy( PARAMS params )
 {
+    if (params == NULL) return;
     if (params->flags != NULL) free( params->flags );
     if (params->set_flags != NULL) free( params->set_flags );
-    if (params->vals != NULL) free( params->vals );
+    if (params->types != NULL) free( params->types );
+    if (params->ivals != NULL) free( params->ivals );
+    if (params->dvals != NULL) free( params->dvals );
     free( params );
     params = NULL;
 }
@@ -73,19 +94,24 @@ static void paramDestroy( PARAMS params )
 static PARAMS paramCreate( paramIndex startVal, paramIndex nvals )
 {
     PARAMS params = (PARAMS) calloc( 1, sizeof(paramList ));
+    paramIndex nwords = (nvals + FLAG_BITS - 1) / FLAG_BITS;
 
     if ( nvals > 0 &&
          (params != NULL) &&
-         ((params->flags = (int *) calloc( nvals, sizeof(int))) != NULL ) &&
+         ((params->flags = (epicsUInt32 *) calloc( nwords, sizeof(epicsUInt32))) != NULL ) &&
          ((params->set_flags = (paramIndex *) calloc( nvals, sizeof(paramIndex))) != NULL ) &&
-         ((params->vals = (paramVal *) calloc( nvals, sizeof(paramVal)) ) != NULL ) )
+         ((params->types = (unsigned char *) calloc( nvals, sizeof(unsigned char))) != NULL ) &&
+         ((params->ivals = (int *) calloc( nvals, sizeof(int))) != NULL ) &&
+         ((params->dvals = (double *) calloc( nvals, sizeof(double))) != NULL ) )
     {
         params->startVal = startVal;
         params->nvals = nvals;
+        params->nwords = nwords;
     }
     else
     {
         paramDestroy( params );
+        params = NULL;
     }
 
     return params;
@@ -109,12 +135,12 @@ static int paramSetInteger( PARAMS params, paramIndex index, int value )
     index -= params->startVal;
     if (index >= 0 && index < params->nvals)
     {
-        if ( params->vals[index].type != paramInt ||
-             params->vals[index].data.ival != value )
+        if ( params->types[index] != paramInt ||
+             params->ivals[index] != value )
         {
-            params->flags[index] = 1;
-            params->vals[index].type = paramInt;
-            params->vals[index].data.ival = value;
+            params->flags[FLAG_WORD(index)] |= FLAG_MASK(index);
+            params->types[index] = paramInt;
+            params->ivals[index] = value;
         }
         status = PARAM_OK;
     }
@@ -138,12 +164,12 @@ static int paramSetDouble( PARAMS params, paramIndex index, double value )
     index -= params->startVal;
     if (index >=0 && index < params->nvals)
     {
-        if ( params->vals[index].type != paramDouble ||
-             params->vals[index].data.dval != value )
+        if ( params->types[index] != paramDouble ||
+             params->dvals[index] != value )
         {
-            params->flags[index] = 1;
-            params->vals[index].type = paramDouble;
-            params->vals[index].data.dval = value;
+            params->flags[FLAG_WORD(index)] |= FLAG_MASK(index);
+            params->types[index] = paramDouble;
+            params->dvals[index] = value;
         }
         status = PARAM_OK;
     }
@@ -167,10 +193,10 @@ static int paramGetInteger( PARAMS params, paramIndex index, int * value )
     index -= params->startVal;
     if (index >= 0 && index < params->nvals)
     {
-        switch (params->vals[index].type)
+        switch (params->types[index])
         {
-        case paramDouble: *value = (int) floor(params->vals[index].data.dval+0.5); break;
-        case paramInt: *value = params->vals[index].data.ival; break;
+        case paramDouble: *value = (int) floor(params->dvals[index]+0.5); break;
+        case paramInt: *value = params->ivals[index]; break;
         default: status = 0;
         }
     }
@@ -196,10 +222,10 @@ static int paramGetDouble( PARAMS params, paramIndex index, double * value )
     index -= params->startVal;
     if (index >= 0 && index < params->nvals)
     {
-        switch (params->vals[index].type)
+        switch (params->types[index])
         {
-        case paramDouble: *value = params->vals[index].data.dval; break;
-        case paramInt: *value = (double) params->vals[index].data.ival; break;
+        case paramDouble: *value = params->dvals[index]; break;
+        case paramInt: *value = (double) params->ivals[index]; break;
         default: status = 0;
         }
     }
@@ -232,9 +258,9 @@ static int paramSetCallback( PARAMS params, paramCallback callback, void * param
     /* Force a callback on all defined parameters if the callback changes */
     if ( params->callback )
     {
-        int i;
+        paramIndex i;
         for (i = 0; i < params->nvals; i++)
-            if (params->vals[i].type != paramUndef) params->flags[i] = 1;
+            if (params->types[i] != paramUndef) params->flags[FLAG_WORD(i)] |= FLAG_MASK(i);
     }
 
     return PARAM_OK;
@@ -244,6 +270,7 @@ static int paramSetCallback( PARAMS params, paramCallback callback, void * param
 
     This routine should be called whenever you have changed a number of parameters and wish
     to notify someone (via the callback routine) that they have changed.
+    Only the words of the changed bitmap that are non-zero are examined.
 
     \param params   [in]   Pointer to PARAM handle returned by paramCreate.
 
@@ -251,18 +278,21 @@ static int paramSetCallback( PARAMS params, paramCallback callback, void * param
 */
 static void paramCallCallback( PARAMS params )
 {
-    unsigned int i;
+    paramIndex i;
     int nFlags=0;
 
-    for (i = 0; i < params->nvals; i++)
+    for (i = 0; i < params->nwords; i++)
     {
-        if (params->flags[i])
+        epicsUInt32 word = params->flags[i];
+
+        if (word == 0) continue;
+        params->flags[i] = 0;
+        while (word)
         {
-            params->set_flags[nFlags] = i + params->startVal;
+            params->set_flags[nFlags] = i * FLAG_BITS + lowestBit( word ) + params->startVal;
             nFlags++;
-            params->flags[i] = 0;
+            word &= word - 1;
         }
-
     }
     if ( (params->forceCallback || nFlags > 0) && params->callback != NULL )
     {
@@ -303,13 +333,13 @@ static void paramDump( PARAMS params )
     printf( "Number of parameters is: %d\n", params->nvals );
     for (i =0; i < params->nvals; i++)
     {
-        switch (params->vals[i].type)
+        switch (params->types[i])
         {
         case paramDouble:
-            printf( "Parameter %d is a double, value %f\n", i+ params->startVal, params->vals[i].data.dval );
+            printf( "Parameter %d is a double, value %f\n", i+ params->startVal, params->dvals[i] );
             break;
         case paramInt:
-            printf( "Parameter %d is an integer, value %d\n", i+ params->startVal, params->vals[i].data.ival );
+            printf( "Parameter %d is an integer, value %d\n", i+ params->startVal, params->ivals[i] );
             break;
         default:
             printf( "Parameter %d is undefined\n", i+ params->startVal );
@@ -0,0 +1,76 @@
+/* paramLibBench.c
+ *
+ * Microbenchmark of the motor parameter library (paramLib.c).
+ *
+ * Simulates a model 2 driver poller: each cycle sets a number of integer and
+ * double parameters, some of which change, and then calls paramCallCallback.
+ *
+ * Usage: paramLibBench [nParams [nCycles [nChanged]]]
+ *     nParams   Number of parameters in the list (default 40)
+ *     nCycles   Number of poll cycles to run (default 1000000)
+ *     nChanged  Number of parameters that change each cycle (default 4)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <epicsTime.h>
+
+#include "paramLib.h"
+
+static unsigned long nCallbacks;
+static unsigned long nChanges;
+
+static void benchCallback(void *param, unsigned int nChanged, unsigned int *changed)
+{
+    nCallbacks++;
+    nChanges += nChanged;
+}
+
+int main(int argc, char *argv[])
+{
+    int nParams = 40;
+    int nCycles = 1000000;
+    int nChanged = 4;
+    int cycle, i;
+    PARAMS params;
+    epicsTimeStamp start, end;
+    double elapsed;
+
+    if (argc > 1) nParams = atoi(argv[1]);
+    if (argc > 2) nCycles = atoi(argv[2]);
+    if (argc > 3) nChanged = atoi(argv[3]);
+    if (nParams < 1 || nCycles < 1 || nChanged < 0 || nChanged > nParams) {
+        printf("Usage: %s [nParams [nCycles [nChanged]]], 0 <= nChanged <= nParams\n", argv[0]);
+        return 1;
+    }
+
+    params = motorParam->create(0, nParams);
+    if (!params) {
+        printf("Cannot create parameter list\n");
+        return 1;
+    }
+    motorParam->setCallback(params, benchCallback, NULL);
+
+    epicsTimeGetCurrent(&start);
+    for (cycle = 0; cycle < nCycles; cycle++) {
+        /* A poller sets every parameter; only the first nChanged get new values */
+        for (i = 0; i < nParams; i++) {
+            if (i % 2)
+                motorParam->setInteger(params, i, (i < nChanged) ? cycle : 0);
+            else
+                motorParam->setDouble(params, i, (i < nChanged) ? (double) cycle : 0.);
+        }
+        motorParam->callCallback(params);
+    }
+    epicsTimeGetCurrent(&end);
+    elapsed = epicsTimeDiffInSeconds(&end, &start);
+
+    printf("%d parameters, %d cycles, %d changed per cycle\n", nParams, nCycles, nChanged);
+    printf("Elapsed time %f s, %f us per cycle, %f ns per set\n",
+           elapsed, 1.e6 * elapsed / nCycles, 1.e9 * elapsed / ((double) nCycles * nParams));
+    printf("%lu callbacks, %lu changes delivered\n", nCallbacks, nChanges);
+
+    motorParam->destroy(params);
+    return 0;
+}
@@ -105,7 +105,12 @@ HXPController::HXPController(const char *portName, const char *IPAddress, int IP
   
   HXPFirmwareVersionGet(pollSocket_, firmwareVersion_);
 
+  pollStatus_ = 0;
+  groupStatus_ = 0;
+  movesDeferred_ = false;
   for (axis=0; axis<NUM_AXES; axis++) {
+    encoderPositions_[axis] = 0.0;
+    setpointPositions_[axis] = 0.0;
     pAxis = new HXPAxis(this, axis);
   }
 
@@ -146,6 +151,10 @@ void HXPController::report(FILE *fp, int level)
   
   fprintf(fp, "Newport hexapod motor driver %s, numAxes=%d, moving poll period=%f, idle poll period=%f, coordSys=%d\n", 
     this->portName, NUM_AXES, movingPollPeriod_, idlePollPeriod_, coordSys);
+  if (level > 0) {
+    fprintf(fp, "  groupStatus=%d, pollStatus=%d, movesDeferred=%d\n",
+      groupStatus_, pollStatus_, movesDeferred_);
+  }
 
   // Call the base class method
   asynMotorController::report(fp, level);
@@ -335,6 +344,116 @@ int HXPController::setCS(HXPAxis *pAxis)
   return status;
 }
 
+/** Polls the hexapod group.
+  * The group status and all six current and setpoint positions are read with one
+  * call each, and HXPAxis::poll() takes its values from here.
+  */
+asynStatus HXPController::poll()
+{
+  static const char *functionName = "HXPController::poll";
+
+  pollStatus_ = HXPGroupStatusGet(pollSocket_, GROUP, &groupStatus_);
+  if (pollStatus_) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR, 
+              "%s:%s: [%s]: error calling GroupStatusGet status=%d; pollSocket=%d\n",
+              driverName, functionName, portName, pollStatus_, pollSocket_);
+    return asynError;
+  }
+  setIntegerParam(HXPStatus_, groupStatus_);
+
+  pollStatus_ = HXPGroupPositionCurrentGet(pollSocket_, GROUP, NUM_AXES, encoderPositions_);
+  if (pollStatus_) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR, 
+              "%s:%s: [%s]: error calling GroupPositionCurrentGet status=%d\n",
+              driverName, functionName, portName, pollStatus_);
+    return asynError;
+  }
+
+  pollStatus_ = HXPGroupPositionSetpointGet(pollSocket_, GROUP, NUM_AXES, setpointPositions_);
+  if (pollStatus_) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR, 
+              "%s:%s: [%s]: error calling GroupPositionSetpointGet status=%d\n",
+              driverName, functionName, portName, pollStatus_);
+    return asynError;
+  }
+  return asynSuccess;
+}
+
+/** Starts or ends deferred moves.
+  * When deferred moves end, the moves stored by HXPAxis::move() are sent as
+  * one hexapod move by processDeferredMoves().
+  * \param[in] defer True to defer moves, false to send the deferred moves. */
+asynStatus HXPController::setDeferredMoves(bool defer)
+{
+  if (defer) {
+    movesDeferred_ = true;
+    return asynSuccess;
+  }
+  if (!movesDeferred_) return asynSuccess;
+  movesDeferred_ = false;
+  return processDeferredMoves();
+}
+
+/** Sends the deferred moves of all axes as a single hexapod move.
+  * In the Work coordinate system this is one HexapodMoveAbsolute, where the axes without
+  * a deferred move keep their current position.  In the Tool coordinate system, which has
+  * no absolute move, it is one HexapodMoveIncremental. */
+asynStatus HXPController::processDeferredMoves()
+{
+  int status;
+  int axis;
+  int coordSys; // 0 = work, 1 = tool
+  bool anyDeferred = false;
+  double curPos[NUM_AXES];
+  double pos[NUM_AXES];
+  HXPAxis *pAxis;
+  static const char *functionName = "HXPController::processDeferredMoves";
+
+  for (axis=0; axis<NUM_AXES; axis++) {
+    if (getAxis(axis)->deferredMove_) anyDeferred = true;
+  }
+  if (!anyDeferred) return asynSuccess;
+
+  getIntegerParam(HXPMoveCoordSys_, &coordSys);
+  status = HXPGroupPositionCurrentGet(pollSocket_, GROUP, NUM_AXES, curPos);
+  if (status == 0) {
+    for (axis=0; axis<NUM_AXES; axis++) {
+      pAxis = getAxis(axis);
+      if (!pAxis->deferredMove_)
+        pos[axis] = curPos[axis];
+      else if (pAxis->deferredRelative_)
+        pos[axis] = curPos[axis] + pAxis->deferredPosition_;
+      else
+        pos[axis] = pAxis->deferredPosition_;
+      /* The Tool coordinate system only takes incremental moves */
+      if (coordSys != 0) pos[axis] -= curPos[axis];
+    }
+    asynPrint(pasynUserSelf, ASYN_TRACE_FLOW,
+              "%s:%s: [%s]: deferred move to %f %f %f %f %f %f\n",
+              driverName, functionName, portName, pos[0], pos[1], pos[2], pos[3], pos[4], pos[5]);
+    pAxis = getAxis(0);
+    if (coordSys == 0)
+      status = HXPHexapodMoveAbsolute(pAxis->moveSocket_, GROUP, "Work", pos[0], pos[1], pos[2], pos[3], pos[4], pos[5]);
+    else
+      status = HXPHexapodMoveIncremental(pAxis->moveSocket_, GROUP, "Tool", pos[0], pos[1], pos[2], pos[3], pos[4], pos[5]);
+  }
+
+  /* Clear the deferred moves of all axes; a failed move is not retried */
+  for (axis=0; axis<NUM_AXES; axis++) {
+    getAxis(axis)->deferredMove_ = false;
+  }
+
+  if (status != 0 && status != -27) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s:%s: [%s]: error performing deferred move, status=%d\n",
+              driverName, functionName, portName, status);
+    postError(getAxis(0), status);
+    return asynError;
+  }
+  postError(getAxis(0), 0);
+  return asynSuccess;
+}
+
 void HXPController::postError(HXPAxis *pAxis, int status)
 {
   /* This is similar to what is done in HXPAxis::move() */
@@ -386,6 +505,11 @@ HXPAxis::HXPAxis(HXPController *pC, int axisNo)
   HXPTCP_SetTimeout(moveSocket_, -0.1);
   pollSocket_ = pC_->pollSocket_;
 
+  /* Initialise deferred move flags. */
+  deferredPosition_ = 0.0;
+  deferredMove_ = false;
+  deferredRelative_ = false;
+
   /* Enable gain support so that the CNEN field to enable/disable the hexapod */
   setIntegerParam(pC_->motorStatusGainSupport_, 1);
   // does the hexapod read encoders from the stages? leave in for now to test relative moves
@@ -423,6 +547,14 @@ asynStatus HXPAxis::move(double position, int relative, double baseVelocity, dou
   static const char *functionName = "HXPAxis::move";
   asynStatus retval = asynSuccess;
 
+  /* Deferred moves are sent together by HXPController::processDeferredMoves() */
+  if (pC_->movesDeferred_) {
+    deferredPosition_ = position * MRES;
+    deferredRelative_ = (relative != 0);
+    deferredMove_ = true;
+    return asynSuccess;
+  }
+
   pC_->getIntegerParam(pC_->HXPMoveCoordSys_, &coordSys); 
   
   if (relative) {
@@ -569,35 +701,24 @@ asynStatus HXPAxis::setClosedLoop(bool closedLoop)
 }
 
 /** Polls the axis.
-  * This function reads the motor position, the limit status, the home status, the moving status, 
-  * and the drive power-on status. 
+  * This function sets the motor position, the moving status and the drive power-on status
+  * from the group status and positions that HXPController::poll() read for all axes.
   * It calls setIntegerParam() and setDoubleParam() for each item that it polls,
   * and then calls callParamCallbacks() at the end.
   * \param[out] moving A flag that is set indicating that the axis is moving (true) or done (false). */
 asynStatus HXPAxis::poll(bool *moving)
 { 
   int status;
-  //char readResponse[25];
 
   static const char *functionName = "HXPAxis::poll";
 
-  status = HXPGroupStatusGet(pollSocket_, 
-                          GROUP, 
-                          &axisStatus_);
-  if (status) {
-    asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
-              "%s:%s: [%s,%d]: error calling GroupStatusGet status=%d; pollSocket=%d\n",
-              driverName, functionName, pC_->portName, axisNo_, status, pollSocket_);
-    goto done;
-  }
+  status = pC_->pollStatus_;
+  if (status) goto done;
 
+  axisStatus_ = pC_->groupStatus_;
   asynPrint(pasynUser_, ASYN_TRACE_FLOW, 
             "%s:%s: [%s,%d]: %s axisStatus=%d\n",
             driverName, functionName, pC_->portName, axisNo_, positionerName_, axisStatus_);
-  /* Set the status */
-  /* Note: there is only one status PV for the controller. Currently it reflects the status of axis 0.
-           It might be better to call pC_->setIntegerParam(pC_->HXPStatus_, axisStatus_); */
-  setIntegerParam(pC_->HXPStatus_, axisStatus_);
 
   /* If the group is not moving then the axis is not moving */
   if ((axisStatus_ < 43) || (axisStatus_ > 48))
@@ -636,30 +757,10 @@ asynStatus HXPAxis::poll(bool *moving)
     setIntegerParam(pC_->motorStatusPowerOn_, 1);
   }
 
-  status = HXPGroupPositionCurrentGet(pollSocket_,
-                                   positionerName_,
-                                   1,
-                                   &encoderPosition_);
-  if (status) {
-    asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
-              "%s:%s: [%s,%d]: error calling GroupPositionCurrentGet status=%d\n",
-              driverName, functionName, pC_->portName, axisNo_, status);
-    goto done;
-  }
-  //setDoubleParam(pC_->motorEncoderPosition_, (encoderPosition_/stepSize_));
+  encoderPosition_ = pC_->encoderPositions_[axisNo_];
   setDoubleParam(pC_->motorEncoderPosition_, encoderPosition_ / MRES);
 
-  status = HXPGroupPositionSetpointGet(pollSocket_,
-                                   positionerName_,
-                                   1,
-                                   &setpointPosition_);
-  if (status) {
-    asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
-              "%s:%s: [%s,%d]: error calling GroupPositionSetpointGet status=%d\n",
-              driverName, functionName, pC_->portName, axisNo_, status);
-    goto done;
-  }
-  //setDoubleParam(pC_->motorPosition_, (setpointPosition_/stepSize_));
+  setpointPosition_ = pC_->setpointPositions_[axisNo_];
   setDoubleParam(pC_->motorPosition_, setpointPosition_ / MRES);
 
   // limit check?
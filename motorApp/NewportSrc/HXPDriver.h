@@ -78,6 +78,9 @@ private:
   int axisStatus_;
   double mres_;
   int moving_;
+  double deferredPosition_;
+  bool deferredMove_;
+  bool deferredRelative_;
   
 friend class HXPController;
 };
@@ -91,12 +94,15 @@ public:
   void report(FILE *fp, int level);
   HXPAxis* getAxis(asynUser *pasynUser);
   HXPAxis* getAxis(int axisNo);
+  asynStatus poll();
+  asynStatus setDeferredMoves(bool defer);
 
   /* These are the methods that are new to this class */
   int moveAll(HXPAxis* pAxis);
   int readAllCS(HXPAxis* pAxis);
   int setCS(HXPAxis* pAxis);
   void postError(HXPAxis* pAxis, int status);
+  asynStatus processDeferredMoves();
 
 protected:
   #define FIRST_HXP_PARAM HXPMoveCoordSys_
@@ -150,6 +156,11 @@ private:
   //int moveSocket_;
   char firmwareVersion_[100];
   char *axisNames_;
+  int pollStatus_;                           /* Status of the last group poll */
+  int groupStatus_;                          /* Group status from the last poll */
+  double encoderPositions_[MAX_HXP_AXES];   /* Current positions from the last poll */
+  double setpointPositions_[MAX_HXP_AXES];  /* Setpoint positions from the last poll */
+  bool movesDeferred_;
 
 friend class HXPAxis;
 };
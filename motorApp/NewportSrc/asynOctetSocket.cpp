@@ -27,6 +27,7 @@ typedef int BOOL;
 #include <asynCommonSyncIO.h>
 #include <drvAsynIPPort.h>
 #include <epicsExport.h>
+#include "motorTrace.h"
 
 
 /* The maximum number of sockets to XPS controllers.  The driver uses
@@ -52,6 +53,7 @@ typedef struct {
     char errorString[ERROR_STRING_SIZE];
     int connected;
     epicsMutexId mutexId;
+    motorTrace *pTrace;     /* Shared by all the sockets to one controller, NULL if motorTraceSize is 0 */
 } socketStruct;
 static socketStruct socketStructs[MAX_SOCKETS];
 
@@ -99,6 +101,10 @@ int ConnectToServer(char *IpAddress, int IpPort, double timeout)
      * we can't use a single write/read operation */
     psock->mutexId = epicsMutexMustCreate();
 
+    /* One trace per controller, named IpAddress:IpPort */
+    epicsSnprintf(portName, PORT_NAME_SIZE, "%s:%d", IpAddress, IpPort);
+    psock->pTrace = motorTraceCreate(portName, motorTraceSize);
+
     psock->timeout = timeout;
     psock->connected = 1;
     strcpy(psock->errorString, "");
@@ -129,7 +135,8 @@ void SendAndReceive (int SocketIndex, char buffer[], char valueRtrn[], int retur
     int status;
     int retries;
     int errStat;
-    size_t nread;
+    size_t nread = 0;
+    epicsTimeStamp sendTime;
 
     /* Check to see if the Socket is valid! */
     
@@ -147,6 +154,7 @@ void SendAndReceive (int SocketIndex, char buffer[], char valueRtrn[], int retur
     }
 
     epicsMutexMustLock(psock->mutexId);
+    if (psock->pTrace) epicsTimeGetCurrent(&sendTime);
     /* If timeout > 0. then we do a write read.  If < 0. then write. */
 
     if (psock->timeout > 0.0) {
@@ -223,7 +231,10 @@ void SendAndReceive (int SocketIndex, char buffer[], char valueRtrn[], int retur
             }
         }
         if (retries == MAX_RETRIES) strcpy(valueRtrn, "0");
+        /* A timeout is the normal end of a write */
+        if (status == asynTimeout) status = asynSuccess;
     }
+    if (psock->pTrace) motorTraceRecord(psock->pTrace, buffer, &sendTime, nread, status);
     epicsMutexUnlock(psock->mutexId);
 }
 
@@ -28,6 +28,14 @@ omsBaseAxis::omsBaseAxis(omsBaseController *pController, int axis, char axisChar
     stepper = 1;
     invertLimit = 0;
     lastminvelo = 0;
+    profileUse_ = 0;
+    profileOrigin_ = 0.0;
+    profileStartPosition_ = 0.0;
+    profileSegPositions_ = NULL;
+    profileSegVelocities_ = NULL;
+    profileSegAccelerations_ = NULL;
+    profileRawReadbacks_ = NULL;
+    profileRawErrors_ = NULL;
 }
 
 asynStatus omsBaseAxis::move(double position, int relative, double min_velocity, double max_velocity, double acceleration)
@@ -213,3 +221,23 @@ asynStatus omsBaseAxis::poll(bool *moving)
     epicsEventSignal(pC_->pollEventId_);
     return asynSuccess;
 }
+
+/** Allocates the profile arrays of the axis.
+ * A profile of N points is downloaded as N+1 segments, including the
+ * acceleration and deceleration segments.
+ */
+asynStatus omsBaseAxis::initializeProfile(size_t maxPoints)
+{
+    asynMotorAxis::initializeProfile(maxPoints);
+    if (profileSegPositions_) free(profileSegPositions_);
+    profileSegPositions_ = (double *)calloc(maxPoints+1, sizeof(double));
+    if (profileSegVelocities_) free(profileSegVelocities_);
+    profileSegVelocities_ = (double *)calloc(maxPoints+1, sizeof(double));
+    if (profileSegAccelerations_) free(profileSegAccelerations_);
+    profileSegAccelerations_ = (double *)calloc(maxPoints+1, sizeof(double));
+    if (profileRawReadbacks_) free(profileRawReadbacks_);
+    profileRawReadbacks_ = (double *)calloc(maxPoints, sizeof(double));
+    if (profileRawErrors_) free(profileRawErrors_);
+    profileRawErrors_ = (double *)calloc(maxPoints, sizeof(double));
+    return asynSuccess;
+}
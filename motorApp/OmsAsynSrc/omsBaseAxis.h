@@ -28,6 +28,7 @@ public:
     virtual asynStatus doMoveToHome();
     virtual asynStatus setPosition(double position);
     virtual asynStatus poll(bool *moving);
+    virtual asynStatus initializeProfile(size_t maxPoints);
 
     int getAxis(){return axisNo_;};
     int isStepper(){return stepper;};
@@ -45,6 +46,14 @@ private:
     int stepper;
     int invertLimit;
     epicsInt32 lastminvelo;
+    int profileUse_;
+    double profileOrigin_;
+    double profileStartPosition_;
+    double *profileSegPositions_;
+    double *profileSegVelocities_;
+    double *profileSegAccelerations_;
+    double *profileRawReadbacks_;
+    double *profileRawErrors_;
 
 friend class omsBaseController;
 };
@@ -19,6 +19,7 @@ USAGE...        Pro-Dex OMS asyn motor base controller support
 #include "omsBaseController.h"
 
 #define MIN(a,b) ((a)<(b)? (a): (b))
+#define NINT(f) (int)((f)>0 ? (f)+0.5 : (f)-0.5)
 
 #define motorOmsStringSendString        "OMS_STRING_SEND"
 #define motorOmsStringSendRecvString    "OMS_STRING_SENDRECV"
@@ -26,6 +27,14 @@ USAGE...        Pro-Dex OMS asyn motor base controller support
 #define motorOmsPollString              "OMS_POLL"
 #define MOTOR_OMS_PARAMS_COUNT          4
 
+/* Profile moves */
+#define MAX_MESSAGE_LEN                 256
+#define OMS_PROFILE_COMMAND_LEN         100
+#define OMS_PROFILE_MAX_VELOCITY        4194303
+#define OMS_PROFILE_MAX_ACCELERATION    8000000
+#define OMS_PROFILE_POLL_PERIOD         0.01    /* s between position samples */
+#define OMS_PROFILE_STOP_TIME           0.5     /* s at rest before a move counts as stopped */
+
 ELLLIST omsBaseController::omsControllerList;
 int omsBaseController::omsTotalControllerNumber = 0;
 
@@ -100,6 +109,21 @@ omsBaseController::omsBaseController(const char *portName, int maxAxes, int prio
     setStringParam(0, sendReceiveIndex, (char *) "");
     setStringParam(0, receiveIndex, (char *) "");
 
+    profileKnotTimes_ = NULL;
+    profileNumSegments_ = 0;
+    profileOutBit_ = -1;
+    profilePulseTotal_ = 0;
+    profilePulseCount_ = 0;
+    profileAborted_ = false;
+
+    // Create the event and the thread that execute profile moves
+    profileExecuteEvent_ = epicsEventMustCreate(epicsEventEmpty);
+    char profileThreadName[20];
+    epicsSnprintf(profileThreadName, sizeof(profileThreadName), "OMSProfile-%d", controllerNumber);
+    epicsThreadCreate(profileThreadName, epicsThreadPriorityLow,
+            epicsThreadGetStackSize(epicsThreadStackMedium),
+            (EPICSTHREADFUNC) &omsBaseController::callProfileThread, (void *) this);
+
     /* Set an EPICS exit handler */
     epicsAtExit(omsBaseController::callShutdown, this);
 
@@ -156,6 +180,10 @@ void omsBaseController::report(FILE *fp, int level)
             if (pAxis->homing) fprintf(fp, "    Currently homing axis\n" );
         }
     }
+    if (maxProfilePoints_ > 0)
+        fprintf(fp, "  Profile: %d points max, %d segments, output bit %d, readbacks %d/%d\n",
+               (int)maxProfilePoints_, profileNumSegments_, profileOutBit_,
+               profilePulseCount_, profilePulseTotal_);
     // Call the base class method
     asynMotorController::report(fp, level);
 }
@@ -1126,3 +1154,693 @@ bool omsBaseController::watchdogOK()
     return true;
 }
 
+
+/*
+ * Profile moves
+ *
+ * A profile of N points is run as N+1 vector segments of the controller:
+ * an acceleration segment from rest to the first point, one segment per
+ * element and a deceleration segment to rest, both PROFILE_ACCELERATION
+ * seconds long.  Each axis runs on its own vector task, the tasks are held
+ * until all segments are downloaded and are then started together with VG.
+ * If an output bit is configured it is pulsed at the start of each segment
+ * from startPulses to endPulses.  The controller has no position capture,
+ * so the readbacks are interpolated from positions sampled while the
+ * profile runs.
+ */
+
+void omsBaseController::callProfileThread(void *drvPvt)
+{
+    omsBaseController *pController = (omsBaseController*)drvPvt;
+    pController->profileThread();
+}
+
+void omsBaseController::profileThread()
+{
+    while (true) {
+        epicsEventWait(profileExecuteEvent_);
+        runProfile();
+    }
+}
+
+asynStatus omsBaseController::initializeProfile(size_t maxPoints)
+{
+    return initializeProfile(maxPoints, profileOutBit_);
+}
+
+/** Allocates the profile arrays.
+ * \param[in] maxPoints Maximum number of profile points.
+ * \param[in] outBit Output bit pulsed at each profile point, -1 for none.
+ */
+asynStatus omsBaseController::initializeProfile(size_t maxPoints, int outBit)
+{
+    asynMotorController::initializeProfile(maxPoints);
+    if (profileKnotTimes_) free(profileKnotTimes_);
+    profileKnotTimes_ = (double *)calloc(maxPoints+2, sizeof(double));
+    profileNumSegments_ = 0;
+    profileOutBit_ = ((outBit >= 0) && (outBit <= 15)) ? outBit : -1;
+    return asynSuccess;
+}
+
+/* Velocity at profile point i: the average velocity of the elements either side of it */
+static double profilePointVelocity(const double *positions, const double *times, int numPoints, int i)
+{
+    if (i == 0) return (positions[1] - positions[0]) / times[0];
+    if (i == numPoints-1) return (positions[i] - positions[i-1]) / times[i-1];
+    return (positions[i+1] - positions[i-1]) / (times[i-1] + times[i]);
+}
+
+/** Computes the controller segments of the profile.
+ * As in MAX_trajectoryScan.st the acceleration of each segment is a compromise
+ * between the one that reaches the next point and the one that reaches the
+ * velocity at that point, and the segment ends where that acceleration gets to.
+ */
+asynStatus omsBaseController::buildProfile()
+{
+    omsBaseAxis *pAxis;
+    int seg, axis, executeState;
+    int numPoints, numElements, numSegments;
+    int startPulses, endPulses;
+    int numUsed = 0;
+    bool buildOK = true;
+    double accelTime, dt, target, vTarget, accelPos, accelVel;
+    double p, v, a, vFirst, vLast;
+    double *positions;
+    char message[MAX_MESSAGE_LEN];
+    static const char *functionName = "buildProfile";
+
+    // Call the base class method which will build the time array if needed
+    asynMotorController::buildProfile();
+
+    strcpy(message, " ");
+    setStringParam(profileBuildMessage_, message);
+    setIntegerParam(profileBuildState_, PROFILE_BUILD_BUSY);
+    setIntegerParam(profileBuildStatus_, PROFILE_STATUS_UNDEFINED);
+    callParamCallbacks();
+
+    getIntegerParam(profileExecuteState_, &executeState);
+    getIntegerParam(profileNumPoints_,   &numPoints);
+    getIntegerParam(profileStartPulses_, &startPulses);
+    getIntegerParam(profileEndPulses_,   &endPulses);
+    getDoubleParam(profileAcceleration_, &accelTime);
+    numElements = numPoints - 1;
+    numSegments = numPoints + 1;
+
+    if (maxProfilePoints_ == 0) {
+        buildOK = false;
+        sprintf(message, "Profile not initialized, call omsCreateProfile");
+        goto done;
+    }
+    if (executeState != PROFILE_EXECUTE_DONE) {
+        buildOK = false;
+        sprintf(message, "Profile is executing");
+        goto done;
+    }
+    profileNumSegments_ = 0;
+    if ((numPoints < 2) || (numPoints > (int)maxProfilePoints_)) {
+        buildOK = false;
+        sprintf(message, "Number of points must be between 2 and %d", (int)maxProfilePoints_);
+        goto done;
+    }
+    for (seg=0; seg<numElements; seg++) {
+        if (profileTimes_[seg] <= 0) {
+            buildOK = false;
+            sprintf(message, "Negative or null delta time at element %d", seg+1);
+            goto done;
+        }
+    }
+    // Valid range of start and end pulses;  these start at 1, not 0.
+    // numElements+1 is the deceleration element
+    if ((startPulses < 1)           || (startPulses > numElements+1) ||
+        (endPulses   < startPulses) || (endPulses   > numElements+1)) {
+        buildOK = false;
+        sprintf(message, "Error: start or end pulses outside valid range");
+        goto done;
+    }
+    if (accelTime <= 0) {
+        buildOK = false;
+        sprintf(message, "Acceleration time must be positive");
+        goto done;
+    }
+
+    /* Knot 0 is the start of the acceleration segment, knot i+1 is profile point i */
+    profileKnotTimes_[0] = 0.0;
+    profileKnotTimes_[1] = accelTime;
+    for (seg=0; seg<numElements; seg++) {
+        profileKnotTimes_[seg+2] = profileKnotTimes_[seg+1] + profileTimes_[seg];
+    }
+    profileKnotTimes_[numPoints+1] = profileKnotTimes_[numPoints] + accelTime;
+
+    for (axis=0; axis<numAxes; axis++) {
+        pAxis = pAxes[axis];
+        getIntegerParam(axis, profileUseAxis_, &pAxis->profileUse_);
+        if (!pAxis->profileUse_) continue;
+        numUsed++;
+        positions = pAxis->profilePositions_;
+        vFirst = profilePointVelocity(positions, profileTimes_, numPoints, 0);
+        vLast  = profilePointVelocity(positions, profileTimes_, numPoints, numElements);
+        p = positions[0] - 0.5 * vFirst * accelTime;
+        v = 0.0;
+        pAxis->profileStartPosition_ = p;
+        for (seg=0; seg<numSegments; seg++) {
+            dt = profileKnotTimes_[seg+1] - profileKnotTimes_[seg];
+            if (seg < numPoints) {
+                target = positions[seg];
+                vTarget = profilePointVelocity(positions, profileTimes_, numPoints, seg);
+            } else {
+                target = positions[numElements] + 0.5 * vLast * accelTime;
+                vTarget = 0.0;
+            }
+            accelPos = 2 * (target - p - v * dt) / (dt * dt);
+            accelVel = (vTarget - v) / dt;
+            a = (seg < numSegments-1) ? (accelPos + accelVel) / 2 : accelVel;
+            p += v * dt + 0.5 * a * dt * dt;
+            v += a * dt;
+            if ((fabs(v) > OMS_PROFILE_MAX_VELOCITY) || (fabs(a) > OMS_PROFILE_MAX_ACCELERATION)) {
+                buildOK = false;
+                sprintf(message, "Axis %d exceeds the controller speed or acceleration at element %d", axis, seg);
+                goto done;
+            }
+            pAxis->profileSegPositions_[seg] = p;
+            pAxis->profileSegVelocities_[seg] = v;
+            pAxis->profileSegAccelerations_[seg] = a;
+        }
+    }
+    if (numUsed == 0) {
+        buildOK = false;
+        sprintf(message, "No axes are used in the profile");
+        goto done;
+    }
+    profilePulseTotal_ = endPulses - startPulses + 1;
+    profileNumSegments_ = numSegments;
+
+    done:
+    setIntegerParam(profileBuildStatus_, buildOK ? PROFILE_STATUS_SUCCESS : PROFILE_STATUS_FAILURE);
+    setStringParam(profileBuildMessage_, message);
+    if (!buildOK) {
+        asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s:%s:%s: %s\n",
+              driverName, functionName, portName, message);
+    }
+    /* Clear build command.  This is a "busy" record, don't want to do this until build is complete. */
+    setIntegerParam(profileBuild_, 0);
+    setIntegerParam(profileBuildState_, PROFILE_BUILD_DONE);
+    callParamCallbacks();
+    return buildOK ? asynSuccess : asynError;
+}
+
+/* Hands the profile to the profile thread */
+asynStatus omsBaseController::executeProfile()
+{
+    int executeState;
+    const char *message = NULL;
+    static const char *functionName = "executeProfile";
+
+    getIntegerParam(profileExecuteState_, &executeState);
+    if (profileNumSegments_ == 0)
+        message = "Profile has not been built";
+    else if (executeState != PROFILE_EXECUTE_DONE)
+        message = "Profile is already executing";
+    if (message) {
+        setIntegerParam(profileExecuteStatus_, PROFILE_STATUS_FAILURE);
+        setStringParam(profileExecuteMessage_, message);
+        setIntegerParam(profileExecute_, 0);
+        callParamCallbacks();
+        asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s:%s:%s: %s\n",
+              driverName, functionName, portName, message);
+        return asynError;
+    }
+    profileAborted_ = false;
+    profilePulseCount_ = 0;
+    setIntegerParam(profileCurrentPoint_, 0);
+    setIntegerParam(profileActualPulses_, 0);
+    setStringParam(profileExecuteMessage_, " ");
+    setIntegerParam(profileExecuteState_, PROFILE_EXECUTE_MOVE_START);
+    setIntegerParam(profileExecuteStatus_, PROFILE_STATUS_UNDEFINED);
+    callParamCallbacks();
+    epicsEventSignal(profileExecuteEvent_);
+    return asynSuccess;
+}
+
+/* Halts the vector tasks and kills the profile axes, which also flushes their queues */
+asynStatus omsBaseController::stopProfileAxes()
+{
+    char buff[OMS_PROFILE_COMMAND_LEN];
+    int axis, n;
+    asynStatus status = asynSuccess;
+
+    for (axis=0; axis<numAxes; axis++) {
+        if (!pAxes[axis]->profileUse_) continue;
+        sprintf(buff, "AM; VH[%d]1;", axis+1);
+        if (sendOnlyLock(buff) != asynSuccess) status = asynError;
+    }
+    n = sprintf(buff, "KS");
+    for (axis=0; axis<numAxes; axis++) {
+        if (pAxes[axis]->profileUse_) buff[n++] = '1';
+        if (axis < numAxes-1) buff[n++] = ',';
+    }
+    strcpy(&buff[n], ";");
+    if (sendOnlyLock(buff) != asynSuccess) status = asynError;
+    return status;
+}
+
+asynStatus omsBaseController::abortProfile()
+{
+    int executeState;
+
+    getIntegerParam(profileExecuteState_, &executeState);
+    if (executeState == PROFILE_EXECUTE_DONE) return asynSuccess;
+    profileAborted_ = true;
+    return stopProfileAxes();
+}
+
+/* Queues one vector segment on the task of an axis.
+ * With useStart the start speed is given too, as for the last segment. */
+asynStatus omsBaseController::sendProfileSegment(int axis, int accel, int vStart, int vEnd,
+                                                 int position, int useStart, bool last)
+{
+    char buff[OMS_PROFILE_COMMAND_LEN];
+    int i, n;
+
+    if (accel < 1) accel = 1;
+    if (accel > OMS_PROFILE_MAX_ACCELERATION) accel = OMS_PROFILE_MAX_ACCELERATION;
+    if (vStart < 1) vStart = 1;
+    if (vStart > OMS_PROFILE_MAX_VELOCITY) vStart = OMS_PROFILE_MAX_VELOCITY;
+    if (vEnd > OMS_PROFILE_MAX_VELOCITY) vEnd = OMS_PROFILE_MAX_VELOCITY;
+
+    n = sprintf(buff, "AM; VA[%d]%d;", axis+1, accel);
+    if (useStart || last)
+        n += sprintf(&buff[n], "VV[%d]%d,%d;", axis+1, vStart, vEnd);
+    else
+        n += sprintf(&buff[n], "VV[%d]%d;", axis+1, vEnd);
+    n += sprintf(&buff[n], "VP[%d]A", axis+1);
+    for (i=0; i<axis; i++) buff[n++] = ',';
+    n += sprintf(&buff[n], "%d", position);
+    for (i=axis+1; i<numAxes; i++) buff[n++] = ',';
+    strcpy(&buff[n], ";");
+    return sendOnlyLock(buff);
+}
+
+/* Downloads the segments of all profile axes.  The tasks are left on hold. */
+asynStatus omsBaseController::loadProfile(int startPulses, int endPulses)
+{
+    omsBaseAxis *pAxis;
+    char buff[OMS_PROFILE_COMMAND_LEN];
+    int axis, seg, n, mask = 0;
+    int pulseAxis = -1;
+    bool pulsesEnabled = false, enable, split;
+    double vStart, vEnd, a, dt, tZero, origin;
+    asynStatus status = asynSuccess;
+
+    if (profileOutBit_ >= 0) {
+        mask = 1 << profileOutBit_;
+        sprintf(buff, "BD%04x;", mask);     /* set bit as output */
+        status = sendOnlyLock(buff);
+        sprintf(buff, "BL%d;", profileOutBit_);
+        if (status == asynSuccess) status = sendOnlyLock(buff);
+    }
+
+    /* clear the queues of the profile axes */
+    n = sprintf(buff, "AM; SI");
+    for (axis=0; axis<numAxes; axis++) {
+        if (pAxes[axis]->profileUse_) buff[n++] = '1';
+        if (axis < numAxes-1) buff[n++] = ',';
+    }
+    strcpy(&buff[n], ";");
+    if (status == asynSuccess) status = sendOnlyLock(buff);
+
+    for (axis=0; (axis<numAxes) && (status == asynSuccess); axis++) {
+        pAxis = pAxes[axis];
+        if (!pAxis->profileUse_) continue;
+        /* The pulses come from the task of the first profile axis */
+        if ((pulseAxis < 0) && (profileOutBit_ >= 0)) pulseAxis = axis;
+        sprintf(buff, "AM; VIO[%d]0,0,0;", axis+1);
+        sendOnlyLock(buff);
+        pulsesEnabled = false;
+        /* done flag and interrupt, and don't start until VG */
+        sprintf(buff, "AM; VID[%d]1;", axis+1);
+        sendOnlyLock(buff);
+        sprintf(buff, "AM; VH[%d]0;", axis+1);
+        sendOnlyLock(buff);
+
+        origin = pAxis->profileOrigin_;
+        vStart = 0.0;
+        for (seg=0; (seg<profileNumSegments_) && (status == asynSuccess); seg++) {
+            a = pAxis->profileSegAccelerations_[seg];
+            vEnd = pAxis->profileSegVelocities_[seg];
+            dt = profileKnotTimes_[seg+1] - profileKnotTimes_[seg];
+
+            if (axis == pulseAxis) {
+                enable = (seg >= startPulses) && (seg <= endPulses);
+                if (enable != pulsesEnabled) {
+                    if (enable)
+                        sprintf(buff, "AM; VIO[%d]%04x,%04x,%04x;", axis+1, mask, 0, mask);
+                    else
+                        sprintf(buff, "AM; VIO[%d]0,0,0;", axis+1);
+                    sendOnlyLock(buff);
+                    pulsesEnabled = enable;
+                }
+            }
+
+            /* The controller only takes speeds, so a segment in which the velocity
+             * changes sign is split where it goes through zero */
+            split = (seg > 0) && ((vStart > 0) != (vEnd > 0)) && (fabs(vStart) > 2) && (fabs(vEnd) > 2);
+            if (split) {
+                tZero = -vStart / a;
+                /* Don't split very near either end of the segment */
+                split = (tZero >= .005) && (dt - tZero >= .005);
+            }
+            if (split) {
+                n = NINT(origin + pAxis->profileSegPositions_[seg-1] + vStart * tZero + 0.5 * a * tZero * tZero);
+                status = sendProfileSegment(axis, NINT(fabs(a)), NINT(fabs(vStart)), 0, n, 1, false);
+                /* one pulse per element */
+                if (pulsesEnabled) {
+                    sprintf(buff, "AM; VIO[%d]0,0,0;", axis+1);
+                    sendOnlyLock(buff);
+                    pulsesEnabled = false;
+                }
+                vStart = 0.0;
+            }
+            if (status == asynSuccess)
+                status = sendProfileSegment(axis, NINT(fabs(a)), NINT(fabs(vStart)), NINT(fabs(vEnd)),
+                                            NINT(origin + pAxis->profileSegPositions_[seg]), 0,
+                                            seg == profileNumSegments_-1);
+            vStart = vEnd;
+        }
+        sprintf(buff, "AM; VE[%d];", axis+1);
+        if (status == asynSuccess) status = sendOnlyLock(buff);
+    }
+    return status;
+}
+
+/* Runs the profile.  It runs in the profile thread, so it's OK to block.
+ * It needs to lock and unlock when it accesses class data. */
+asynStatus omsBaseController::runProfile()
+{
+    omsBaseAxis *pAxis;
+    char buff[OMS_PROFILE_COMMAND_LEN];
+    int axis, n, pulse = 0, currentPoint = 0;
+    int moveMode, startPulses, endPulses, numPoints;
+    int target[OMS_MAX_AXES], positions[OMS_MAX_AXES], lastPositions[OMS_MAX_AXES];
+    int velocities[OMS_MAX_AXES];
+    int executeStatus = PROFILE_STATUS_SUCCESS;
+    double origin, elapsed, lastElapsed = 0.0, stoppedTime = 0.0;
+    double totalTime, pulseTime, frac, readback;
+    bool moving, atStart, aborted = false;
+    epicsTimeStamp start, now;
+    char message[MAX_MESSAGE_LEN];
+    static const char *functionName = "runProfile";
+
+    lock();
+    getIntegerParam(profileMoveMode_,    &moveMode);
+    getIntegerParam(profileStartPulses_, &startPulses);
+    getIntegerParam(profileEndPulses_,   &endPulses);
+    getIntegerParam(profileNumPoints_,   &numPoints);
+    // The origin of the trajectory depends on whether we are in absolute or relative mode
+    for (axis=0; axis<numAxes; axis++) {
+        pAxis = pAxes[axis];
+        if (!pAxis->profileUse_) continue;
+        origin = 0.0;
+        if (moveMode != PROFILE_MOVE_MODE_ABSOLUTE) getDoubleParam(axis, motorPosition_, &origin);
+        pAxis->profileOrigin_ = origin;
+        target[axis] = NINT(origin + pAxis->profileStartPosition_);
+    }
+    totalTime = profileKnotTimes_[profileNumSegments_];
+    unlock();
+    strcpy(message, " ");
+
+    /* Move to the start of the acceleration segment with the speed of the last move */
+    for (axis=0; axis<numAxes; axis++) {
+        pAxis = pAxes[axis];
+        if (!pAxis->profileUse_) continue;
+        sprintf(buff, "A%1c;MA%d;GO;ID;", pAxis->axisChar, target[axis]);
+        sendOnlyLock(buff);
+    }
+    wakeupPoller();
+    while (true) {
+        epicsThreadSleep(OMS_PROFILE_POLL_PERIOD);
+        lock();
+        aborted = profileAborted_;
+        unlock();
+        if (aborted) {
+            executeStatus = PROFILE_STATUS_ABORT;
+            sprintf(message, "Profile aborted");
+            goto done;
+        }
+        if ((getAxesPositions(positions) != asynSuccess) ||
+            (getAxesArray((char*) "AM;RV;", velocities) != asynSuccess)) {
+            executeStatus = PROFILE_STATUS_FAILURE;
+            sprintf(message, "Error reading the axes during the move to the start");
+            goto done;
+        }
+        moving = false;
+        atStart = true;
+        for (axis=0; axis<numAxes; axis++) {
+            if (!pAxes[axis]->profileUse_) continue;
+            if (velocities[axis] != 0) moving = true;
+            if (positions[axis] != target[axis]) atStart = false;
+        }
+        if (atStart && !moving) break;
+        stoppedTime = moving ? 0.0 : stoppedTime + OMS_PROFILE_POLL_PERIOD;
+        if (stoppedTime > OMS_PROFILE_STOP_TIME) {
+            executeStatus = PROFILE_STATUS_ABORT;
+            sprintf(message, "Move to the profile start was interrupted");
+            goto done;
+        }
+    }
+
+    if (loadProfile(startPulses, endPulses) != asynSuccess) {
+        executeStatus = PROFILE_STATUS_FAILURE;
+        sprintf(message, "Error downloading the profile");
+        goto done;
+    }
+
+    lock();
+    aborted = profileAborted_;
+    if (!aborted) {
+        setIntegerParam(profileExecuteState_, PROFILE_EXECUTE_EXECUTING);
+        callParamCallbacks();
+    }
+    unlock();
+    if (aborted) {
+        /* Segments downloaded after the abort are still queued */
+        stopProfileAxes();
+        executeStatus = PROFILE_STATUS_ABORT;
+        sprintf(message, "Profile aborted");
+        goto done;
+    }
+
+    n = sprintf(buff, "AM;");
+    for (axis=0; axis<numAxes; axis++) {
+        if (pAxes[axis]->profileUse_) n += sprintf(&buff[n], "VO[%d]=100;", axis+1); /* no velocity override */
+    }
+    sendOnlyLock(buff);
+    n = sprintf(buff, "AM;");
+    for (axis=0; axis<numAxes; axis++) {
+        if (pAxes[axis]->profileUse_) n += sprintf(&buff[n], "VG[%d];", axis+1); /* GO! */
+    }
+    /* abortProfile() runs with the lock held, so it cannot slip in between */
+    lock();
+    aborted = profileAborted_;
+    if (!aborted) sendOnlyLock(buff);
+    unlock();
+    if (aborted) {
+        stopProfileAxes();
+        executeStatus = PROFILE_STATUS_ABORT;
+        sprintf(message, "Profile aborted");
+        goto done;
+    }
+    epicsTimeGetCurrent(&start);
+    memcpy(lastPositions, target, sizeof(lastPositions));
+    wakeupPoller();
+
+    while (true) {
+        epicsThreadSleep(OMS_PROFILE_POLL_PERIOD);
+        lock();
+        aborted = profileAborted_;
+        unlock();
+        if (aborted) {
+            stopProfileAxes();
+            executeStatus = PROFILE_STATUS_ABORT;
+            sprintf(message, "Profile aborted");
+            break;
+        }
+        if ((getAxesPositions(positions) != asynSuccess) ||
+            (getAxesArray((char*) "AM;RV;", velocities) != asynSuccess)) {
+            stopProfileAxes();
+            executeStatus = PROFILE_STATUS_FAILURE;
+            sprintf(message, "Error reading the axes during the profile");
+            break;
+        }
+        epicsTimeGetCurrent(&now);
+        elapsed = epicsTimeDiffInSeconds(&now, &start);
+
+        /* Pulse k is at the start of segment startPulses+k.  Its readback is
+         * interpolated between the samples either side of it. */
+        lock();
+        while (pulse < profilePulseTotal_) {
+            pulseTime = profileKnotTimes_[startPulses + pulse];
+            if (pulseTime > elapsed) break;
+            frac = (elapsed > lastElapsed) ? (pulseTime - lastElapsed) / (elapsed - lastElapsed) : 1.0;
+            if (frac < 0.0) frac = 0.0;
+            for (axis=0; axis<numAxes; axis++) {
+                pAxis = pAxes[axis];
+                if (!pAxis->profileUse_) continue;
+                readback = lastPositions[axis] + frac * (positions[axis] - lastPositions[axis]);
+                pAxis->profileRawReadbacks_[pulse] = readback;
+                pAxis->profileRawErrors_[pulse] = readback -
+                        (pAxis->profileOrigin_ + pAxis->profilePositions_[startPulses - 1 + pulse]);
+            }
+            pulse++;
+        }
+        profilePulseCount_ = pulse;
+        while ((currentPoint < numPoints) && (profileKnotTimes_[currentPoint+1] <= elapsed)) currentPoint++;
+        setIntegerParam(profileCurrentPoint_, currentPoint);
+        setIntegerParam(profileActualPulses_, pulse);
+        callParamCallbacks();
+        unlock();
+
+        moving = false;
+        for (axis=0; axis<numAxes; axis++) {
+            if (pAxes[axis]->profileUse_ && (velocities[axis] != 0)) moving = true;
+        }
+        if ((elapsed >= totalTime) && !moving) break;
+        /* See if the elapsed time is more than twice expected, time out */
+        if (elapsed > 2 * totalTime + 1.0) {
+            stopProfileAxes();
+            executeStatus = PROFILE_STATUS_TIMEOUT;
+            sprintf(message, "Timeout");
+            break;
+        }
+        memcpy(lastPositions, positions, sizeof(lastPositions));
+        lastElapsed = elapsed;
+    }
+
+    done:
+    if (executeStatus != PROFILE_STATUS_SUCCESS) {
+        lock();
+        setIntegerParam(profileExecuteState_, PROFILE_EXECUTE_FLYBACK);
+        callParamCallbacks();
+        unlock();
+        /* Wait for the axes to come to rest */
+        for (stoppedTime = 0.0; stoppedTime < OMS_PROFILE_STOP_TIME; ) {
+            epicsThreadSleep(OMS_PROFILE_POLL_PERIOD);
+            moving = false;
+            if (getAxesArray((char*) "AM;RV;", velocities) == asynSuccess) {
+                for (axis=0; axis<numAxes; axis++) {
+                    if (pAxes[axis]->profileUse_ && (velocities[axis] != 0)) moving = true;
+                }
+            }
+            stoppedTime = moving ? 0.0 : stoppedTime + OMS_PROFILE_POLL_PERIOD;
+        }
+    }
+    wakeupPoller();
+
+    lock();
+    setIntegerParam(profileExecuteStatus_, executeStatus);
+    setStringParam(profileExecuteMessage_, message);
+    if (executeStatus != PROFILE_STATUS_SUCCESS) {
+        asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s:%s:%s: %s\n",
+              driverName, functionName, portName, message);
+    }
+    /* Clear execute command.  This is a "busy" record, don't want to do this until the profile is complete. */
+    setIntegerParam(profileExecute_, 0);
+    setIntegerParam(profileExecuteState_, PROFILE_EXECUTE_DONE);
+    callParamCallbacks();
+    unlock();
+    return (executeStatus == PROFILE_STATUS_SUCCESS) ? asynSuccess : asynError;
+}
+
+/* Posts the readbacks and following errors of the last profile */
+asynStatus omsBaseController::readbackProfile()
+{
+    omsBaseAxis *pAxis;
+    int axis;
+    bool readbackOK = true;
+    char message[MAX_MESSAGE_LEN];
+    static const char *functionName = "readbackProfile";
+
+    strcpy(message, " ");
+    setStringParam(profileReadbackMessage_, message);
+    setIntegerParam(profileReadbackState_, PROFILE_READBACK_BUSY);
+    setIntegerParam(profileReadbackStatus_, PROFILE_STATUS_UNDEFINED);
+    callParamCallbacks();
+
+    if (maxProfilePoints_ == 0) {
+        readbackOK = false;
+        sprintf(message, "Profile not initialized, call omsCreateProfile");
+        goto done;
+    }
+    if (profilePulseCount_ < profilePulseTotal_) {
+        readbackOK = false;
+        sprintf(message, "Error, numPulses=%d, readbacks=%d", profilePulseTotal_, profilePulseCount_);
+    }
+    /* The base class converts the arrays in place, so start from the raw values each time */
+    for (axis=0; axis<numAxes; axis++) {
+        pAxis = pAxes[axis];
+        memcpy(pAxis->profileReadbacks_,       pAxis->profileRawReadbacks_, profilePulseCount_*sizeof(double));
+        memcpy(pAxis->profileFollowingErrors_, pAxis->profileRawErrors_,    profilePulseCount_*sizeof(double));
+    }
+    setIntegerParam(profileNumReadbacks_, profilePulseCount_);
+    /* Convert from controller to user units and post the arrays */
+    asynMotorController::readbackProfile();
+
+    done:
+    setIntegerParam(profileReadbackStatus_, readbackOK ? PROFILE_STATUS_SUCCESS : PROFILE_STATUS_FAILURE);
+    setStringParam(profileReadbackMessage_, message);
+    if (!readbackOK) {
+        asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s:%s:%s: %s\n",
+              driverName, functionName, portName, message);
+    }
+    /* Clear readback command.  This is a "busy" record, don't want to do this until readback is complete. */
+    setIntegerParam(profileReadback_, 0);
+    setIntegerParam(profileReadbackState_, PROFILE_READBACK_DONE);
+    callParamCallbacks();
+    return readbackOK ? asynSuccess : asynError;
+}
+
+extern "C" int omsCreateProfile(
+           const char *portName,      /* MAXv or MAXnet Motor Asyn Port name */
+           int maxPoints,             /* Maximum number of profile points */
+           int outBit)                /* Output bit pulsed at each profile point, -1 for none */
+{
+    omsBaseController *pController = (omsBaseController*) findAsynPortDriver(portName);
+
+    if (pController == NULL) {
+        errlogPrintf("omsCreateProfile: ERROR, port %s not found\n", portName);
+        return 1;
+    }
+    pController->lock();
+    pController->initializeProfile(maxPoints, outBit);
+    pController->unlock();
+    return 0;
+}
+
+/* Code for iocsh registration */
+
+extern "C"
+{
+
+/* omsCreateProfile */
+static const iocshArg createProfileArg0 = {"asyn motor port name", iocshArgString};
+static const iocshArg createProfileArg1 = {"max points", iocshArgInt};
+static const iocshArg createProfileArg2 = {"output bit (0-15), -1 for none", iocshArgInt};
+static const iocshArg * const createProfileArgs[3] = {&createProfileArg0, &createProfileArg1,
+                                                      &createProfileArg2};
+static const iocshFuncDef createProfile = {"omsCreateProfile", 3, createProfileArgs};
+static void createProfileCallFunc(const iocshArgBuf *args)
+{
+    omsCreateProfile(args[0].sval, args[1].ival, args[2].ival);
+}
+
+static void OmsBaseAsynRegister(void)
+{
+    iocshRegister(&createProfile, createProfileCallFunc);
+}
+
+epicsExportRegistrar(OmsBaseAsynRegister);
+
+}
@@ -42,6 +42,16 @@ public:
     static void callShutdown(void *ptr){((omsBaseController*)ptr)->shutdown();};
     void shutdown();
 
+    /* These are the functions for profile moves */
+    virtual asynStatus initializeProfile(size_t maxPoints);
+    asynStatus initializeProfile(size_t maxPoints, int outBit);
+    virtual asynStatus buildProfile();
+    virtual asynStatus executeProfile();
+    virtual asynStatus abortProfile();
+    virtual asynStatus readbackProfile();
+    static void callProfileThread(void*);
+    void profileThread();
+
 protected:
     virtual asynStatus writeOctet(asynUser *, const char *, size_t, size_t *);
     virtual asynStatus getFirmwareVersion();
@@ -89,6 +99,18 @@ private:
     int pollIndex;
     int priority, stackSize;
 
+    asynStatus runProfile();
+    asynStatus loadProfile(int, int);
+    asynStatus sendProfileSegment(int, int, int, int, int, int, bool);
+    asynStatus stopProfileAxes();
+    double *profileKnotTimes_;
+    int profileNumSegments_;
+    int profileOutBit_;
+    int profilePulseTotal_;
+    int profilePulseCount_;
+    bool profileAborted_;
+    epicsEventId profileExecuteEvent_;
+
     friend class omsBaseAxis;
 };
 
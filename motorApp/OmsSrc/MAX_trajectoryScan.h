@@ -173,6 +173,18 @@ monitor addAccelDecel;
 evflag moveModeMon; sync moveMode moveModeMon;
 int moveModePrev;
 
+/* Streaming trajectories.  Chunks of Nelements points are appended with Append,
+ * before and during execution, and written to the controller as it runs. */
+int     streaming;    assign streaming    to "{P}{R}Streaming.VAL";
+monitor streaming;
+int     append;       assign append       to "{P}{R}Append.VAL";
+monitor append;
+int     streamEnd;    assign streamEnd    to "{P}{R}StreamEnd.VAL";
+monitor streamEnd;
+int     streamFree;   assign streamFree   to "{P}{R}StreamFree.VAL";
+int     streamLoaded; assign streamLoaded to "{P}{R}StreamLoaded.VAL";
+evflag appendMon; sync append appendMon;
+
 /*** END: Specific to MAX_trajectoryScan.st ***/
 
 int     moveAxis[MAX_AXES]; 
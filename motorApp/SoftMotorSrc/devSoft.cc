@@ -38,6 +38,7 @@ USAGE...        Motor record device level support for Soft channel.
  * .03 08-03-05 rls - Added debug messages.
  *                  - Fix compiler error with "gcc version 3.4.2 20041017 (Red
  *                    Hat 3.4.2-6.fc3)".
+ * .04 10-19-26     - Added soft_db_monitor() for links to records in this IOC.
  */
 
 
@@ -47,16 +48,25 @@ NOTES...
 */
 
 
+#include        <stdlib.h>
 #include        <dbDefs.h>
 #include        <dbFldTypes.h>
 #include        <dbAccess.h>
 #include        <dbEvent.h>
 #include        <recSup.h>
+#include        <epicsThread.h>
 
 #include        "motorRecord.h"
 #include        "motor.h"
 #include        "devSoft.h"
 
+#if !LT_EPICSBASE(3,15,0,0)
+#include        <dbChannel.h>
+typedef struct dbChannel eventChannel;
+#else
+typedef struct dbAddr eventChannel;
+#endif
+
 #include        "epicsExport.h"
 #include        "errlog.h"
 
@@ -313,6 +323,125 @@ static void soft_process(struct motorRecord *mr)
 }
 
 
+/*
+FUNCTION... long soft_db_monitor(struct motorRecord *, SOFT_LINK, const char *)
+USAGE...    Monitor a DINP, RDBL or RINP link whose target is a record in this
+            IOC with a database event subscription rather than a CA channel.
+            Called from the soft_motor task when devSoftLocalLinks is set.
+LOGIC...
+    IF the PV name is not found in this IOC.
+        Return ERROR; caller uses CA.
+    ENDIF
+    Start the event task on first use, at the soft_motor task's priority.
+    Subscribe to value and alarm events; post the initial value.
+*/
+
+struct soft_db_link
+{
+    struct motorRecord *mr;
+    SOFT_LINK which;
+    DBADDR addr;
+};
+
+static dbEventCtx soft_db_ctx;
+
+static void soft_db_event(void *user, eventChannel *chan, int eventsRemaining,
+                          struct db_field_log *pfl)
+{
+    struct soft_db_link *link = (struct soft_db_link *) user;
+    DBADDR *paddr = &link->addr;
+    long status;
+
+    switch (link->which)
+    {
+        case SOFT_DINP:
+            {
+                short value;
+                status = dbGetField(paddr, DBR_SHORT, &value, NULL, NULL, pfl);
+                if (status == 0)
+                    soft_dinp_func(link->mr, value);
+            }
+            break;
+        case SOFT_RDBL:
+            {
+                double value;
+                status = dbGetField(paddr, DBR_DOUBLE, &value, NULL, NULL, pfl);
+                if (status == 0)
+                    soft_rdbl_func(link->mr, value);
+            }
+            break;
+        case SOFT_RINP:
+            {
+                epicsInt32 value;
+                status = dbGetField(paddr, DBR_LONG, &value, NULL, NULL, pfl);
+                if (status == 0)
+                    soft_rinp_func(link->mr, value);
+            }
+            break;
+    }
+}
+
+long soft_db_monitor(struct motorRecord *mr, SOFT_LINK which, const char *pvname)
+{
+    struct soft_db_link *link;
+    dbEventSubscription sub;
+
+    link = (struct soft_db_link *) malloc(sizeof(struct soft_db_link));
+    if (!link)
+        return(ERROR);
+    if (dbNameToAddr(pvname, &link->addr) != 0)
+    {
+        free(link);
+        return(ERROR);
+    }
+    link->mr = mr;
+    link->which = which;
+
+    if (soft_db_ctx == NULL)
+    {
+        soft_db_ctx = db_init_events();
+        if (soft_db_ctx == NULL ||
+            db_start_events(soft_db_ctx, "soft_motor_db", NULL, NULL,
+                            epicsThreadGetPrioritySelf()) != DB_EVENT_OK)
+        {
+            errlogPrintf("soft_db_monitor(): cannot start database event task.\n");
+            soft_db_ctx = NULL;
+            free(link);
+            return(ERROR);
+        }
+    }
+
+#if LT_EPICSBASE(3,15,0,0)
+    sub = db_add_event(soft_db_ctx, &link->addr, soft_db_event, link,
+                       DBE_VALUE | DBE_ALARM);
+#else
+    {
+        dbChannel *chan = dbChannelCreate(pvname);
+
+        if (!chan || dbChannelOpen(chan))
+        {
+            errlogPrintf("soft_db_monitor(%s): channel error\n", pvname);
+            if (chan)
+                dbChannelDelete(chan);
+            free(link);
+            return(ERROR);
+        }
+        sub = db_add_event(soft_db_ctx, chan, soft_db_event, link,
+                           DBE_VALUE | DBE_ALARM);
+    }
+#endif
+    if (sub == NULL)
+    {
+        free(link);
+        return(ERROR);
+    }
+    db_event_enable(sub);
+    db_post_single_event(sub);
+    Debug(2, "soft_db_monitor(): %s monitors local record %s.\n", mr->name, pvname);
+    return(OK);
+}
+
+
 /*
 FUNCTION... void soft_motor_callback(CALLBACK *)
 USAGE...    Process motor record after the following events:
@@ -28,6 +28,7 @@ USAGE... 	This file contains information that is common to
  * .02 09-23-04 rls Increase the maximum number of Soft Channel motor records
  *                  from 20 to 50.
  * .03 2006-04-10 pnd Convert to linked lists to remove arbitrary maximum
+ * .04 2026-10-19     Added soft_db_monitor() for links to local records.
  */
 
 #ifndef	INCdevSofth
@@ -37,6 +38,7 @@ USAGE... 	This file contains information that is common to
 #include <ellLib.h>
 
 typedef enum DONE_STATES {SOFTMOVE = 0, HARDMOVE = 1, DONE = 2} DONE_STATES;
+typedef enum SOFT_LINK {SOFT_DINP = 0, SOFT_RDBL = 1, SOFT_RINP = 2} SOFT_LINK;
 
 struct soft_private
 {
@@ -60,5 +62,6 @@ extern void soft_dinp_func(struct motorRecord *, short);
 extern void soft_rdbl_func(struct motorRecord *, double);
 extern void soft_rinp_func(struct motorRecord *, long);
 extern void soft_motor_callback(CALLBACK *);
+extern long soft_db_monitor(struct motorRecord *, SOFT_LINK, const char *);
 
 #endif	/* INCdevSofth */
@@ -26,6 +26,10 @@ USAGE...        Motor record device level support for Soft channel.
  * .02 12-14-04 rls With EPICS R3.14.7 changes to epicsThread.h, need explicit
  *                  #include <stdlib.h>
  * .03 2006-04-10 pnd Convert to linked lists to remove arbitrary maximum
+ * .04 2026-10-19     Search all links up front with connection callbacks and a
+ *                    single bounded wait instead of a ca_pend_io() per link;
+ *                    report unconnected links. Optionally monitor links to
+ *                    records in this IOC with database events (devSoftLocalLinks).
  */
 
 
@@ -34,6 +38,10 @@ Notes:
 - A Channel Access (CA) oriented file had to be created separate from the
 primary devSoft.c file because CA and record access code cannot both reside 
 in the same file; each defines (redefines) the DBR's.
+- All CA links are searched before waiting, so startup takes one connection
+round trip rather than one per link.  Links that do not connect within
+devSoftConnectTimeout seconds are listed; their monitors start whenever they
+connect.
 */
 
 #include <stdlib.h>
@@ -43,6 +51,8 @@ in the same file; each defines (redefines) the DBR's.
 #include <ellLib.h>
 #include <callback.h>
 #include <epicsThread.h>
+#include <epicsMutex.h>
+#include <epicsExport.h>
 
 #include "motorRecord.h"
 #include "motor.h"
@@ -50,6 +60,29 @@ in the same file; each defines (redefines) the DBR's.
 
 #define STATIC  static
 
+/* A CA link of a soft channel motor record. */
+struct soft_link
+{
+    ELLNODE node;
+    struct motorRecord *mr;
+    const char *field;          /* "DINP", "RDBL" or "RINP". */
+    chid channel;
+    bool connected;
+    bool pending;               /* Startup is waiting for the first connection. */
+};
+
+/* Seconds soft_motor_task() waits for all CA links to connect. */
+volatile double devSoftConnectTimeout = 5.0;
+/* If nonzero, links to records in this IOC use database events instead of CA. */
+volatile int devSoftLocalLinks = 0;
+extern "C"
+{
+epicsExportAddress(double, devSoftConnectTimeout);
+epicsExportAddress(int, devSoftLocalLinks);
+}
+
+STATIC void soft_connect(struct connection_handler_args);
+STATIC bool soft_add_link(struct motorRecord *, SOFT_LINK, const char *);
 STATIC void soft_dinp(struct event_handler_args);
 STATIC void soft_rdbl(struct event_handler_args);
 STATIC void soft_rinp(struct event_handler_args);
@@ -57,6 +90,65 @@ STATIC EPICSTHREADFUNC soft_motor_task(void *);
 STATIC epicsThreadId soft_motor_id;
 STATIC epicsEventId soft_motor_sem;
 STATIC ELLLIST soft_motor_list;
+STATIC ELLLIST soft_link_list;
+STATIC epicsMutexId soft_link_lock;
+STATIC epicsEventId soft_link_sem;
+STATIC int soft_links_pending;
+STATIC bool soft_startup_done;
+
+/* Connection callback for all CA links. During startup the first connection of
+ * each link is counted, afterwards connection changes are reported. */
+STATIC void soft_connect(struct connection_handler_args args)
+{
+    struct soft_link *link = (struct soft_link *) ca_puser(args.chid);
+    bool up = (args.op == CA_OP_CONN_UP);
+
+    epicsMutexMustLock(soft_link_lock);
+    link->connected = up;
+    if (up && link->pending)
+    {
+        link->pending = false;
+        if (--soft_links_pending == 0)
+            epicsEventSignal(soft_link_sem);
+    }
+    else if (soft_startup_done)
+        errlogPrintf("soft_motor: %s.%s link to %s %s.\n", link->mr->name,
+                     link->field, ca_name(args.chid),
+                     up ? "connected" : "disconnected");
+    epicsMutexUnlock(soft_link_lock);
+}
+
+/* Create one monitored link; local records are monitored with database
+ * events if devSoftLocalLinks is set. Nothing here waits on the network. */
+STATIC bool soft_add_link(struct motorRecord *mr, SOFT_LINK which, const char *pvname)
+{
+    static const char *fields[] = {"DINP", "RDBL", "RINP"};
+    static const chtype types[] = {DBR_SHORT, DBR_DOUBLE, DBR_LONG};
+    static caEventCallBackFunc *funcs[] = {soft_dinp, soft_rdbl, soft_rinp};
+    struct soft_link *link;
+
+    if (devSoftLocalLinks && soft_db_monitor(mr, which, pvname) == OK)
+        return(true);
+
+    link = (struct soft_link *) calloc(1, sizeof(struct soft_link));
+    if (!link)
+        return(false);
+    link->mr = mr;
+    link->field = fields[which];
+    link->pending = true;
+
+    epicsMutexMustLock(soft_link_lock);
+    soft_links_pending++;
+    ellAdd(&soft_link_list, &link->node);
+    epicsMutexUnlock(soft_link_lock);
+
+    SEVCHK(ca_create_channel(pvname, soft_connect, link, CA_PRIORITY_DEFAULT,
+                             &link->channel), "ca_create_channel() failure");
+    SEVCHK(ca_add_event(types[which], link->channel, funcs[which], mr, NULL),
+           "ca_add_event() failure");
+    return(false);
+}
+
 
 STATIC void soft_dinp(struct event_handler_args args)
 {
@@ -85,7 +177,10 @@ long soft_init(void *after)
         int retry = 0;
 
         soft_motor_sem = epicsEventCreate(epicsEventEmpty);
+        soft_link_sem = epicsEventCreate(epicsEventEmpty);
+        soft_link_lock = epicsMutexMustCreate();
         ellInit(&soft_motor_list);
+        ellInit(&soft_link_list);
 
         /* 
          * Fix for DMOV processing before the last DRBV update; i.e., lower
@@ -149,12 +244,14 @@ STATIC EPICSTHREADFUNC soft_motor_task(void *parm)
 {
     struct motorRecord *mr;
     struct motor_node *node;
-    chid dinp, rdbl, rinp;
+    struct soft_link *link;
     epicsEventId wait_forever;
+    int nlinks, nlocal = 0, pending;
 
     epicsEventWait(soft_motor_sem);     /* Wait for dbLockInitRecords() to execute. */
     SEVCHK(ca_context_create(ca_enable_preemptive_callback), "soft_motor_task: ca_context_create() error");
 
+    /* Issue every search and subscription before waiting for any of them. */
     while ((node = (struct motor_node *) ellGet(&soft_motor_list)))
     {
         struct soft_private *ptr;
@@ -168,26 +265,47 @@ STATIC EPICSTHREADFUNC soft_motor_task(void *parm)
         else
         {
             ptr->default_done_behavior = false;
-            SEVCHK(ca_search(mr->dinp.value.pv_link.pvname, &dinp),
-                   "ca_search() failure");
-            SEVCHK(ca_add_event(DBR_SHORT, dinp, soft_dinp, mr, NULL),"ca_add_event() failure");
-            SEVCHK(ca_pend_io((float) 5.0), "DINP link failure");
+            if (soft_add_link(mr, SOFT_DINP, mr->dinp.value.pv_link.pvname))
+                nlocal++;
         }
     
-        if (mr->urip != 0)
-        {
-            SEVCHK(ca_search(mr->rdbl.value.pv_link.pvname, &rdbl),"ca_search() failure");
-            SEVCHK(ca_add_event(DBR_DOUBLE, rdbl, soft_rdbl, mr, NULL),"ca_add_event() failure");
-            SEVCHK(ca_pend_io((float) 5.0), "RDBL link failure");
-        }
+        if (mr->urip != 0 &&
+            soft_add_link(mr, SOFT_RDBL, mr->rdbl.value.pv_link.pvname))
+            nlocal++;
 
-        if (mr->rinp.value.constantStr != NULL)
+        if (mr->rinp.value.constantStr != NULL &&
+            soft_add_link(mr, SOFT_RINP, mr->rinp.value.pv_link.pvname))
+            nlocal++;
+    }
+    ca_flush_io();
+
+    epicsMutexMustLock(soft_link_lock);
+    pending = soft_links_pending;
+    epicsMutexUnlock(soft_link_lock);
+    if (pending > 0)
+        epicsEventWaitWithTimeout(soft_link_sem, devSoftConnectTimeout);
+
+    /* Report the links that did not connect; they connect in the background. */
+    epicsMutexMustLock(soft_link_lock);
+    soft_startup_done = true;
+    nlinks = ellCount(&soft_link_list);
+    if (soft_links_pending > 0)
+    {
+        errlogPrintf("soft_motor: %d of %d links not connected after %.1f s:\n",
+                     soft_links_pending, nlinks, devSoftConnectTimeout);
+        for (link = (struct soft_link *) ellFirst(&soft_link_list); link;
+             link = (struct soft_link *) ellNext(&link->node))
         {
-            SEVCHK(ca_search(mr->rinp.value.pv_link.pvname, &rinp),"ca_search() failure");
-            SEVCHK(ca_add_event(DBR_LONG, rinp, soft_rinp, mr, NULL),"ca_add_event() failure");
-            SEVCHK(ca_pend_io((float) 5.0), "RINP link failure");
+            if (link->pending)
+                errlogPrintf("    %s.%s -> %s\n", link->mr->name, link->field,
+                             ca_name(link->channel));
+            link->pending = false;
         }
+        soft_links_pending = 0;
     }
+    epicsMutexUnlock(soft_link_lock);
+    if (nlocal > 0)
+        errlogPrintf("soft_motor: %d links monitored with database events.\n", nlocal);
 
     ellFree(&soft_motor_list);
     /* Wait on a (never signalled) event here, rather than suspending the